@@ -113,10 +113,21 @@ FUNCTION(ADD_ALLPIX_TEST TEST)
         STRING(REPLACE "#DETOPTION " "" OPT "${OPT}")
         SET(CLIOPTIONS "${CLIOPTIONS} -g ${OPT}")
     ENDFOREACH()
+    # Allow the test to run as server processing the given job files, relative to the test file:
+    FILE(STRINGS ${TEST} JOBS REGEX "#JOB ")
+    SET(JOBFILES "")
+    IF(JOBS)
+        GET_FILENAME_COMPONENT(TESTDIR ${TEST} DIRECTORY)
+        FOREACH(JOB ${JOBS})
+            STRING(REPLACE "#JOB " "" JOB "${JOB}")
+            LIST(APPEND JOBFILES "${CMAKE_CURRENT_SOURCE_DIR}/${TESTDIR}/${JOB}")
+        ENDFOREACH()
+        SET(CLIOPTIONS "${CLIOPTIONS} --server-once jobs")
+    ENDIF()
 
     ADD_TEST(NAME ${TEST}
         WORKING_DIRECTORY ${CMAKE_CURRENT_SOURCE_DIR}
-        COMMAND ${CMAKE_CURRENT_SOURCE_DIR}/run_directory.sh "output/${TEST}" "${CMAKE_INSTALL_PREFIX}/bin/allpix -c ${CMAKE_CURRENT_SOURCE_DIR}/${TEST} ${CLIOPTIONS}"
+        COMMAND ${CMAKE_CURRENT_SOURCE_DIR}/run_directory.sh "output/${TEST}" "${CMAKE_INSTALL_PREFIX}/bin/allpix -c ${CMAKE_CURRENT_SOURCE_DIR}/${TEST} ${CLIOPTIONS}" ${JOBFILES}
     )
 
     # Parse configuration file for pass/fail conditions:
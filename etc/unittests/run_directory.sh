@@ -10,5 +10,12 @@ fi
 # Run the second argument in the directory created from the first argument
 rm -rf $1
 mkdir -p $1
+
+# Copy all further arguments as job files for the server to the job directory
+if [ $# -gt 2 ]; then
+    mkdir -p $1/jobs
+    cp "${@:3}" $1/jobs/
+fi
+
 cd $1
 exec $2
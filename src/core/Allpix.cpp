@@ -8,20 +8,30 @@
 
 #include "Allpix.hpp"
 
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
 #include <chrono>
 #include <climits>
+#include <cstdio>
+#include <cstdlib>
 #include <fstream>
 #include <memory>
 #include <stdexcept>
 #include <thread>
 #include <utility>
 
+#include <TFile.h>
 #include <TROOT.h>
 #include <TRandom.h>
 #include <TStyle.h>
 #include <TSystem.h>
 
+#include "core/config/ConfigReader.hpp"
 #include "core/config/exceptions.h"
+#include "core/utils/exceptions.h"
 #include "core/utils/file.h"
 #include "core/utils/log.h"
 #include "core/utils/unit.h"
@@ -99,8 +109,9 @@ Allpix::Allpix(std::string config_file_name,
 
 /**
  * Performs the initialization, including:
- * - Initialize the random seeder
  * - Determine and create the output directory
+ * - Look up the checkpoint if the run is resumed
+ * - Initialize the random seeder
  * - Include all the defined units
  * - Load the modules from the configuration
  */
@@ -114,6 +125,68 @@ void Allpix::load() {
     LOG(STATUS) << "Welcome to Allpix^2 " << ALLPIX_PROJECT_VERSION;
     global_config.set<std::string>("version", ALLPIX_PROJECT_VERSION);
 
+    // Get output directory
+    std::string directory = gSystem->pwd();
+    directory += "/output";
+    if(global_config.has("output_directory")) {
+        // Use config specified one if available
+        directory = global_config.getPath("output_directory");
+    }
+
+    // Use existing output directory if it exists
+    bool create_output_dir = true;
+    if(allpix::path_is_directory(directory)) {
+        if(global_config.get<bool>("purge_output_directory", false) && !global_config.get<bool>("resume", false)) {
+            LOG(DEBUG) << "Deleting previous output directory " << directory;
+            allpix::remove_path(directory);
+        } else {
+            LOG(DEBUG) << "Output directory " << directory << " already exists";
+            create_output_dir = false;
+        }
+    }
+    // Create the output directory
+    try {
+        if(create_output_dir) {
+            LOG(DEBUG) << "Creating output directory " << directory;
+            allpix::create_directories(directory);
+        }
+        // Change to the new/existing output directory
+        gSystem->ChangeDirectory(directory.c_str());
+    } catch(std::invalid_argument& e) {
+        LOG(ERROR) << "Cannot create output directory " << directory << ": " << e.what()
+                   << ". Using current directory instead.";
+    }
+
+    // Resume from the checkpoint of an interrupted run if requested, the checkpoint is located in the output directory
+    global_config.setDefault<unsigned int>("checkpoint_interval", 0u);
+    global_config.setDefault<std::string>("checkpoint_file", "checkpoint");
+    global_config.setDefault<bool>("resume", false);
+    if(global_config.get<bool>("resume")) {
+        auto checkpoint_path = allpix::add_file_extension(
+            std::string(gSystem->pwd()) + "/" + global_config.get<std::string>("checkpoint_file"), "root");
+        if(allpix::path_is_file(checkpoint_path)) {
+            // The seeds of the interrupted run are required to continue it identically
+            TFile checkpoint(checkpoint_path.c_str(), "READ");
+            for(const auto& key : {"random_seed", "random_seed_core"}) {
+                std::string* value = nullptr;
+                checkpoint.GetObject(key, value);
+                if(value == nullptr) {
+                    throw RuntimeError("Checkpoint " + checkpoint_path + " does not contain the " + key);
+                }
+                auto seed = allpix::from_string<uint64_t>(*value);
+                delete value;
+                if(global_config.has(key) && global_config.get<uint64_t>(key) != seed) {
+                    throw InvalidValueError(global_config, key, "seed differs from the seed of the run to resume");
+                }
+                global_config.set<uint64_t>(key, seed);
+            }
+            LOG(STATUS) << "Resuming run from checkpoint " << checkpoint_path;
+        } else {
+            LOG(WARNING) << "No checkpoint found at " << checkpoint_path << ", starting the run from the beginning";
+            global_config.set<bool>("resume", false);
+        }
+    }
+
     // Initialize the random seeders, one for modules, one for core components
     std::mt19937_64 seeder_modules;
     std::mt19937_64 seeder_core;
@@ -153,36 +226,36 @@ void Allpix::load() {
     // Initialize ROOT random generator
     gRandom->SetSeed(seeder_modules());
 
-    // Get output directory
-    std::string directory = gSystem->pwd();
-    directory += "/output";
-    if(global_config.has("output_directory")) {
-        // Use config specified one if available
-        directory = global_config.getPath("output_directory");
+    // Determine the range of events to simulate, a run can be split into shards of consecutive events
+    global_config.setDefault<unsigned int>("first_event", 1u);
+    auto first_event = global_config.get<unsigned int>("first_event");
+    if(first_event == 0) {
+        throw InvalidValueError(global_config, "first_event", "event numbers start at one");
     }
-
-    // Use existing output directory if it exists
-    bool create_output_dir = true;
-    if(allpix::path_is_directory(directory)) {
-        if(global_config.get<bool>("purge_output_directory", false)) {
-            LOG(DEBUG) << "Deleting previous output directory " << directory;
-            allpix::remove_path(directory);
-        } else {
-            LOG(DEBUG) << "Output directory " << directory << " already exists";
-            create_output_dir = false;
+    if(global_config.has("last_event")) {
+        auto last_event = global_config.get<unsigned int>("last_event");
+        if(last_event < first_event) {
+            throw InvalidValueError(global_config, "last_event", "last event cannot be smaller than the first event");
         }
-    }
-    // Create the output directory
-    try {
-        if(create_output_dir) {
-            LOG(DEBUG) << "Creating output directory " << directory;
-            allpix::create_directories(directory);
+        auto number_of_events = last_event - first_event + 1;
+        if(global_config.has("number_of_events") &&
+           global_config.get<unsigned int>("number_of_events") != number_of_events) {
+            throw InvalidCombinationError(global_config,
+                                          {"first_event", "last_event", "number_of_events"},
+                                          "number of events does not match the range of events");
         }
-        // Change to the new/existing output directory
-        gSystem->ChangeDirectory(directory.c_str());
-    } catch(std::invalid_argument& e) {
-        LOG(ERROR) << "Cannot create output directory " << directory << ": " << e.what()
-                   << ". Using current directory instead.";
+        global_config.set<unsigned int>("number_of_events", number_of_events);
+    } else {
+        global_config.setDefault<unsigned int>("number_of_events", 1u);
+        global_config.set<unsigned int>("last_event",
+                                        first_event + global_config.get<unsigned int>("number_of_events") - 1);
+    }
+
+    // Seed the random generators of the modules for every event if requested
+    global_config.setDefault<bool>("seed_per_event", false);
+    if(first_event > 1 && !global_config.get<bool>("seed_per_event")) {
+        LOG(WARNING) << "Simulating events starting from event " << first_event << " without seed_per_event enabled, "
+                     << "results will differ from the same events simulated as part of the full run";
     }
 
     // Enable relevant multithreading if needed (disabled by default)
@@ -254,6 +327,153 @@ void Allpix::terminate() {
     mod_mgr_->terminate();
 }
 
+/**
+ * Job files with the extension .conf are processed in alphabetical order. A job is picked up as soon as a file with this
+ * extension appears, so submitters have to write the job to a file with another name and rename it to its final name once
+ * it is complete. Every job runs in a separate process forked from the server, such that all jobs start from the
+ * initialized state of the server without modifying it. Processed job files are renamed by appending .done or .failed,
+ * depending on the result of the job.
+ */
+void Allpix::serve(const std::string& job_directory, bool once) {
+    if(terminate_) {
+        LOG(INFO) << "Skip starting server because termination is requested";
+        return;
+    }
+
+    LOG(TRACE) << "Starting Allpix server";
+    mod_mgr_->initServer();
+
+    LOG(STATUS) << "Waiting for jobs in " << job_directory;
+    unsigned int job_count = 0;
+    const std::string job_extension = ".conf";
+    while(!terminate_) {
+        auto files = allpix::get_files_in_directory(job_directory);
+        std::sort(files.begin(), files.end());
+
+        bool found_job = false;
+        for(auto& file : files) {
+            if(terminate_) {
+                break;
+            }
+            if(file.size() <= job_extension.size() ||
+               file.compare(file.size() - job_extension.size(), job_extension.size(), job_extension) != 0) {
+                continue;
+            }
+
+            found_job = true;
+            auto processed_file = file + (run_job(file) ? ".done" : ".failed");
+            if(std::rename(file.c_str(), processed_file.c_str()) != 0) {
+                throw RuntimeError("Cannot rename processed job file " + file);
+            }
+            ++job_count;
+        }
+
+        // Poll the job directory again after a short break if no job has been submitted
+        if(!found_job) {
+            if(once) {
+                LOG(INFO) << "No jobs left in " << job_directory;
+                break;
+            }
+            std::this_thread::sleep_for(std::chrono::seconds(1));
+        }
+    }
+    LOG(STATUS) << "Stopped server after " << job_count << " jobs";
+}
+
+/**
+ * The job file contains key-value pairs setting the number of events, the first event, the random seed and the output
+ * directory of the job, which default to the settings of the server. Sections named after a module set parameters of all
+ * instantiations of this module. The job process terminates without any cleanup, as the objects inherited from the server
+ * process, such as its main ROOT file, must not be written by the job.
+ */
+bool Allpix::run_job(const std::string& job_file) {
+    auto job_name = job_file.substr(job_file.find_last_of('/') + 1);
+    job_name = job_name.substr(0, job_name.find_last_of('.'));
+    LOG(STATUS) << "Starting job " << job_name;
+    auto start_time = std::chrono::steady_clock::now();
+
+    // Flush all log streams, otherwise buffered output would be written by both processes
+    for(auto* stream : Log::getStreams()) {
+        stream->flush();
+    }
+
+    auto pid = fork();
+    if(pid < 0) {
+        throw RuntimeError("Cannot create process for job " + job_name);
+    }
+    if(pid == 0) {
+        int return_code = 0;
+        try {
+            Configuration& global_config = conf_mgr_->getGlobalConfiguration();
+            std::ifstream job_stream(job_file);
+            if(!job_stream) {
+                throw RuntimeError("Cannot read job file " + job_file);
+            }
+            ConfigReader job_reader(job_stream, job_file);
+            auto job_config = job_reader.getHeaderConfiguration();
+
+            // Determine the events and the seed of the job
+            auto first_event = job_config.get<unsigned int>("first_event", global_config.get<unsigned int>("first_event"));
+            if(first_event == 0) {
+                throw InvalidValueError(job_config, "first_event", "event numbers start at one");
+            }
+            auto number_of_events =
+                job_config.get<unsigned int>("number_of_events", global_config.get<unsigned int>("number_of_events"));
+            global_config.set<unsigned int>("first_event", first_event);
+            global_config.set<unsigned int>("number_of_events", number_of_events);
+            global_config.set<unsigned int>("last_event", first_event + number_of_events - 1);
+            auto seed = job_config.get<uint64_t>("random_seed", global_config.get<uint64_t>("random_seed"));
+            global_config.set<uint64_t>("random_seed", seed);
+
+            // Change to the output directory of the job, relative paths are placed in the output directory of the server
+            auto directory = job_config.get<std::string>("output_directory", job_name);
+            if(directory.empty() || directory.front() != '/') {
+                directory = std::string(gSystem->pwd()) + "/" + directory;
+            }
+            try {
+                allpix::create_directories(directory);
+            } catch(std::invalid_argument& e) {
+                throw InvalidValueError(job_config, "output_directory", e.what());
+            }
+            gSystem->ChangeDirectory(directory.c_str());
+
+            std::vector<Configuration> module_configs;
+            for(auto& config : job_reader.getConfigurations()) {
+                if(!config.getName().empty()) {
+                    module_configs.push_back(config);
+                }
+            }
+
+            mod_mgr_->startJob(seed, module_configs);
+            mod_mgr_->init();
+            mod_mgr_->run();
+            mod_mgr_->finalize();
+        } catch(std::exception& e) {
+            LOG(FATAL) << "Job " << job_name << " failed:" << std::endl << e.what();
+            return_code = 1;
+        }
+        Log::finish();
+        std::_Exit(return_code);
+    }
+
+    // Wait for the job, continuing if the server is interrupted while waiting
+    int status = 0;
+    while(waitpid(pid, &status, 0) < 0) {
+        if(errno != EINTR) {
+            throw RuntimeError("Cannot wait for process of job " + job_name);
+        }
+    }
+
+    auto end_time = std::chrono::steady_clock::now();
+    auto seconds = static_cast<std::chrono::duration<double>>(end_time - start_time).count();
+    if(!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+        LOG(ERROR) << "Job " << job_name << " failed after " << seconds << " seconds";
+        return false;
+    }
+    LOG(STATUS) << "Finished job " << job_name << " in " << seconds << " seconds";
+    return true;
+}
+
 /**
  * This style is inspired by the CLICdp plot style
  */
@@ -72,7 +72,23 @@ namespace allpix {
          */
         void terminate();
 
+        /**
+         * @brief Initialize the shared modules once and run all jobs submitted to a job directory until terminated
+         * @param job_directory Directory watched for job configuration files
+         * @param once Stop the server as soon as no job is left in the job directory instead of waiting for new jobs
+         * @warning Should be called after the \ref Allpix::load "load function" instead of the init, run and finalize
+         *          functions
+         */
+        void serve(const std::string& job_directory, bool once = false);
+
     private:
+        /**
+         * @brief Run a single job of the server in a separate process
+         * @param job_file Path to the configuration file of the job
+         * @return True if the job has been completed successfully, false otherwise
+         */
+        bool run_job(const std::string& job_file);
+
         /**
          * @brief Set the default ROOT plot style
          */
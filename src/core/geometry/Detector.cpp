@@ -187,6 +187,14 @@ ROOT::Math::XYZVector Detector::getElectricField(const ROOT::Math::XYZPoint& pos
     return electric_field_.get(pos);
 }
 
+/**
+ * The cursor caches the grid cell of the last lookup, which makes it most efficient for consecutive lookups at nearby
+ * positions.
+ */
+DetectorField<ROOT::Math::XYZVector, 3>::Cursor Detector::getElectricFieldCursor() const {
+    return electric_field_.getCursor();
+}
+
 /**
  * The type of the electric field is set depending on the function used to apply it.
  */
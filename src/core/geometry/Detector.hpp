@@ -143,6 +143,13 @@ namespace allpix {
          */
         ROOT::Math::XYZVector getElectricField(const ROOT::Math::XYZPoint& local_pos) const;
 
+        /**
+         * @brief Get a cursor for repeated lookups of the electric field along the path of a single charge carrier
+         * @return Cursor returning the same values as \ref getElectricField
+         * @note The cursor should be kept local to the propagation of one carrier and not be shared between threads
+         */
+        DetectorField<ROOT::Math::XYZVector, 3>::Cursor getElectricFieldCursor() const;
+
         /**
          * @brief Set the electric field in a single pixel in the detector using a grid
          * @param field Flat array of the field vectors (see detailed description)
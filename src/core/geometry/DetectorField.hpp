@@ -60,6 +60,40 @@ namespace allpix {
         friend class Detector;
 
     public:
+        /**
+         * @brief Stateful handle for repeated lookups of the field at nearby positions
+         *
+         * For field grids, the cursor caches the grid cell of the last lookup together with its bounds in local coordinates
+         * and the value of the field. Consecutive lookups within the same cell, such as the sub-steps of a single charge
+         * carrier, are then answered without recomputing the field replica and grid indices. All other field types are
+         * forwarded to \ref DetectorField::get. The returned values are identical to the ones obtained from the field.
+         * @warning A cursor refers to the field it was obtained from and should not be shared between threads
+         */
+        class Cursor {
+        public:
+            /**
+             * @brief Construct a cursor for a field
+             * @param field Field to look up values from
+             */
+            explicit Cursor(const DetectorField* field) : field_(field) {}
+
+            /**
+             * @brief Get the field value in the sensor at a position provided in local coordinates
+             * @param local_pos Position in the local frame
+             * @return Value(s) of the field at the queried point
+             */
+            T get(const ROOT::Math::XYZPoint& local_pos);
+
+        private:
+            const DetectorField* field_;
+
+            // Bounds of the cached cell in local coordinates shifted by the field offset, and the field value within
+            bool cached_{false};
+            std::array<double, 3> lower_{};
+            std::array<double, 3> upper_{};
+            T value_{};
+        };
+
         /**
          * @brief Constructs a detector field
          */
@@ -84,6 +118,12 @@ namespace allpix {
          */
         T get(const ROOT::Math::XYZPoint& local_pos) const;
 
+        /**
+         * @brief Get a cursor for repeated lookups of this field at nearby positions
+         * @return Cursor referring to this field
+         */
+        Cursor getCursor() const { return Cursor(this); }
+
         /**
          * @brief Get the value of the field at a position provided in local coordinates with respect to the reference
          * @param pos       Position in the local frame
@@ -149,6 +189,20 @@ namespace allpix {
          */
         T get_field_from_grid(const ROOT::Math::XYZPoint& dist, const bool extrapolate_z = false) const;
 
+        /**
+         * @brief Helper function to calculate the extent of the grid cell returned by \ref get for a given position
+         * @param pos Position in local coordinates, shifted by the field offset
+         * @param lower Lower bounds of the cell in each coordinate
+         * @param upper Upper bounds of the cell in each coordinate
+         * @return True if the position lies within the field grid, false otherwise
+         *
+         * The bounds are shrunk by a small margin such that all positions strictly inside them are guaranteed to be assigned
+         * to the same cell despite rounding.
+         */
+        bool get_cell_bounds(const ROOT::Math::XYZPoint& pos,
+                             std::array<double, 3>& lower,
+                             std::array<double, 3>& upper) const;
+
         /**
          * Field properties
          * * Dimensions of the field map (bins in x, y, z)
@@ -136,6 +136,73 @@ namespace allpix {
         return ret_val;
     }
 
+    /**
+     * The replica and grid indices are computed exactly as in \ref DetectorField::get, and the corresponding cell is
+     * transformed back into the shifted local frame, taking into account the flipping of odd replicas.
+     */
+    template <typename T, size_t N>
+    bool DetectorField<T, N>::get_cell_bounds(const ROOT::Math::XYZPoint& pos,
+                                              std::array<double, 3>& lower,
+                                              std::array<double, 3>& upper) const {
+        std::array<double, 2> coordinates{{pos.x(), pos.y()}};
+        std::array<double, 2> pitch{{pixel_size_.x(), pixel_size_.y()}};
+        for(size_t i = 0; i < 2; ++i) {
+            auto replica = static_cast<int>(std::floor((coordinates[i] + 0.5 * pitch[i]) / scales_[i]));
+            auto shift = (replica + 0.5) * scales_[i] - 0.5 * pitch[i];
+            auto flip = ((replica % 2) == 1);
+
+            // Cell extent in the replica frame, a single bin spans the full replica
+            auto width = scales_[i] / static_cast<double>(dimensions_[i]);
+            double cell_lower = -scales_[i] / 2.0;
+            if(dimensions_[i] != 1) {
+                auto index = static_cast<int>(std::floor(static_cast<double>(dimensions_[i]) *
+                                                         ((flip ? -1 : 1) * (coordinates[i] - shift) + scales_[i] / 2.0) /
+                                                         scales_[i]));
+                if(index < 0 || index >= static_cast<int>(dimensions_[i])) {
+                    return false;
+                }
+                cell_lower += index * width;
+            }
+
+            // Transform back and shrink by a margin well above the rounding precision
+            auto margin = 1e-6 * width;
+            lower[i] = (flip ? shift - cell_lower - width : shift + cell_lower) + margin;
+            upper[i] = (flip ? shift - cell_lower : shift + cell_lower + width) - margin;
+        }
+
+        auto thickness = thickness_domain_.second - thickness_domain_.first;
+        auto z_ind = static_cast<int>(
+            std::floor(static_cast<double>(dimensions_[2]) * (pos.z() - thickness_domain_.first) / thickness));
+        if(z_ind < 0 || z_ind >= static_cast<int>(dimensions_[2])) {
+            return false;
+        }
+        auto width = thickness / static_cast<double>(dimensions_[2]);
+        lower[2] = thickness_domain_.first + z_ind * width + 1e-6 * width;
+        upper[2] = thickness_domain_.first + (z_ind + 1) * width - 1e-6 * width;
+        return true;
+    }
+
+    /**
+     * Only field grids are cached, since the value of a field function changes at every position. The cache is refreshed
+     * whenever the position leaves the bounds of the cached cell.
+     */
+    template <typename T, size_t N> T DetectorField<T, N>::Cursor::get(const ROOT::Math::XYZPoint& pos) {
+        if(field_->type_ != FieldType::GRID) {
+            return field_->get(pos);
+        }
+
+        // Shift the coordinates by the offset configured for the field:
+        ROOT::Math::XYZPoint shifted(pos.x() + field_->offset_[0], pos.y() + field_->offset_[1], pos.z());
+        if(cached_ && lower_[0] < shifted.x() && shifted.x() < upper_[0] && lower_[1] < shifted.y() &&
+           shifted.y() < upper_[1] && lower_[2] < shifted.z() && shifted.z() < upper_[2]) {
+            return value_;
+        }
+
+        value_ = field_->get(pos);
+        cached_ = field_->get_cell_bounds(shifted, lower_, upper_);
+        return value_;
+    }
+
     /**
      * Woohoo, template magic! Using an index_sequence to construct the templated return type with a variable number of
      * elements from the flat field vector, e.g. 3 for a vector field and 1 for a scalar field. Using a braced-init-list
@@ -8,8 +8,11 @@
  * Intergovernmental Organization or submit itself to any jurisdiction.
  */
 
+#include <algorithm>
 #include <fstream>
+#include <limits>
 #include <memory>
+#include <numeric>
 #include <string>
 #include <utility>
 #include <vector>
@@ -310,7 +313,7 @@ void GeometryManager::addDetector(std::shared_ptr<Detector> detector) {
         throw DetectorExistsError(detector->getName());
     }
 
-    detector_names_.insert(detector->getName());
+    detector_names_.emplace(detector->getName(), detector);
     detectors_.push_back(std::move(detector));
 }
 
@@ -333,13 +336,11 @@ std::shared_ptr<Detector> GeometryManager::getDetector(const std::string& name)
         close_geometry();
     }
 
-    // FIXME: this is not a very nice way to implement this
-    for(auto& detector : detectors_) {
-        if(detector->getName() == name) {
-            return detector;
-        }
+    auto detector = detector_names_.find(name);
+    if(detector == detector_names_.end()) {
+        throw allpix::InvalidDetectorError(name);
     }
-    throw allpix::InvalidDetectorError(name);
+    return detector->second;
 }
 
 /**
@@ -363,6 +364,51 @@ std::vector<std::shared_ptr<Detector>> GeometryManager::getDetectorsByType(const
     return result;
 }
 
+std::pair<std::shared_ptr<Detector>, XYZPoint> GeometryManager::findDetector(const XYZPoint& global_position) {
+    if(!closed_) {
+        close_geometry();
+    }
+
+    // Descend into all nodes containing the position, keeping the detector added first if sensors overlap
+    size_t found = detectors_.size();
+    XYZPoint found_position;
+    std::vector<size_t> stack;
+    if(!sensor_nodes_.empty()) {
+        stack.push_back(0);
+    }
+    while(!stack.empty()) {
+        const auto& node = sensor_nodes_[stack.back()];
+        stack.pop_back();
+        if(global_position.x() < node.min.x() || global_position.y() < node.min.y() || global_position.z() < node.min.z() ||
+           global_position.x() > node.max.x() || global_position.y() > node.max.y() || global_position.z() > node.max.z()) {
+            continue;
+        }
+
+        if(node.count == 0) {
+            stack.push_back(node.first);
+            stack.push_back(node.first + 1);
+            continue;
+        }
+
+        for(size_t i = node.first; i < node.first + node.count; ++i) {
+            auto index = sensor_indices_[i];
+            if(index > found) {
+                continue;
+            }
+            auto local_position = detectors_[index]->getLocalPosition(global_position);
+            if(detectors_[index]->isWithinSensor(local_position)) {
+                found = index;
+                found_position = local_position;
+            }
+        }
+    }
+
+    if(found == detectors_.size()) {
+        return std::make_pair(nullptr, XYZPoint());
+    }
+    return std::make_pair(detectors_[found], found_position);
+}
+
 std::list<Configuration>& GeometryManager::getPassiveElements() {
     return passive_elements_;
 }
@@ -499,9 +545,106 @@ void GeometryManager::close_geometry() {
         }
     }
 
+    // All detectors have their model now, such that the sensors can be indexed
+    build_sensor_tree();
+
     closed_ = true;
     LOG(TRACE) << "Closed geometry";
 }
+
+/**
+ * The bounding box of every sensor is calculated from its eight corners in global coordinates, slightly enlarged to avoid
+ * missing points on the surface due to rounding. The final check whether a point is inside a sensor is always done by the
+ * detector itself.
+ */
+void GeometryManager::build_sensor_tree() {
+    std::vector<std::pair<XYZPoint, XYZPoint>> boxes;
+    for(auto& detector : detectors_) {
+        auto model = detector->getModel();
+
+        XYZPoint min_point(std::numeric_limits<double>::max(),
+                           std::numeric_limits<double>::max(),
+                           std::numeric_limits<double>::max());
+        XYZPoint max_point(std::numeric_limits<double>::lowest(),
+                           std::numeric_limits<double>::lowest(),
+                           std::numeric_limits<double>::lowest());
+        for(size_t i = 0; i < 8; ++i) {
+            auto point = model->getSensorCenter();
+            point.SetX(point.x() + ((i & 1u) != 0 ? 1 : -1) * model->getSensorSize().x() / 2.0);
+            point.SetY(point.y() + ((i & 2u) != 0 ? 1 : -1) * model->getSensorSize().y() / 2.0);
+            point.SetZ(point.z() + ((i & 4u) != 0 ? 1 : -1) * model->getSensorSize().z() / 2.0);
+            point = detector->getGlobalPosition(point);
+
+            min_point.SetXYZ(
+                std::min(min_point.x(), point.x()), std::min(min_point.y(), point.y()), std::min(min_point.z(), point.z()));
+            max_point.SetXYZ(
+                std::max(max_point.x(), point.x()), std::max(max_point.y(), point.y()), std::max(max_point.z(), point.z()));
+        }
+
+        XYZVector margin(Units::get(1.0, "nm"), Units::get(1.0, "nm"), Units::get(1.0, "nm"));
+        boxes.emplace_back(min_point - margin, max_point + margin);
+    }
+
+    sensor_indices_.resize(detectors_.size());
+    std::iota(sensor_indices_.begin(), sensor_indices_.end(), 0);
+    sensor_nodes_.clear();
+    if(!detectors_.empty()) {
+        sensor_nodes_.emplace_back();
+        build_sensor_node(0, 0, detectors_.size(), boxes);
+    }
+    LOG(TRACE) << "Indexed sensors of " << detectors_.size() << " detectors in " << sensor_nodes_.size() << " nodes";
+}
+
+/**
+ * Nodes with more than a few sensors are split at the median of the sensor centers along the longest axis of the node.
+ */
+void GeometryManager::build_sensor_node(size_t node,
+                                        size_t begin,
+                                        size_t end,
+                                        const std::vector<std::pair<XYZPoint, XYZPoint>>& boxes) {
+    XYZPoint min_point = boxes[sensor_indices_[begin]].first;
+    XYZPoint max_point = boxes[sensor_indices_[begin]].second;
+    for(size_t i = begin + 1; i < end; ++i) {
+        const auto& box = boxes[sensor_indices_[i]];
+        min_point.SetXYZ(std::min(min_point.x(), box.first.x()),
+                         std::min(min_point.y(), box.first.y()),
+                         std::min(min_point.z(), box.first.z()));
+        max_point.SetXYZ(std::max(max_point.x(), box.second.x()),
+                         std::max(max_point.y(), box.second.y()),
+                         std::max(max_point.z(), box.second.z()));
+    }
+    sensor_nodes_[node].min = min_point;
+    sensor_nodes_[node].max = max_point;
+
+    // Store a small number of sensors in a leaf
+    if(end - begin <= 4) {
+        sensor_nodes_[node].first = begin;
+        sensor_nodes_[node].count = end - begin;
+        return;
+    }
+
+    // Split along the longest axis of the node at the median sensor center
+    auto extent = max_point - min_point;
+    auto center = [&](size_t index) {
+        const auto& box = boxes[index];
+        auto sum = box.first + XYZVector(box.second);
+        if(extent.x() >= extent.y() && extent.x() >= extent.z()) {
+            return sum.x();
+        }
+        return (extent.y() >= extent.z() ? sum.y() : sum.z());
+    };
+    size_t middle = begin + (end - begin) / 2;
+    std::nth_element(sensor_indices_.begin() + static_cast<std::ptrdiff_t>(begin),
+                     sensor_indices_.begin() + static_cast<std::ptrdiff_t>(middle),
+                     sensor_indices_.begin() + static_cast<std::ptrdiff_t>(end),
+                     [&](size_t lhs, size_t rhs) { return center(lhs) < center(rhs); });
+
+    auto first_child = sensor_nodes_.size();
+    sensor_nodes_[node].first = first_child;
+    sensor_nodes_.resize(first_child + 2);
+    build_sensor_node(first_child, begin, middle, boxes);
+    build_sensor_node(first_child + 1, middle, end, boxes);
+}
 /*
  * Calculates the position and orientation of the object from the provided configuration file
  */
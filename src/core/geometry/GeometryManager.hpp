@@ -10,6 +10,7 @@
 #ifndef ALLPIX_GEOMETRY_MANAGER_H
 #define ALLPIX_GEOMETRY_MANAGER_H
 
+#include <map>
 #include <memory>
 #include <random>
 #include <set>
@@ -189,6 +190,18 @@ namespace allpix {
          */
         std::vector<std::shared_ptr<Detector>> getDetectorsByType(const std::string& type);
 
+        /**
+         * @brief Find the detector with the sensor containing a global position
+         * @param global_position Position in global coordinates
+         * @return Pair of the detector and the position in its local coordinates, where the detector is a null pointer if
+         *         the position is not inside the sensor of any detector
+         * @note Closes the geometry if it has not been closed yet
+         *
+         * The sensors are looked up in a bounding volume hierarchy, such that the time to find the detector only grows
+         * logarithmically with the number of detectors. If sensors overlap, the detector added first is returned.
+         */
+        std::pair<std::shared_ptr<Detector>, ROOT::Math::XYZPoint> findDetector(const ROOT::Math::XYZPoint& global_position);
+
         /**
          * @brief Set the magnetic field in the volume
          * @param function Function used to retrieve the magnetic field
@@ -268,6 +281,37 @@ namespace allpix {
         void close_geometry();
         std::atomic_bool closed_;
 
+        /**
+         * @brief Node in the bounding volume hierarchy of the sensors
+         *
+         * Inner nodes refer to the first of their two consecutive child nodes, leaf nodes to a range of detectors in the
+         * list of sensor indices.
+         */
+        struct SensorNode {
+            ROOT::Math::XYZPoint min;
+            ROOT::Math::XYZPoint max;
+            size_t first{};
+            size_t count{};
+        };
+
+        /**
+         * @brief Build the bounding volume hierarchy over the sensors of all detectors
+         */
+        void build_sensor_tree();
+        /**
+         * @brief Build a node of the bounding volume hierarchy and its children
+         * @param node Index of the node to build
+         * @param begin First entry of the sensor indices in this node
+         * @param end Entry past the last sensor index in this node
+         * @param boxes Bounding boxes of the sensors of all detectors
+         */
+        void build_sensor_node(size_t node,
+                               size_t begin,
+                               size_t end,
+                               const std::vector<std::pair<ROOT::Math::XYZPoint, ROOT::Math::XYZPoint>>& boxes);
+        std::vector<SensorNode> sensor_nodes_;
+        std::vector<size_t> sensor_indices_;
+
         std::mt19937_64 random_generator_;
 
         std::vector<ROOT::Math::XYZPoint> points_;
@@ -278,7 +322,7 @@ namespace allpix {
 
         std::map<std::string, std::vector<std::pair<Configuration, Detector*>>> nonresolved_models_;
         std::vector<std::shared_ptr<Detector>> detectors_;
-        std::set<std::string> detector_names_;
+        std::map<std::string, std::shared_ptr<Detector>> detector_names_;
 
         std::list<Configuration> passive_elements_;
         std::map<std::string, std::pair<ROOT::Math::XYZPoint, ROOT::Math::Rotation3D>> passive_orientations_;
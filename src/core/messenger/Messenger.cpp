@@ -10,6 +10,7 @@
 
 #include "Messenger.hpp"
 
+#include <algorithm>
 #include <memory>
 #include <stdexcept>
 #include <string>
@@ -45,11 +46,26 @@ static bool check_send(BaseMessage* message, BaseDelegate* delegate) {
  * Messages should be bound during construction, so this function only gives useful information outside the constructor
  */
 bool Messenger::hasReceiver(Module* source, const std::shared_ptr<BaseMessage>& message) {
-    std::lock_guard<std::mutex> lock(mutex_);
-
     const BaseMessage* inst = message.get();
     std::type_index type_idx = typeid(*inst);
 
+    // Use the routing table if it is available
+    if(routing_compiled_.load(std::memory_order_acquire)) {
+        auto source_iter = routing_table_.find(source);
+        if(source_iter != routing_table_.end()) {
+            auto type_iter = source_iter->second.typed.find(type_idx);
+            const auto& routes =
+                (type_iter != source_iter->second.typed.end() ? type_iter->second : source_iter->second.base_only);
+
+            auto detector = message->getDetector();
+            return std::any_of(routes.begin(), routes.end(), [&detector](const Route& route) {
+                return route.detector == nullptr || route.detector == detector.get();
+            });
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+
     // Get the name of the output message
     auto name = source->get_configuration().get<std::string>("output");
 
@@ -85,6 +101,11 @@ bool Messenger::hasReceiver(Module* source, const std::shared_ptr<BaseMessage>&
  * Send messages to all specific listeners and also to all generic listeners (listening to all incoming messages)
  */
 void Messenger::dispatch_message(Module* source, const std::shared_ptr<BaseMessage>& message, std::string name) {
+    // Dispatch without locking if the receivers are known already
+    if(name == "-" && routing_compiled_.load(std::memory_order_acquire) && dispatch_routed(source, message)) {
+        return;
+    }
+
     std::lock_guard<std::mutex> lock(mutex_);
 
     // Get the name of the output message
@@ -108,7 +129,65 @@ void Messenger::dispatch_message(Module* source, const std::shared_ptr<BaseMessa
     }
 
     // Save a copy of the sent message
-    sent_messages_.emplace_back(message);
+    keep_message(source, message, name);
+}
+
+/**
+ * Routes are resolved by \ref Messenger::compileRoutingTable(), the table is only read here and can thus be accessed
+ * concurrently. Detectors are compared by identity, because every detector exists only once in the geometry.
+ */
+bool Messenger::dispatch_routed(Module* source, const std::shared_ptr<BaseMessage>& message) {
+    auto source_iter = routing_table_.find(source);
+    if(source_iter == routing_table_.end()) {
+        return false;
+    }
+    const auto& source_routes = source_iter->second;
+
+    const BaseMessage* inst = message.get();
+    std::type_index type_idx = typeid(*inst);
+    auto type_iter = source_routes.typed.find(type_idx);
+    const auto& routes = (type_iter != source_routes.typed.end() ? type_iter->second : source_routes.base_only);
+
+    auto detector = message->getDetector();
+    bool send = false;
+    for(const auto& route : routes) {
+        if(route.detector != nullptr && route.detector != detector.get()) {
+            continue;
+        }
+
+        LOG(TRACE) << "Sending message " << allpix::demangle(type_idx.name()) << " from " << source->getUniqueName()
+                   << " to " << (route.generic ? "generic listener " : "") << route.delegate->getUniqueName();
+        std::lock_guard<std::mutex> lock(*route.receiver_mutex);
+        route.delegate->process(message, source_routes.name);
+        send = true;
+    }
+
+    // Display a TRACE log message if the message is send to no receiver
+    if(!send) {
+        LOG(TRACE) << "Dispatched message " << allpix::demangle(type_idx.name()) << " from " << source->getUniqueName()
+                   << " has no receivers!";
+    }
+
+    // Save a copy of the sent message
+    keep_message(source, message, source_routes.name);
+    return true;
+}
+
+void Messenger::keep_message(const Module* source, const std::shared_ptr<BaseMessage>& message, const std::string& name) {
+    std::lock_guard<std::mutex> lock(sent_messages_mutex_);
+    sent_messages_.emplace_back(source, message, name);
+}
+
+std::vector<std::pair<std::shared_ptr<BaseMessage>, std::string>> Messenger::getDispatchedMessages(const Module* source) {
+    std::lock_guard<std::mutex> lock(sent_messages_mutex_);
+
+    std::vector<std::pair<std::shared_ptr<BaseMessage>, std::string>> messages;
+    for(auto& sent_message : sent_messages_) {
+        if(std::get<0>(sent_message) == source) {
+            messages.emplace_back(std::get<1>(sent_message), std::get<2>(sent_message));
+        }
+    }
+    return messages;
 }
 
 /**
@@ -129,6 +208,8 @@ bool Messenger::dispatch_message(Module* source,
         if(check_send(message.get(), delegate.get())) {
             LOG(TRACE) << "Sending message " << allpix::demangle(type_idx.name()) << " from " << source->getUniqueName()
                        << " to " << delegate->getUniqueName();
+            Module* receiver = std::get<3>(delegate_to_iterator_.at(delegate.get()));
+            std::lock_guard<std::mutex> receiver_lock(receiver->delegate_mutex_);
             delegate->process(message, name);
             send = true;
         }
@@ -140,6 +221,8 @@ bool Messenger::dispatch_message(Module* source,
         if(check_send(message.get(), delegate.get())) {
             LOG(TRACE) << "Sending message " << allpix::demangle(type_idx.name()) << " from " << source->getUniqueName()
                        << " to generic listener " << delegate->getUniqueName();
+            Module* receiver = std::get<3>(delegate_to_iterator_.at(delegate.get()));
+            std::lock_guard<std::mutex> receiver_lock(receiver->delegate_mutex_);
             delegate->process(message, name);
             send = true;
         }
@@ -163,7 +246,11 @@ void Messenger::add_delegate(const std::type_info& message_type, Module* module,
     delegates_[std::type_index(message_type)][message_name].push_back(std::move(delegate));
     auto delegate_iter = --delegates_[std::type_index(message_type)][message_name].end();
     delegate_to_iterator_.emplace(delegate_iter->get(),
-                                  std::make_tuple(std::type_index(message_type), message_name, delegate_iter));
+                                  std::make_tuple(std::type_index(message_type), message_name, delegate_iter, module));
+
+    // Invalidate the routing table
+    routing_compiled_ = false;
+    routing_table_.clear();
 
     // Add delegate to the module itself
     module->add_delegate(this, delegate_iter->get());
@@ -181,4 +268,65 @@ void Messenger::remove_delegate(BaseDelegate* delegate) {
     }
     delegates_[std::get<0>(iter->second)][std::get<1>(iter->second)].erase(std::get<2>(iter->second));
     delegate_to_iterator_.erase(iter);
+
+    // Invalidate the routing table
+    routing_compiled_ = false;
+    routing_table_.clear();
+}
+
+/**
+ * For every sending module the receivers are resolved for all message types with a registered delegate, the receivers of
+ * all other message types are the generic listeners only. The order of the receivers is the same as for the regular dispatch
+ * to keep the behaviour identical: first the listeners to the output name, then the listeners to all names.
+ */
+void Messenger::compileRoutingTable(const std::vector<Module*>& modules) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    routing_compiled_ = false;
+    routing_table_.clear();
+
+    auto add_routes = [this](std::vector<Route>& routes, std::type_index type_idx, const std::string& id) {
+        auto type_iter = delegates_.find(type_idx);
+        if(type_iter == delegates_.end()) {
+            return;
+        }
+        auto id_iter = type_iter->second.find(id);
+        if(id_iter == type_iter->second.end()) {
+            return;
+        }
+        for(auto& delegate : id_iter->second) {
+            Module* receiver = std::get<3>(delegate_to_iterator_.at(delegate.get()));
+            routes.push_back(Route{delegate.get(),
+                                   delegate->getDetector().get(),
+                                   &receiver->delegate_mutex_,
+                                   type_idx == std::type_index(typeid(BaseMessage))});
+        }
+    };
+
+    size_t route_count = 0;
+    for(auto* module : modules) {
+        auto& source_routes = routing_table_[module];
+        source_routes.name = module->get_configuration().get<std::string>("output");
+
+        for(auto& type_delegates : delegates_) {
+            if(type_delegates.first == std::type_index(typeid(BaseMessage))) {
+                continue;
+            }
+
+            auto& routes = source_routes.typed[type_delegates.first];
+            add_routes(routes, type_delegates.first, source_routes.name);
+            add_routes(routes, typeid(BaseMessage), source_routes.name);
+            add_routes(routes, type_delegates.first, "*");
+            add_routes(routes, typeid(BaseMessage), "*");
+            route_count += routes.size();
+        }
+
+        add_routes(source_routes.base_only, typeid(BaseMessage), source_routes.name);
+        add_routes(source_routes.base_only, typeid(BaseMessage), "*");
+        route_count += source_routes.base_only.size();
+    }
+
+    LOG(DEBUG) << "Compiled message routing table with " << route_count << " routes for " << modules.size()
+               << " sending modules";
+    routing_compiled_.store(true, std::memory_order_release);
 }
@@ -11,10 +11,15 @@
 #ifndef ALLPIX_MESSENGER_H
 #define ALLPIX_MESSENGER_H
 
+#include <atomic>
 #include <list>
 #include <map>
 #include <memory>
+#include <mutex>
+#include <string>
+#include <tuple>
 #include <typeindex>
+#include <unordered_map>
 #include <utility>
 
 #include "Message.hpp"
@@ -29,6 +34,10 @@ namespace allpix {
      *
      * Dispatches messages from modules to other listening modules. There are various way to receive the messages using
      * \ref Delegates. Messages are only send to modules listening to the exact same type of message.
+     *
+     * After all modules are initialized, the receivers of every sending module and message type are resolved once into a
+     * routing table. Messages sent with the default name are then dispatched without taking the global messenger lock,
+     * only the receiving module is locked while its delegate processes the message.
      */
     class Messenger {
         friend class Module;
@@ -118,10 +127,28 @@ namespace allpix {
         template <typename T>
         void dispatchMessage(Module* source, std::shared_ptr<T> message, const std::string& name = "-");
 
+        /**
+         * @brief Compile the routing table used to dispatch messages without locking the messenger
+         * @param modules List of all module instantiations which can dispatch messages
+         * @warning Should only be called after all delegates have been registered, the table is invalidated again if a
+         *          delegate is added or removed afterwards
+         */
+        void compileRoutingTable(const std::vector<Module*>& modules);
+
+        /**
+         * @brief Get the messages dispatched by a module since the list of sent messages was last cleared
+         * @param source Module which dispatched the messages
+         * @return List of the messages in the order of dispatching, together with the name they were dispatched under
+         */
+        std::vector<std::pair<std::shared_ptr<BaseMessage>, std::string>> getDispatchedMessages(const Module* source);
+
         /**
          * @brief Removes the list of sent messages, clearing them from memory if not otherwise used
          */
-        inline void clearMessages() { sent_messages_.clear(); }
+        inline void clearMessages() {
+            std::lock_guard<std::mutex> lock(sent_messages_mutex_);
+            sent_messages_.clear();
+        }
 
     private:
         /**
@@ -159,14 +186,52 @@ namespace allpix {
                               const std::string& name,
                               const std::string& id);
 
+        /**
+         * @brief Dispatch base message using the compiled routing table
+         * @param source Dispatching module
+         * @param message Message to dispatch
+         * @return True if the source is part of the routing table and the message has been dispatched, false otherwise
+         */
+        bool dispatch_routed(Module* source, const std::shared_ptr<BaseMessage>& message);
+
+        /**
+         * @brief Store a copy of a dispatched message until the messages are cleared
+         * @param source Module dispatching the message
+         * @param message Message to keep
+         * @param name Name the message is dispatched under
+         */
+        void keep_message(const Module* source, const std::shared_ptr<BaseMessage>& message, const std::string& name);
+
         using DelegateMap = std::map<std::type_index, std::map<std::string, std::list<std::unique_ptr<BaseDelegate>>>>;
-        using DelegateIteratorMap =
-            std::map<BaseDelegate*,
-                     std::tuple<std::type_index, std::string, std::list<std::unique_ptr<BaseDelegate>>::iterator>>;
+        using DelegateIteratorMap = std::map<
+            BaseDelegate*,
+            std::tuple<std::type_index, std::string, std::list<std::unique_ptr<BaseDelegate>>::iterator, Module*>>;
 
         DelegateMap delegates_;
         DelegateIteratorMap delegate_to_iterator_;
-        std::vector<std::shared_ptr<BaseMessage>> sent_messages_;
+
+        /**
+         * @brief Single receiver of a message in the routing table
+         */
+        struct Route {
+            BaseDelegate* delegate;
+            const Detector* detector;
+            std::mutex* receiver_mutex;
+            bool generic;
+        };
+        /**
+         * @brief All routes of messages sent by a single module
+         */
+        struct SourceRoutes {
+            std::string name;
+            std::unordered_map<std::type_index, std::vector<Route>> typed;
+            std::vector<Route> base_only;
+        };
+        std::unordered_map<const Module*, SourceRoutes> routing_table_;
+        std::atomic<bool> routing_compiled_{false};
+
+        std::vector<std::tuple<const Module*, std::shared_ptr<BaseMessage>, std::string>> sent_messages_;
+        std::mutex sent_messages_mutex_;
 
         mutable std::mutex mutex_;
     };
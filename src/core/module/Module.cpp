@@ -24,7 +24,10 @@ using namespace allpix;
 
 Module::Module(Configuration& config) : Module(config, nullptr) {}
 Module::Module(Configuration& config, std::shared_ptr<Detector> detector)
-    : config_(config), detector_(std::move(detector)) {}
+    : config_(config), detector_(std::move(detector)) {
+    seed_per_event_ = config_.get<bool>("_seed_per_event", false);
+    event_seed_key_ = config_.get<uint64_t>("_seed", 0);
+}
 /**
  * @note The remove_delegate can throw in theory, but this should never happen in practice
  */
@@ -67,7 +70,8 @@ std::shared_ptr<Detector> Module::getDetector() const {
  * @warning A local path cannot be fetched from the constructor, because the instantiation logic has not finished yet
  *
  * The output path is automatically created if it does not exists. The path is always accessible if this functions returns.
- * Obeys the "deny_overwrite" parameter of the module.
+ * Obeys the "deny_overwrite" parameter of the module. Existing files are not deleted if the run is resumed from a
+ * checkpoint.
  */
 std::string Module::createOutputFile(const std::string& path, bool global, bool delete_file) {
     std::string file;
@@ -90,7 +94,9 @@ std::string Module::createOutputFile(const std::string& path, bool global, bool
         file += "/";
         file += path;
 
-        if(path_is_file(file)) {
+        // Keep existing files when resuming a run, such that writers can continue them from the checkpoint
+        auto resume = getConfigManager()->getGlobalConfiguration().get<bool>("resume", false);
+        if(path_is_file(file) && !resume) {
             auto global_overwrite = getConfigManager()->getGlobalConfiguration().get<bool>("deny_overwrite", false);
             if(config_.get<bool>("deny_overwrite", global_overwrite)) {
                 throw ModuleError("Overwriting of existing file " + file + " denied.");
@@ -137,6 +143,31 @@ uint64_t Module::getRandomSeed() {
     return random_generator_();
 }
 
+/**
+ * Streams are distinguished by the upper half of the engine counter only, such that e.g. one stream per thread or per event
+ * can be derived without any shared state between them.
+ */
+RandomEngine Module::getRandomEngine(uint64_t stream) {
+    if(initialized_random_engine_key_ == false) {
+        random_engine_key_ = getRandomSeed();
+        initialized_random_engine_key_ = true;
+    }
+
+    return RandomEngine(random_engine_key_, stream);
+}
+
+/**
+ * The event number selects the stream of a counter-based engine keyed with the module seed. The seed of an event is thus
+ * independent of the number of random numbers drawn in the events before, such that a run can be split into shards.
+ */
+uint64_t Module::getEventSeed(unsigned int event_num) const {
+    return RandomEngine(event_seed_key_, event_num)();
+}
+
+bool Module::isSeededPerEvent() const {
+    return seed_per_event_;
+}
+
 /**
  * @throws InvalidModuleActionException If the thread pool is accessed outside the run-method
  * @warning Any multithreaded task should be carefully checked to ensure it is thread-safe
@@ -10,7 +10,10 @@
 #ifndef ALLPIX_MODULE_H
 #define ALLPIX_MODULE_H
 
+#include <istream>
 #include <memory>
+#include <mutex>
+#include <ostream>
 #include <random>
 #include <string>
 #include <vector>
@@ -24,6 +27,7 @@
 #include "core/geometry/Detector.hpp"
 #include "core/messenger/delegates.h"
 #include "core/module/exceptions.h"
+#include "core/utils/prng.h"
 
 namespace allpix {
     class Messenger;
@@ -112,6 +116,28 @@ namespace allpix {
          */
         uint64_t getRandomSeed();
 
+        /**
+         * @brief Get a counter-based random engine for an independent stream of random numbers
+         * @param stream Number of the stream, engines of different streams are statistically independent
+         * @return Random engine positioned at the start of the stream
+         * @note All streams of a module share the same key, which is drawn from \ref getRandomSeed on the first call
+         */
+        RandomEngine getRandomEngine(uint64_t stream = 0);
+
+        /**
+         * @brief Get seed to initialize random generators for a single event
+         * @param event_num Number of the event
+         * @return Seed only depending on the seed of the module and the event number
+         * @note Allows to reproduce an event independently of the events simulated before it
+         */
+        uint64_t getEventSeed(unsigned int event_num) const;
+
+        /**
+         * @brief Check if the random generators should be seeded at the beginning of every event
+         * @return True if the generators are seeded per event, false otherwise
+         */
+        bool isSeededPerEvent() const;
+
         /**
          * @brief Get thread pool to submit asynchronous tasks to
          */
@@ -159,6 +185,23 @@ namespace allpix {
          */
         virtual void finalize() {}
 
+        /**
+         * @brief Store the state of the module at the end of an event in a checkpoint
+         * @param state Stream to write the state to
+         *
+         * Only state which changes from event to event has to be stored, such as random number generators or positions in
+         * input and output files. Does nothing if not overloaded.
+         */
+        virtual void saveState(std::ostream& state) { (void)state; }
+
+        /**
+         * @brief Restore the state of the module from a checkpoint after initialization
+         * @param state Stream to read the state from, as written by \ref saveState
+         *
+         * Does nothing if not overloaded.
+         */
+        virtual void loadState(std::istream& state) { (void)state; }
+
     protected:
         /**
          * @brief Enable parallelization for this module
@@ -172,6 +215,17 @@ namespace allpix {
         Configuration& get_configuration();
         Configuration& config_;
 
+        /**
+         * @brief Seed a random generator for the given event if seeding per event is enabled
+         * @param generator Random generator providing a seed method
+         * @param event_num Number of the event
+         */
+        template <typename Generator> void seed_event(Generator& generator, unsigned int event_num) const {
+            if(seed_per_event_) {
+                generator.seed(getEventSeed(event_num));
+            }
+        }
+
     private:
         /**
          * @brief Set the module identifier for internal use
@@ -221,10 +275,17 @@ namespace allpix {
          */
         bool check_delegates();
         std::vector<std::pair<Messenger*, BaseDelegate*>> delegates_;
+        std::mutex delegate_mutex_;
 
         bool initialized_random_generator_{false};
         std::mt19937_64 random_generator_;
 
+        bool initialized_random_engine_key_{false};
+        uint64_t random_engine_key_{};
+
+        bool seed_per_event_{false};
+        uint64_t event_seed_key_{};
+
         std::shared_ptr<Detector> detector_;
 
         bool parallelize_{false};
@@ -15,15 +15,24 @@
 
 #include <algorithm>
 #include <chrono>
+#include <cstdio>
 #include <cstring>
 #include <fstream>
+#include <functional>
+#include <iomanip>
 #include <limits>
 #include <random>
 #include <set>
+#include <sstream>
 #include <stdexcept>
 #include <string>
+#include <typeindex>
 
+#include <TH1.h>
+#include <TKey.h>
 #include <TProcessID.h>
+#include <TROOT.h>
+#include <TRandom.h>
 #include <TSystem.h>
 
 #include "core/config/ConfigManager.hpp"
@@ -33,6 +42,9 @@
 #include "core/messenger/Messenger.hpp"
 #include "core/utils/file.h"
 #include "core/utils/log.h"
+#include "core/utils/text.h"
+#include "core/utils/type.h"
+#include "objects/objects.h"
 
 // Common prefix for all modules
 // TODO [doc] Should be provided by the build system
@@ -44,6 +56,64 @@
 
 using namespace allpix;
 
+// Conversion of the objects read from the stage cache to a message of the matching type
+using StageMessageCreator =
+    std::function<std::shared_ptr<BaseMessage>(const std::vector<Object*>&, std::shared_ptr<const Detector>)>;
+
+/**
+ * @brief Names of all storable message types and the functions to recreate messages from their stored objects
+ */
+struct StageMessageTypes {
+    std::map<std::type_index, std::string> names;
+    std::map<std::string, StageMessageCreator> creators;
+};
+
+/**
+ * Adds the name of a message containing this particular type of object and the function to recreate such a message from a
+ * vector of generic objects. References to the objects are moved to the copies in the new message.
+ */
+template <typename T> static void add_stage_message_type(StageMessageTypes& types) {
+    auto name = allpix::demangle(typeid(T).name());
+    types.names[typeid(Message<T>)] = name;
+    types.creators[name] = [](const std::vector<Object*>& objects, std::shared_ptr<const Detector> detector) {
+        std::vector<T> data;
+        data.reserve(objects.size());
+        for(auto& object : objects) {
+            data.emplace_back(*static_cast<T*>(object));
+        }
+
+        // Fix the object references after insertion, as otherwise the objects could have been relocated
+        for(size_t i = 0; i < objects.size(); ++i) {
+            if(objects[i]->TestBit(kIsReferenced)) {
+                auto* pid = TProcessID::GetProcessWithUID(&data[i]);
+                objects[i]->ResetBit(kIsReferenced);
+                data[i].SetBit(kIsReferenced);
+                pid->PutObjectWithID(&data[i]);
+            }
+        }
+
+        if(detector == nullptr) {
+            return std::make_shared<Message<T>>(std::move(data));
+        }
+        return std::make_shared<Message<T>>(std::move(data), detector);
+    };
+}
+
+/**
+ * Calls \ref add_stage_message_type for all objects in the tuple of objects
+ */
+template <typename... Args> static StageMessageTypes gen_stage_message_types(type_tag<std::tuple<Args...>>) {
+    StageMessageTypes types;
+    std::initializer_list<int> value{(add_stage_message_type<Args>(types), 0)...};
+    (void)value;
+    return types;
+}
+
+static const StageMessageTypes& get_stage_message_types() {
+    static const StageMessageTypes types = gen_stage_message_types(type_tag<allpix::OBJECTS>());
+    return types;
+}
+
 ModuleManager::ModuleManager() : terminate_(false) {}
 
 /**
@@ -54,27 +124,48 @@ void ModuleManager::load(Messenger* messenger,
                          ConfigManager* conf_manager,
                          GeometryManager* geo_manager,
                          std::mt19937_64& seeder) {
-    // Store config manager and get configurations
+    // Store config manager and messenger and get configurations
     conf_manager_ = conf_manager;
+    messenger_ = messenger;
+    geo_manager_ = geo_manager;
     auto& configs = conf_manager_->getModuleConfigurations();
     Configuration& global_config = conf_manager_->getGlobalConfiguration();
 
     // (Re)create the main ROOT file
-    auto path = std::string(gSystem->pwd()) + "/" + global_config.get<std::string>("root_file", "modules");
-    path = allpix::add_file_extension(path, "root");
+    create_main_file();
+
+    // Store the checkpoint settings, the checkpoint is placed next to the main ROOT file
+    checkpoint_interval_ = global_config.get<unsigned int>("checkpoint_interval", 0u);
+    checkpoint_path_ = std::string(gSystem->pwd()) + "/" + global_config.get<std::string>("checkpoint_file", "checkpoint");
+    checkpoint_path_ = allpix::add_file_extension(checkpoint_path_, "root");
+
+    // Replace sections with a parameter sweep by one section per sweep point, each with its own output name
+    for(auto config_iter = configs.begin(); config_iter != configs.end();) {
+        if(!config_iter->has("sweep_parameter")) {
+            ++config_iter;
+            continue;
+        }
 
-    if(allpix::path_is_file(path)) {
-        if(global_config.get<bool>("deny_overwrite", false)) {
-            throw RuntimeError("Overwriting of existing main ROOT file " + path + " denied");
+        auto parameter = config_iter->get<std::string>("sweep_parameter");
+        auto values = config_iter->getArray<std::string>("sweep_values");
+        if(values.empty()) {
+            throw InvalidValueError(*config_iter, "sweep_values", "at least one value is required for a parameter sweep");
         }
-        LOG(WARNING) << "Main ROOT file " << path << " exists and will be overwritten.";
-        allpix::remove_file(path);
-    }
-    modules_file_ = std::make_unique<TFile>(path.c_str(), "RECREATE");
-    if(modules_file_->IsZombie()) {
-        throw RuntimeError("Cannot create main ROOT file " + path);
+        auto output = config_iter->get<std::string>("output", "");
+        if(output.empty()) {
+            output = "sweep";
+        }
+
+        for(size_t i = 0; i < values.size(); ++i) {
+            Configuration sweep_config = *config_iter;
+            sweep_config.setText(parameter, values[i]);
+            sweep_config.set<std::string>("output", output + std::to_string(i));
+            LOG(INFO) << "Sweep point " << i << " of module " << config_iter->getName() << " with " << parameter << " = "
+                      << values[i] << " uses output name \"" << output << i << "\"";
+            configs.insert(config_iter, std::move(sweep_config));
+        }
+        config_iter = configs.erase(config_iter);
     }
-    modules_file_->cd();
 
     // Loop through all non-global configurations
     for(auto& config : configs) {
@@ -242,6 +333,26 @@ void ModuleManager::load(Messenger* messenger,
 /**
  * For unique modules a single instance is created per section
  */
+void ModuleManager::create_main_file() {
+    Configuration& global_config = conf_manager_->getGlobalConfiguration();
+    auto path = std::string(gSystem->pwd()) + "/" + global_config.get<std::string>("root_file", "modules");
+    path = allpix::add_file_extension(path, "root");
+
+    // The file of a resumed run is recreated from the histograms stored in the checkpoint
+    if(allpix::path_is_file(path)) {
+        if(global_config.get<bool>("deny_overwrite", false) && !global_config.get<bool>("resume", false)) {
+            throw RuntimeError("Overwriting of existing main ROOT file " + path + " denied");
+        }
+        LOG(WARNING) << "Main ROOT file " << path << " exists and will be overwritten.";
+        allpix::remove_file(path);
+    }
+    modules_file_ = std::make_unique<TFile>(path.c_str(), "RECREATE");
+    if(modules_file_->IsZombie()) {
+        throw RuntimeError("Cannot create main ROOT file " + path);
+    }
+    modules_file_->cd();
+}
+
 std::pair<ModuleIdentifier, Module*> ModuleManager::create_unique_modules(
     void* library, Configuration& config, Messenger* messenger, GeometryManager* geo_manager, std::mt19937_64& seeder) {
     // Make the vector to return
@@ -281,6 +392,8 @@ std::pair<ModuleIdentifier, Module*> ModuleManager::create_unique_modules(
 
     // Specialize instance configuration
     instance_config.set<uint64_t>("_seed", seeder());
+    instance_config.set<bool>("_seed_per_event",
+                              conf_manager_->getGlobalConfiguration().get<bool>("seed_per_event", false));
     std::string output_dir;
     output_dir = instance_config.get<std::string>("_global_dir");
     output_dir += "/";
@@ -408,6 +521,8 @@ std::vector<std::pair<ModuleIdentifier, Module*>> ModuleManager::create_detector
 
         // Add internal module config
         instance_config.set<uint64_t>("_seed", seeder());
+        instance_config.set<bool>("_seed_per_event",
+                                  conf_manager_->getGlobalConfiguration().get<bool>("seed_per_event", false));
         std::string output_dir;
         output_dir = instance_config.get<std::string>("_global_dir");
         output_dir += "/";
@@ -503,20 +618,185 @@ void ModuleManager::set_module_after(std::tuple<LogLevel, LogFormat> prev) {
 }
 
 /**
- * Sets the section header and logging settings before executing the  \ref Module::init() function.
+ * @throws InvalidValueError If the number of workers is set to zero
+ *
+ * The main thread is not counted in the returned number. Without multithreading enabled no additional worker is used.
+ */
+unsigned int ModuleManager::get_worker_count() {
+    Configuration& global_config = conf_manager_->getGlobalConfiguration();
+
+    global_config.setDefault("experimental_multithreading", false);
+    if(!global_config.get<bool>("experimental_multithreading")) {
+        return 0;
+    }
+
+    // Try to fetch a suitable number of workers if multithreading is enabled
+    auto threads_num = global_config.get<unsigned int>("workers", std::max(std::thread::hardware_concurrency(), 1u));
+    if(threads_num == 0) {
+        throw InvalidValueError(global_config, "workers", "number of workers should be strictly more than zero");
+    }
+    return threads_num - 1;
+}
+
+/**
+ * The ROOT directories of all modules are created first on the main thread. Afterwards the \ref Module::init() function is
+ * executed for all modules in order of instantiation. Instantiations of the same module which \ref Module::canParallelize()
+ * "can be parallelized" are initialized concurrently on a thread pool, all other modules are initialized on the main thread
+ * after all previous modules finished. This keeps the initialization order between different modules, as later modules
+ * may depend on the initialization of earlier ones (such as propagation modules on the electric field of the detector).
+ *
+ * Sets the section header and logging settings before executing the \ref Module::init() function.
  *  \ref Module::reset_delegates() "Resets" the delegates and the logging after initialization.
  */
 void ModuleManager::init() {
     auto start_time = std::chrono::steady_clock::now();
-    LOG_PROGRESS(STATUS, "INIT_LOOP") << "Initializing " << modules_.size() << " module instantiations";
+
+    // Instantiations initialized by the server are shared by all of its jobs
+    auto first_module = std::next(modules_.begin(), static_cast<std::ptrdiff_t>(server_modules_));
+    auto module_count = std::distance(first_module, modules_.end());
+    LOG_PROGRESS(STATUS, "INIT_LOOP") << "Initializing " << module_count << " module instantiations";
+
+    // Create all ROOT directories up front, as creating them is not thread safe
+    create_ROOT_directories(first_module, modules_.end());
+    init_modules(first_module, modules_.end());
+    LOG_PROGRESS(STATUS, "INIT_LOOP") << "Initialized " << module_count << " module instantiations";
+
+    // All delegates are registered now, resolve the message receivers of every module
+    std::vector<Module*> module_list;
+    for(auto& module : modules_) {
+        module_list.emplace_back(module.get());
+    }
+    messenger_->compileRoutingTable(module_list);
+
+    // Describe the settings of the cached stage once all modules have published their external objects
+    init_stage_cache();
+
+    // Restore the state of all modules if an interrupted run is resumed
+    if(conf_manager_->getGlobalConfiguration().get<bool>("resume", false)) {
+        resume_event_ = read_checkpoint();
+        LOG(STATUS) << "Restored state of " << modules_.size() << " module instantiations after event " << resume_event_;
+    }
+
+    auto end_time = std::chrono::steady_clock::now();
+    total_time_ += static_cast<std::chrono::duration<long double>>(end_time - start_time).count();
+}
+
+/**
+ * The instantiations shared by the jobs are all instantiations up to the last one with the server_init parameter enabled,
+ * such that every instantiation initialized by the server only depends on instantiations initialized before it. As every job
+ * runs in a copy of the server process, the server must not have any running threads when a job is started.
+ */
+void ModuleManager::initServer() {
+    Configuration& global_config = conf_manager_->getGlobalConfiguration();
+    if(!global_config.get<bool>("seed_per_event", false)) {
+        throw InvalidValueError(global_config,
+                                "seed_per_event",
+                                "modules have to be seeded for every event to reproduce the events of a job");
+    }
+
+    server_modules_ = 0;
+    size_t index = 0;
+    for(auto& module : modules_) {
+        ++index;
+        if(module->get_configuration().get<bool>("server_init", false)) {
+            server_modules_ = index;
+        }
+    }
+
+    auto last_module = std::next(modules_.begin(), static_cast<std::ptrdiff_t>(server_modules_));
+    LOG_PROGRESS(STATUS, "INIT_LOOP") << "Initializing " << server_modules_ << " module instantiations shared by all jobs";
+    create_ROOT_directories(modules_.begin(), last_module);
+    for(auto iter = modules_.begin(); iter != last_module; ++iter) {
+        init_modules(iter, std::next(iter));
+
+        // Threads started during the initialization do not exist anymore in the copies of the server running the jobs
+#ifdef R__USE_IMT
+        if(ROOT::IsImplicitMTEnabled()) {
+            throw InvalidValueError((*iter)->get_configuration(),
+                                    "server_init",
+                                    "module enables the implicit multithreading of ROOT, whose threads are not available "
+                                    "in the jobs forked from the server");
+        }
+#endif
+    }
+    LOG_PROGRESS(STATUS, "INIT_LOOP") << "Initialized " << server_modules_ << " module instantiations shared by all jobs";
+}
+
+/**
+ * The main ROOT file of the server is left untouched by the job and replaced by a new file in the output directory of the
+ * job, in which the ROOT directories of the shared instantiations are created again. The output paths of all instantiations
+ * are moved to the output directory of the job and their seeds are derived from the seed of the job. Parameters of the
+ * instantiations initialized by the job can be changed, except for the message names which determine the message routing.
+ */
+void ModuleManager::startJob(uint64_t seed, const std::vector<Configuration>& module_configs) {
+    auto last_module = std::next(modules_.begin(), static_cast<std::ptrdiff_t>(server_modules_));
+
+    // Apply the parameters of the job to all instantiations of the configured modules
+    for(auto& module_config : module_configs) {
+        bool found = false;
+        for(auto iter = modules_.begin(); iter != modules_.end(); ++iter) {
+            auto& config = (*iter)->get_configuration();
+            if(config.getName() != module_config.getName()) {
+                continue;
+            }
+            found = true;
+
+            for(auto& key_value : module_config.getAll()) {
+                if(std::distance(modules_.begin(), iter) < static_cast<std::ptrdiff_t>(server_modules_)) {
+                    throw InvalidValueError(
+                        module_config, key_value.first, "module is initialized once by the server for all jobs");
+                }
+                if(key_value.first == "input" || key_value.first == "output") {
+                    throw InvalidValueError(module_config, key_value.first, "message names cannot be changed by a job");
+                }
+                config.setText(key_value.first, key_value.second);
+            }
+        }
+        if(!found) {
+            throw ModuleError("Job configures module " + module_config.getName() + " which is not part of the server");
+        }
+    }
+
+    // The file of the server must not be written by the job, it is intentionally not closed
+    static_cast<void>(modules_file_.release());
+    create_main_file();
+    create_ROOT_directories(modules_.begin(), last_module);
+
+    // Place the checkpoint of the job next to its main ROOT file
+    auto& global_config = conf_manager_->getGlobalConfiguration();
+    checkpoint_path_ = std::string(gSystem->pwd()) + "/" + global_config.get<std::string>("checkpoint_file", "checkpoint");
+    checkpoint_path_ = allpix::add_file_extension(checkpoint_path_, "root");
+
+    // Move the output of all instantiations to the output directory of the job
+    std::string global_dir = gSystem->pwd();
     for(auto& module : modules_) {
-        LOG_PROGRESS(TRACE, "INIT_LOOP") << "Initializing " << module->get_identifier().getUniqueName();
+        auto& config = module->get_configuration();
+        auto server_dir = config.get<std::string>("_global_dir");
+        auto output_dir = config.get<std::string>("_output_dir");
+        config.set<std::string>("_global_dir", global_dir);
+        config.set<std::string>("_output_dir", global_dir + output_dir.substr(server_dir.size()));
+    }
+
+    // Derive the seeds of all instantiations from the seed of the job
+    std::mt19937_64 seeder(seed);
+    gRandom->SetSeed(seeder());
+    for(auto& module : modules_) {
+        auto module_seed = seeder();
+        module->get_configuration().set<uint64_t>("_seed", module_seed);
+        module->event_seed_key_ = module_seed;
+    }
+    LOG(STATUS) << "Started job with seed " << seed << " in " << global_dir;
+}
+
+void ModuleManager::create_ROOT_directories(ModuleList::iterator first, ModuleList::iterator last) {
+    for(auto iter = first; iter != last; ++iter) {
+        auto& module = *iter;
 
         // Pass the config manager to this instance
         module->set_config_manager(conf_manager_);
 
         // Create main ROOT directory for this module class if it does not exists yet
-        LOG(TRACE) << "Creating and accessing ROOT directory";
+        LOG(TRACE) << "Creating ROOT directory for " << module->get_identifier().getUniqueName();
         std::string module_name = module->get_configuration().getName();
         auto* directory = modules_file_->GetDirectory(module_name.c_str());
         if(directory == nullptr) {
@@ -525,7 +805,6 @@ void ModuleManager::init() {
                 throw RuntimeError("Cannot create or access overall ROOT directory for module " + module_name);
             }
         }
-        directory->cd();
 
         // Create local directory for this instance
         TDirectory* local_directory = nullptr;
@@ -538,60 +817,89 @@ void ModuleManager::init() {
             }
         }
 
-        // Change to the directory and save it in the module
-        local_directory->cd();
+        // Save the directory in the module
         module->set_ROOT_directory(local_directory);
+    }
+}
 
-        // Get current time
-        auto start = std::chrono::steady_clock::now();
-        // Set init module section header
-        std::string old_section_name = Log::getSection();
-        std::string section_name = "I:";
-        section_name += module->get_identifier().getUniqueName();
-        Log::setSection(section_name);
-        // Set module specific settings
-        auto old_settings = set_module_before(module->get_identifier().getUniqueName(), module->get_configuration());
-        // Change to our ROOT directory
-        module->getROOTDirectory()->cd();
-        // Init module
-        module->init();
-        // Reset delegates
-        LOG(TRACE) << "Resetting messages";
-        module->reset_delegates();
-        // Reset logging
-        Log::setSection(old_section_name);
-        set_module_after(old_settings);
-        // Update execution time
-        auto end = std::chrono::steady_clock::now();
-        module_execution_time_[module.get()] += static_cast<std::chrono::duration<long double>>(end - start).count();
+void ModuleManager::init_modules(ModuleList::iterator first, ModuleList::iterator last) {
+    // Create a thread pool to initialize modules in parallel
+    auto init_function = [log_level = Log::getReportingLevel(), log_format = Log::getFormat()]() {
+        // Initialize the threads to the same log level and format as the master setting
+        Log::setReportingLevel(log_level);
+        Log::setFormat(log_format);
+    };
+    auto threads_num = get_worker_count();
+    LOG(DEBUG) << "Initializing modules with " << threads_num << " additional thread(s)";
+    ThreadPool thread_pool(threads_num, std::vector<Module*>(), init_function);
+
+    std::string module_name;
+    if(first != last) {
+        module_name = (*first)->get_identifier().getName();
     }
-    LOG_PROGRESS(STATUS, "INIT_LOOP") << "Initialized " << modules_.size() << " module instantiations";
-    auto end_time = std::chrono::steady_clock::now();
-    total_time_ += static_cast<std::chrono::duration<long double>>(end_time - start_time).count();
+    for(auto iter = first; iter != last; ++iter) {
+        auto& module = *iter;
+
+        // Finish the initialization of all instantiations of the previous module before switching to a new module type
+        if(module->get_identifier().getName() != module_name) {
+            module_name = module->get_identifier().getName();
+            thread_pool.execute_all();
+        }
+
+        auto init_module = [module = module.get(), this]() {
+            LOG_PROGRESS(TRACE, "INIT_LOOP") << "Initializing " << module->get_identifier().getUniqueName();
+
+            // Get current time
+            auto start = std::chrono::steady_clock::now();
+            // Set init module section header
+            std::string old_section_name = Log::getSection();
+            std::string section_name = "I:";
+            section_name += module->get_identifier().getUniqueName();
+            Log::setSection(section_name);
+            // Set module specific settings
+            auto old_settings = set_module_before(module->get_identifier().getUniqueName(), module->get_configuration());
+            // Change to our ROOT directory (the current directory is local to every thread)
+            module->getROOTDirectory()->cd();
+            // Init module
+            module->init();
+            // Reset delegates
+            LOG(TRACE) << "Resetting messages";
+            module->reset_delegates();
+            // Reset logging
+            Log::setSection(old_section_name);
+            set_module_after(old_settings);
+            // Update execution time
+            auto end = std::chrono::steady_clock::now();
+            module_execution_time_[module] += static_cast<std::chrono::duration<long double>>(end - start).count();
+        };
+
+        if(module->canParallelize()) {
+            // Submit the initialization of the module
+            thread_pool.submit_module_function(init_module);
+        } else {
+            // Finish all parallel initializations and initialize the current module on the main thread
+            thread_pool.execute_all();
+            init_module();
+        }
+    }
+
+    // Finish initializing the last remaining modules
+    thread_pool.execute_all();
 }
 
 /**
  * Initializes the thread pool for executing multiple modules and module tasks in parallel. The run for a module is skipped
- * if its delegates are not \ref Module::check_delegates() "satisfied". Sets the section header and logging settings before
- * executing the \ref Module::run() function. \ref Module::reset_delegates() "Resets" the delegates and the logging after
- * initialization
+ * if its delegates are not \ref Module::check_delegates() "satisfied", or if a previous module rejected the event by throwing
+ * a \ref SkipEventException. Sets the section header and logging settings before executing the \ref Module::run() function.
+ * \ref Module::reset_delegates() "Resets" the delegates and the logging after initialization
  */
 void ModuleManager::run() {
     Configuration& global_config = conf_manager_->getGlobalConfiguration();
 
-    global_config.setDefault("experimental_multithreading", false);
-
     // Default to no additional thread without multithreading
-    unsigned int threads_num = 0;
-
+    unsigned int threads_num = get_worker_count();
     if(global_config.get<bool>("experimental_multithreading")) {
-        // Try to fetch a suitable number of workers if multithreading is enabled
-        threads_num = global_config.get<unsigned int>("workers", std::max(std::thread::hardware_concurrency(), 1u));
-        if(threads_num == 0) {
-            throw InvalidValueError(global_config, "workers", "number of workers should be strictly more than zero");
-        }
-        LOG(WARNING) << "Experimental multithreading enabled - using " << threads_num << " worker threads.";
-        --threads_num;
+        LOG(WARNING) << "Experimental multithreading enabled - using " << (threads_num + 1) << " worker threads.";
     }
 
     // Creates the thread pool
@@ -614,33 +922,68 @@ void ModuleManager::run() {
     auto start_time = std::chrono::steady_clock::now();
     global_config.setDefault<unsigned int>("number_of_events", 1u);
     auto number_of_events = global_config.get<unsigned int>("number_of_events");
-    for(unsigned int i = 0; i < number_of_events; ++i) {
+    auto first_event = global_config.get<unsigned int>("first_event", 1u);
+    auto last_event = global_config.get<unsigned int>("last_event", first_event + number_of_events - 1);
+
+    // Skip all events finished before the checkpoint of a resumed run
+    unsigned int first_index = 0;
+    if(resume_event_ > 0) {
+        if(resume_event_ < first_event || resume_event_ > last_event) {
+            throw RuntimeError("Checkpoint after event " + std::to_string(resume_event_) +
+                               " is outside of the event range " + std::to_string(first_event) + " to " +
+                               std::to_string(last_event));
+        }
+        first_index = resume_event_ - first_event + 1;
+        LOG(STATUS) << "Continuing run with event " << (resume_event_ + 1);
+    }
+
+    run_completed_ = true;
+    for(unsigned int i = first_index; i < number_of_events; ++i) {
         // Check for termination
         if(terminate_) {
             LOG(INFO) << "Interrupting event loop after " << i << " events because of request to terminate";
             number_of_events = i;
             global_config.set<unsigned int>("number_of_events", i);
+            global_config.set<unsigned int>("last_event", first_event + i - 1);
+            run_completed_ = false;
             break;
         }
 
-        LOG_PROGRESS(STATUS, "EVENT_LOOP") << "Running event " << (i + 1) << " of " << number_of_events;
+        LOG_PROGRESS(STATUS, "EVENT_LOOP") << "Running event " << (first_event + i) << " of " << last_event;
 
         // Get object count for linking objects in current event
         auto save_id = TProcessID::GetObjectCount();
 
+        // Set if a module rejects the event, all following modules are skipped
+        std::atomic<bool> skip_event{false};
+
+        // Replay the messages of the cached stage if this event has been processed with identical settings before
+        bool stage_replayed = !cached_modules_.empty() && read_stage_cache(first_event + i);
+
         std::string module_name;
         if(!modules_.empty()) {
             module_name = modules_.front()->get_identifier().getName();
         }
         for(auto& module : modules_) {
+            // Modules of a replayed stage are not executed
+            if(stage_replayed &&
+               std::find(cached_modules_.begin(), cached_modules_.end(), module.get()) != cached_modules_.end()) {
+                continue;
+            }
+
             // Execute all remaining jobs in the thread pool when switching to a new module type
             if(module->get_identifier().getName() != module_name) {
                 module_name = module->get_identifier().getName();
                 thread_pool->execute_all();
             }
 
-            auto execute_module = [module = module.get(), event_num = i + 1, this, number_of_events]() {
-                LOG_PROGRESS(TRACE, "EVENT_LOOP") << "Running event " << event_num << " of " << number_of_events << " ["
+            auto execute_module = [module = module.get(), event_num = first_event + i, this, last_event, &skip_event]() {
+                // Skip all remaining modules if the event has been rejected
+                if(skip_event) {
+                    return;
+                }
+
+                LOG_PROGRESS(TRACE, "EVENT_LOOP") << "Running event " << event_num << " of " << last_event << " ["
                                                   << module->get_identifier().getUniqueName() << "]";
                 // Check if module is satisfied to run
                 if(!module->check_delegates()) {
@@ -670,6 +1013,10 @@ void ModuleManager::run() {
                     // Terminate if the module threw the EndOfRun request exception:
                     LOG(WARNING) << "Request to terminate:" << std::endl << e.what();
                     terminate_ = true;
+                } catch(SkipEventException& e) {
+                    // Skip the rest of the event if the module rejected it
+                    LOG(DEBUG) << "Skipping rest of event " << event_num << ":" << std::endl << e.what();
+                    skip_event = true;
                 }
                 // Reset logging
                 Log::setSection(old_section_name);
@@ -692,6 +1039,14 @@ void ModuleManager::run() {
 
         // Finish executing the last remaining tasks
         thread_pool->execute_all();
+        if(skip_event) {
+            ++skipped_events_;
+        }
+
+        // Store the messages of the cached stage for later runs, unless the event is incomplete
+        if(!cached_modules_.empty() && !stage_replayed && !skip_event && !terminate_) {
+            write_stage_cache(first_event + i);
+        }
 
         // Resetting delegates
         for(auto& module : modules_) {
@@ -699,10 +1054,27 @@ void ModuleManager::run() {
             module->reset_delegates();
         }
 
-        // Reset object count for next event
+        // Release the objects of the replayed stage and reset object count for next event
+        stage_cache_file_.reset();
         TProcessID::SetObjectCount(save_id);
+
+        // Write a checkpoint in regular intervals and when the run is interrupted
+        if(checkpoint_interval_ > 0 && ((i + 1) % checkpoint_interval_ == 0 || terminate_)) {
+            write_checkpoint(first_event + i);
+        }
+    }
+    // A request to terminate during the last event leaves the run incomplete as well, the checkpoint has to be kept
+    if(terminate_) {
+        run_completed_ = false;
     }
     LOG_PROGRESS(STATUS, "EVENT_LOOP") << "Finished run of " << number_of_events << " events";
+    if(skipped_events_ > 0) {
+        LOG(STATUS) << "Skipped " << skipped_events_ << " events rejected by modules";
+    }
+    if(!cached_modules_.empty()) {
+        LOG(STATUS) << "Replayed " << replayed_events_ << " events from the cache of the first " << cached_modules_.size()
+                    << " module instantiations";
+    }
     auto end_time = std::chrono::steady_clock::now();
     total_time_ += static_cast<std::chrono::duration<long double>>(end_time - start_time).count();
 
@@ -773,6 +1145,12 @@ void ModuleManager::finalize() {
     }
     // Close module ROOT file
     modules_file_->Close();
+
+    // The checkpoint is not needed anymore after all events have been processed
+    if(run_completed_ && allpix::path_is_file(checkpoint_path_)) {
+        LOG(DEBUG) << "Removing checkpoint " << checkpoint_path_ << " of completed run";
+        allpix::remove_file(checkpoint_path_);
+    }
     LOG_PROGRESS(STATUS, "FINALIZE_LOOP") << "Finalization completed";
     auto end_time = std::chrono::steady_clock::now();
     total_time_ += static_cast<std::chrono::duration<long double>>(end_time - start_time).count();
@@ -803,6 +1181,310 @@ void ModuleManager::finalize() {
                 << std::round(global_config.get<double>("number_of_events") / total_time_) << " Hz\x1B[0m";
 }
 
+/**
+ * The checkpoint contains the last finished event, the seeds of the run and a directory for every module instantiation. The
+ * directories hold the state written by \ref Module::saveState() and a copy of all histograms in the ROOT directory of the
+ * module. The checkpoint is first written to a temporary file which then replaces the previous checkpoint, such that a
+ * valid checkpoint exists even if the program is killed while writing it.
+ */
+void ModuleManager::write_checkpoint(unsigned int event_num) {
+    Configuration& global_config = conf_manager_->getGlobalConfiguration();
+    LOG(DEBUG) << "Writing checkpoint after event " << event_num;
+
+    // Restore the current directory after writing
+    TDirectory::TContext context;
+    auto temporary_path = checkpoint_path_ + ".tmp";
+    TFile checkpoint(temporary_path.c_str(), "RECREATE");
+    if(checkpoint.IsZombie()) {
+        throw RuntimeError("Cannot create checkpoint " + temporary_path);
+    }
+
+    auto event = std::to_string(event_num);
+    checkpoint.WriteObject(&event, "event");
+    for(const auto& key : {"random_seed", "random_seed_core"}) {
+        auto seed = global_config.get<std::string>(key);
+        checkpoint.WriteObject(&seed, key);
+    }
+
+    for(auto& module : modules_) {
+        auto* directory = checkpoint.mkdir(module->getUniqueName().c_str());
+        if(directory == nullptr) {
+            throw RuntimeError("Cannot create checkpoint directory for module " + module->getUniqueName());
+        }
+
+        std::ostringstream stream;
+        module->saveState(stream);
+        auto state = stream.str();
+        directory->WriteObject(&state, "state");
+
+        for(auto* object : *module->getROOTDirectory()->GetList()) {
+            if(object->InheritsFrom(TH1::Class())) {
+                directory->WriteTObject(object);
+            }
+        }
+    }
+    checkpoint.Close();
+
+    if(std::rename(temporary_path.c_str(), checkpoint_path_.c_str()) != 0) {
+        throw RuntimeError("Cannot replace checkpoint " + checkpoint_path_);
+    }
+}
+
+/**
+ * Histograms of the module are filled with the contents stored in the checkpoint. The module is expected to have booked
+ * all its histograms during initialization.
+ */
+unsigned int ModuleManager::read_checkpoint() {
+    TDirectory::TContext context;
+    TFile checkpoint(checkpoint_path_.c_str(), "READ");
+    if(checkpoint.IsZombie()) {
+        throw RuntimeError("Cannot read checkpoint " + checkpoint_path_);
+    }
+
+    std::string* event = nullptr;
+    checkpoint.GetObject("event", event);
+    if(event == nullptr) {
+        throw RuntimeError("Checkpoint " + checkpoint_path_ + " does not contain the last finished event");
+    }
+    auto event_num = allpix::from_string<unsigned int>(*event);
+    delete event;
+
+    for(auto& module : modules_) {
+        auto* directory = checkpoint.GetDirectory(module->getUniqueName().c_str());
+        std::string* state = nullptr;
+        if(directory != nullptr) {
+            directory->GetObject("state", state);
+        }
+        if(state == nullptr) {
+            throw RuntimeError("Checkpoint " + checkpoint_path_ + " does not contain the state of module " +
+                               module->getUniqueName());
+        }
+
+        std::istringstream stream(*state);
+        delete state;
+        module->loadState(stream);
+        if(stream.fail()) {
+            throw RuntimeError("Cannot restore state of module " + module->getUniqueName() + " from checkpoint");
+        }
+
+        for(auto* object : *directory->GetListOfKeys()) {
+            auto* key = static_cast<TKey*>(object);
+            auto* histogram = dynamic_cast<TH1*>(module->getROOTDirectory()->GetList()->FindObject(key->GetName()));
+            if(histogram == nullptr) {
+                continue;
+            }
+            std::unique_ptr<TH1> stored(dynamic_cast<TH1*>(key->ReadObj()));
+            if(stored != nullptr) {
+                histogram->Add(stored.get());
+            }
+        }
+    }
+
+    return event_num;
+}
+
+/**
+ * The cached stage consists of all module instantiations up to the last one with the cache_stage parameter enabled. Its
+ * description contains the framework version, the geometry and the configuration of all these instantiations including their
+ * seeds, such that any change upstream of the end of the stage results in a different hash. Settings which only affect the
+ * logging or the location of the output are not part of the description.
+ */
+void ModuleManager::init_stage_cache() {
+    auto stage_end = modules_.begin();
+    for(auto iter = modules_.begin(); iter != modules_.end(); ++iter) {
+        if((*iter)->get_configuration().get<bool>("cache_stage", false)) {
+            stage_end = std::next(iter);
+        }
+    }
+    if(stage_end == modules_.begin()) {
+        return;
+    }
+
+    // Events can only be replayed independently of each other if the modules are seeded for every event
+    Configuration& global_config = conf_manager_->getGlobalConfiguration();
+    if(!global_config.get<bool>("seed_per_event", false)) {
+        throw InvalidValueError(global_config,
+                                "seed_per_event",
+                                "modules have to be seeded for every event to cache the messages of individual events");
+    }
+
+    stage_cache_directory_ =
+        std::string(gSystem->pwd()) + "/" + global_config.get<std::string>("stage_cache_directory", "stage_cache");
+    try {
+        allpix::create_directories(stage_cache_directory_);
+    } catch(std::invalid_argument& e) {
+        throw InvalidValueError(global_config, "stage_cache_directory", e.what());
+    }
+
+    std::stringstream description;
+    description << std::setprecision(17) << global_config.get<std::string>("version", "") << "\n";
+    auto geometry_hash = geo_manager_->getExternalObject<std::string>("", "geometry_hash");
+    if(geometry_hash != nullptr) {
+        description << *geometry_hash << "\n";
+    }
+    for(auto& detector : geo_manager_->getDetectors()) {
+        description << detector->getName() << " " << detector->getType() << " " << detector->getPosition() << " "
+                    << detector->getOrientation() << "\n";
+        // The geometry hash is only available with Geant4, the model parameters are included for all setups
+        for(auto& model_config : detector->getModel()->getConfigurations()) {
+            description << "[" << model_config.getName() << "]\n";
+            for(auto& key_value : model_config.getAll()) {
+                description << key_value.first << " = " << key_value.second << "\n";
+            }
+        }
+    }
+
+    // Internal keys are not listed in the configuration, the seed of the instantiation is added explicitly
+    const std::set<std::string> ignored_keys = {"log_level", "log_format", "cache_stage"};
+    for(auto iter = modules_.begin(); iter != stage_end; ++iter) {
+        cached_modules_.push_back(iter->get());
+        description << (*iter)->getUniqueName() << "\n";
+        description << "_seed = " << (*iter)->get_configuration().get<std::string>("_seed") << "\n";
+        for(auto& key_value : (*iter)->get_configuration().getAll()) {
+            if(ignored_keys.find(key_value.first) == ignored_keys.end()) {
+                description << key_value.first << " = " << key_value.second << "\n";
+            }
+        }
+    }
+    stage_description_ = description.str();
+
+    LOG(STATUS) << "Caching the messages of the first " << cached_modules_.size() << " module instantiations up to "
+                << cached_modules_.back()->getUniqueName() << " in " << stage_cache_directory_;
+}
+
+std::string ModuleManager::get_stage_cache_path(unsigned int event_num) const {
+    auto hash = allpix::hash_string(stage_description_ + "event = " + std::to_string(event_num));
+    return stage_cache_directory_ + "/stage_" + hash + ".root";
+}
+
+/**
+ * For every message dispatched by the modules of the stage, the objects are stored together with the dispatching module, the
+ * type, the detector and the name of the message. The file is first written under a temporary name, such that an
+ * interrupted write never leaves an incomplete cache entry behind. Messages which do not contain objects cannot be stored,
+ * in that case the event is not cached.
+ */
+void ModuleManager::write_stage_cache(unsigned int event_num) {
+    auto path = get_stage_cache_path(event_num);
+    auto temporary_path = path + ".tmp";
+    LOG(DEBUG) << "Storing messages of the cached stage in event " << event_num << " in " << path;
+
+    // Restore the current directory after writing
+    TDirectory::TContext context;
+    TFile cache(temporary_path.c_str(), "RECREATE");
+    if(cache.IsZombie()) {
+        LOG(WARNING) << "Cannot create stage cache file " << temporary_path << ", event " << event_num << " is not cached";
+        return;
+    }
+
+    const auto& message_types = get_stage_message_types();
+    std::vector<std::string> sources;
+    std::vector<std::string> types;
+    std::vector<std::string> detectors;
+    std::vector<std::string> names;
+    for(auto* module : cached_modules_) {
+        for(auto& message : messenger_->getDispatchedMessages(module)) {
+            const BaseMessage* inst = message.first.get();
+            auto type = message_types.names.find(typeid(*inst));
+            if(type == message_types.names.end()) {
+                LOG_ONCE(WARNING) << "Message " << allpix::demangle(typeid(*inst).name()) << " dispatched by "
+                                  << module->getUniqueName() << " cannot be stored, events are not cached";
+                cache.Close();
+                allpix::remove_file(temporary_path);
+                return;
+            }
+
+            std::vector<Object*> objects;
+            for(auto& object : message.first->getObjectArray()) {
+                objects.push_back(&object.get());
+            }
+            cache.WriteObject(&objects, ("objects_" + std::to_string(sources.size())).c_str());
+
+            sources.push_back(module->getUniqueName());
+            types.push_back(type->second);
+            detectors.push_back(message.first->getDetector() == nullptr ? "" : message.first->getDetector()->getName());
+            names.push_back(message.second);
+        }
+    }
+    cache.WriteObject(&sources, "sources");
+    cache.WriteObject(&types, "types");
+    cache.WriteObject(&detectors, "detectors");
+    cache.WriteObject(&names, "names");
+    cache.Close();
+
+    if(std::rename(temporary_path.c_str(), path.c_str()) != 0) {
+        LOG(WARNING) << "Cannot create stage cache file " << path << ", event " << event_num << " is not cached";
+    }
+}
+
+/**
+ * All messages are recreated before any of them is dispatched, such that the references between the objects of different
+ * messages are resolved to the new objects. The cache file is kept open until the end of the event, as closing it would
+ * clear the table resolving these references.
+ */
+bool ModuleManager::read_stage_cache(unsigned int event_num) {
+    auto path = get_stage_cache_path(event_num);
+    if(!allpix::path_is_file(path)) {
+        LOG(DEBUG) << "Event " << event_num << " is not available in the stage cache, running all modules";
+        return false;
+    }
+
+    // Restore the current directory after reading
+    TDirectory::TContext context;
+    stage_cache_file_ = std::make_unique<TFile>(path.c_str(), "READ");
+    std::vector<std::string>* sources = nullptr;
+    std::vector<std::string>* types = nullptr;
+    std::vector<std::string>* detectors = nullptr;
+    std::vector<std::string>* names = nullptr;
+    if(!stage_cache_file_->IsZombie()) {
+        stage_cache_file_->GetObject("sources", sources);
+        stage_cache_file_->GetObject("types", types);
+        stage_cache_file_->GetObject("detectors", detectors);
+        stage_cache_file_->GetObject("names", names);
+    }
+    if(sources == nullptr || types == nullptr || detectors == nullptr || names == nullptr) {
+        LOG(WARNING) << "Stage cache file " << path << " cannot be read, running all modules";
+        stage_cache_file_.reset();
+        return false;
+    }
+
+    const auto& message_types = get_stage_message_types();
+    std::vector<std::tuple<Module*, std::shared_ptr<BaseMessage>, std::string>> messages;
+    for(size_t i = 0; i < sources->size(); ++i) {
+        auto module = std::find_if(cached_modules_.begin(), cached_modules_.end(), [&](Module* cached_module) {
+            return cached_module->getUniqueName() == sources->at(i);
+        });
+        std::vector<Object*>* objects = nullptr;
+        stage_cache_file_->GetObject(("objects_" + std::to_string(i)).c_str(), objects);
+        auto creator = message_types.creators.find(types->at(i));
+        if(module == cached_modules_.end() || objects == nullptr || creator == message_types.creators.end()) {
+            throw RuntimeError("Stage cache file " + path + " is corrupted");
+        }
+
+        std::shared_ptr<const Detector> detector;
+        if(!detectors->at(i).empty()) {
+            detector = geo_manager_->getDetector(detectors->at(i));
+        }
+        messages.emplace_back(*module, creator->second(*objects, detector), names->at(i));
+
+        for(auto* object : *objects) {
+            delete object;
+        }
+        delete objects;
+    }
+
+    LOG(DEBUG) << "Replaying " << messages.size() << " messages of the cached stage in event " << event_num;
+    for(auto& message : messages) {
+        messenger_->dispatchMessage(std::get<0>(message), std::get<1>(message), std::get<2>(message));
+    }
+    delete sources;
+    delete types;
+    delete detectors;
+    delete names;
+
+    ++replayed_events_;
+    return true;
+}
+
 /**
  * All modules in the event loop continue to finish the current event
  */
@@ -16,6 +16,8 @@
 #include <memory>
 #include <queue>
 #include <random>
+#include <string>
+#include <vector>
 
 #include <TDirectory.h>
 #include <TFile.h>
@@ -81,9 +83,32 @@ namespace allpix {
         /**
          * @brief Initialize all modules before the event sequence
          * @warning Should be called after the \ref ModuleManager::load "load function"
+         *
+         * Instantiations of the same module which can be parallelized are initialized concurrently if multithreading is
+         * enabled. Compiles the message routing table of the messenger after all modules are initialized.
          */
         void init();
 
+        /**
+         * @brief Initialize the modules shared by all jobs of a server
+         * @warning Should be called after the \ref ModuleManager::load "load function" and before any job is started
+         *
+         * All module instantiations up to the last one with the server_init parameter enabled are initialized once in the
+         * server process. The remaining instantiations are initialized by the \ref ModuleManager::init "init function" in
+         * the process of every job.
+         */
+        void initServer();
+
+        /**
+         * @brief Prepare the process of a server job for its run
+         * @param seed Random seed of the job, from which the seeds of all module instantiations are derived
+         * @param module_configs Sections of the job configuration with parameters of the modules
+         * @warning Should be called in the process of the job after changing to its output directory, followed by the
+         *          \ref ModuleManager::init "init", \ref ModuleManager::run "run" and \ref ModuleManager::finalize
+         *          "finalize" functions
+         */
+        void startJob(uint64_t seed, const std::vector<Configuration>& module_configs);
+
         /**
          * @brief Run all modules for the number of events
          * @warning Should be called after the \ref ModuleManager::init "init function"
@@ -127,6 +152,34 @@ namespace allpix {
         std::vector<std::pair<ModuleIdentifier, Module*>>
         create_detector_modules(void*, Configuration&, Messenger*, GeometryManager*, std::mt19937_64& seeder);
 
+        using ModuleList = std::list<std::unique_ptr<Module>>;
+        using IdentifierToModuleMap = std::map<ModuleIdentifier, ModuleList::iterator>;
+
+        /**
+         * @brief Create the main ROOT file in the current directory
+         */
+        void create_main_file();
+
+        /**
+         * @brief Create the ROOT directories of a range of module instantiations in the main ROOT file
+         * @param first First instantiation of the range
+         * @param last Instantiation after the last one of the range
+         */
+        void create_ROOT_directories(ModuleList::iterator first, ModuleList::iterator last);
+
+        /**
+         * @brief Initialize a range of module instantiations
+         * @param first First instantiation of the range
+         * @param last Instantiation after the last one of the range
+         */
+        void init_modules(ModuleList::iterator first, ModuleList::iterator last);
+
+        /**
+         * @brief Get the number of additional worker threads to use for executing modules in parallel
+         * @return Number of worker threads besides the main thread
+         */
+        unsigned int get_worker_count();
+
         /**
          * @brief Set module specific log setting before running init/run/finalize
          */
@@ -136,13 +189,45 @@ namespace allpix {
          */
         void set_module_after(std::tuple<LogLevel, LogFormat> prev);
 
-        using ModuleList = std::list<std::unique_ptr<Module>>;
-        using IdentifierToModuleMap = std::map<ModuleIdentifier, ModuleList::iterator>;
+        /**
+         * @brief Write the state of all modules after the given event to the checkpoint file
+         * @param event_num Number of the last finished event
+         */
+        void write_checkpoint(unsigned int event_num);
+        /**
+         * @brief Restore the state of all modules from the checkpoint file
+         * @return Number of the last event finished before the checkpoint was written
+         */
+        unsigned int read_checkpoint();
+
+        /**
+         * @brief Determine the module instantiations of the cached stage and describe their settings
+         */
+        void init_stage_cache();
+        /**
+         * @brief Get the path of the stage cache file of an event
+         * @param event_num Number of the event
+         * @return Path of the file, named by the hash of the stage description and the event number
+         */
+        std::string get_stage_cache_path(unsigned int event_num) const;
+        /**
+         * @brief Store the messages dispatched by the cached stage in the current event
+         * @param event_num Number of the current event
+         */
+        void write_stage_cache(unsigned int event_num);
+        /**
+         * @brief Dispatch the messages of the cached stage from the cache if the event has been stored before
+         * @param event_num Number of the current event
+         * @return True if the messages have been replayed and the modules of the stage can be skipped, false otherwise
+         */
+        bool read_stage_cache(unsigned int event_num);
 
         ModuleList modules_;
         IdentifierToModuleMap id_to_module_;
 
         ConfigManager* conf_manager_{};
+        Messenger* messenger_{};
+        GeometryManager* geo_manager_{};
 
         std::unique_ptr<TFile> modules_file_;
 
@@ -152,6 +237,20 @@ namespace allpix {
         std::map<std::string, void*> loaded_libraries_;
 
         std::atomic<bool> terminate_;
+        unsigned int skipped_events_{};
+
+        std::string checkpoint_path_;
+        unsigned int checkpoint_interval_{};
+        unsigned int resume_event_{};
+        bool run_completed_{};
+
+        std::vector<Module*> cached_modules_;
+        std::string stage_cache_directory_;
+        std::string stage_description_;
+        std::unique_ptr<TFile> stage_cache_file_;
+        unsigned int replayed_events_{};
+
+        size_t server_modules_{};
     };
 } // namespace allpix
 
@@ -121,6 +121,23 @@ namespace allpix {
         // TODO [doc] the module itself is missing
         explicit EndOfRunException(std::string reason) { error_message_ = std::move(reason); }
     };
+
+    /**
+     * @ingroup Exceptions
+     * @brief Exception for modules to request skipping the remaining modules for the current event
+     * @note Non-fatal error used to reject an event, the event loop continues with the next event.
+     *
+     * This error can be raised by modules if the current event is not of interest, e.g. because no charge has been
+     * deposited in the detector under study. None of the modules following in the event loop is executed for this event.
+     */
+    class SkipEventException : public RuntimeError {
+    public:
+        /**
+         * @brief Constructs request to skip the current event with a description
+         * @param reason Text explaining the reason of the rejection of the event
+         */
+        explicit SkipEventException(std::string reason) { error_message_ = std::move(reason); }
+    };
 } // namespace allpix
 
 #endif /* ALLPIX_MODULE_EXCEPTIONS_H */
@@ -0,0 +1,266 @@
+/**
+ * @file
+ * @brief Counter-based random number engine and batched sampling of normal distributions
+ * @copyright Copyright (c) 2017-2020 CERN and the Allpix Squared authors.
+ * This software is distributed under the terms of the MIT License, copied verbatim in the file "LICENSE.md".
+ * In applying this license, CERN does not waive the privileges and immunities granted to it by virtue of its status as an
+ * Intergovernmental Organization or submit itself to any jurisdiction.
+ */
+
+#ifndef ALLPIX_PRNG_H
+#define ALLPIX_PRNG_H
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <limits>
+#include <ostream>
+#include <utility>
+
+namespace allpix {
+    /**
+     * @brief Counter-based random number engine implementing the Philox4x32-10 algorithm
+     *
+     * The engine does not carry any state besides a 128-bit counter and a 64-bit key. Every output block is obtained by
+     * applying ten rounds of a bijection to the counter, keyed with the seed. The upper half of the counter holds a stream
+     * number, such that independent streams can be derived from the same seed without any shared state. The engine fulfills
+     * the requirements of a UniformRandomBitGenerator and can be used with all distributions of the standard library.
+     *
+     * See J. K. Salmon et al., "Parallel random numbers: as easy as 1, 2, 3", SC'11, doi:10.1145/2063384.2063405
+     */
+    class RandomEngine {
+    public:
+        using result_type = uint64_t;
+
+        /**
+         * @brief Construct the engine
+         * @param seed Seed used as key for the engine
+         * @param stream Number of the independent stream to generate
+         */
+        explicit RandomEngine(uint64_t seed = 0, uint64_t stream = 0) { this->seed(seed, stream); }
+
+        /**
+         * @brief Reset the engine to the start of a stream
+         * @param seed Seed used as key for the engine
+         * @param stream Number of the independent stream to generate
+         */
+        void seed(uint64_t seed, uint64_t stream = 0) {
+            key_ = {{static_cast<uint32_t>(seed), static_cast<uint32_t>(seed >> 32u)}};
+            stream_ = stream;
+            counter_ = 0;
+            index_ = 2;
+        }
+
+        /**
+         * @brief Generate the next random number
+         * @return Uniformly distributed 64-bit integer
+         */
+        result_type operator()() {
+            if(index_ == 2) {
+                block_ = generate(counter_++);
+                index_ = 0;
+            }
+            return block_[index_++];
+        }
+
+        /**
+         * @brief Advance the engine without generating numbers
+         * @param count Number of values to skip
+         */
+        void discard(unsigned long long count) {
+            // Position of the next value in the stream
+            uint64_t position = 2 * counter_ - 2 + index_ + count;
+            counter_ = position / 2;
+            index_ = 2;
+            if(position % 2 != 0) {
+                block_ = generate(counter_++);
+                index_ = 1;
+            }
+        }
+
+        /**
+         * @brief Generate the block of random numbers belonging to a given counter value of the current stream
+         * @param counter Value of the counter
+         * @return Two uniformly distributed 64-bit integers
+         */
+        std::array<result_type, 2> generate(uint64_t counter) const {
+            std::array<uint32_t, 4> ctr{{static_cast<uint32_t>(counter),
+                                         static_cast<uint32_t>(counter >> 32u),
+                                         static_cast<uint32_t>(stream_),
+                                         static_cast<uint32_t>(stream_ >> 32u)}};
+            std::array<uint32_t, 2> key = key_;
+            for(unsigned int round = 0; round < 10; ++round) {
+                uint64_t product0 = static_cast<uint64_t>(0xD2511F53u) * ctr[0];
+                uint64_t product1 = static_cast<uint64_t>(0xCD9E8D57u) * ctr[2];
+                ctr = {{static_cast<uint32_t>(product1 >> 32u) ^ ctr[1] ^ key[0],
+                        static_cast<uint32_t>(product1),
+                        static_cast<uint32_t>(product0 >> 32u) ^ ctr[3] ^ key[1],
+                        static_cast<uint32_t>(product0)}};
+                key[0] += 0x9E3779B9u;
+                key[1] += 0xBB67AE85u;
+            }
+            return {{(static_cast<uint64_t>(ctr[1]) << 32u) | ctr[0], (static_cast<uint64_t>(ctr[3]) << 32u) | ctr[2]}};
+        }
+
+        static constexpr result_type min() { return std::numeric_limits<result_type>::min(); }
+        static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+        /**
+         * @brief Write the state of the engine to a stream
+         * @param os Stream to write to
+         * @param engine Engine to store
+         * @return Stream after writing
+         */
+        friend std::ostream& operator<<(std::ostream& os, const RandomEngine& engine) {
+            return os << engine.key_[0] << " " << engine.key_[1] << " " << engine.stream_ << " " << engine.counter_ << " "
+                      << engine.index_;
+        }
+
+        /**
+         * @brief Read the state of the engine from a stream
+         * @param is Stream to read from
+         * @param engine Engine to restore
+         * @return Stream after reading
+         */
+        friend std::istream& operator>>(std::istream& is, RandomEngine& engine) {
+            is >> engine.key_[0] >> engine.key_[1] >> engine.stream_ >> engine.counter_ >> engine.index_;
+            // The current block is regenerated from the counter instead of being stored
+            if(engine.index_ < 2) {
+                engine.block_ = engine.generate(engine.counter_ - 1);
+            }
+            return is;
+        }
+
+    private:
+        std::array<uint32_t, 2> key_{};
+        uint64_t stream_{};
+        uint64_t counter_{};
+        std::array<result_type, 2> block_{};
+        unsigned int index_{2};
+    };
+
+    /**
+     * @brief Fill a range with samples from the standard normal distribution
+     * @param engine Random engine providing 64-bit uniform integers
+     * @param first Pointer to the first element to fill
+     * @param count Number of elements to fill
+     *
+     * Uses the Box-Muller transform on batches of uniform numbers. The uniform numbers are generated first, such that the
+     * transformation loop itself does not contain any branches and can be vectorized by the compiler.
+     */
+    template <typename Engine> void fill_normal(Engine& engine, double* first, size_t count) {
+        constexpr double two_pi = 6.283185307179586476925;
+        constexpr double scale = 1.0 / 9007199254740992.0; // 2^-53
+
+        // Convert to doubles in the interval (0,1] to avoid the logarithm of zero
+        for(size_t i = 0; i < count; ++i) {
+            first[i] = static_cast<double>((engine() >> 11u) + 1) * scale;
+        }
+
+        for(size_t i = 0; i + 1 < count; i += 2) {
+            double radius = std::sqrt(-2. * std::log(first[i]));
+            double angle = two_pi * first[i + 1];
+            first[i] = radius * std::cos(angle);
+            first[i + 1] = radius * std::sin(angle);
+        }
+
+        // Odd counts need one additional pair of which only the first value is used
+        if(count % 2 != 0) {
+            double u1 = static_cast<double>((engine() >> 11u) + 1) * scale;
+            first[count - 1] = std::sqrt(-2. * std::log(u1)) * std::cos(two_pi * first[count - 1]);
+        }
+    }
+
+    /**
+     * @brief Source of normally distributed random numbers generated in batches
+     * @tparam Engine Random engine providing 64-bit uniform integers
+     * @tparam N Number of samples generated per batch
+     *
+     * Samples are drawn from an internal buffer of standard normal numbers which is refilled with \ref fill_normal once it
+     * is exhausted. Other than std::normal_distribution, the mean and standard deviation can change from call to call
+     * without constructing a new object.
+     */
+    template <typename Engine = RandomEngine, size_t N = 256> class NormalSampler {
+    public:
+        /**
+         * @brief Construct the sampler
+         * @param engine Random engine to draw uniform numbers from
+         */
+        explicit NormalSampler(Engine engine = Engine()) : engine_(std::move(engine)), fill_engine_(engine_) {}
+
+        /**
+         * @brief Reset the sampler with a new engine, discarding all buffered samples
+         * @param engine Random engine to draw uniform numbers from
+         */
+        void reset(Engine engine) {
+            engine_ = std::move(engine);
+            fill_engine_ = engine_;
+            index_ = N;
+        }
+
+        /**
+         * @brief Reset the sampler with a newly seeded engine, discarding all buffered samples
+         * @param seed Seed for the random engine
+         */
+        void seed(uint64_t seed) { reset(Engine(seed)); }
+
+        /**
+         * @brief Draw a sample from the standard normal distribution
+         * @return Normally distributed number with zero mean and unit standard deviation
+         */
+        double operator()() {
+            if(index_ == N) {
+                fill_engine_ = engine_;
+                fill_normal(engine_, buffer_.data(), N);
+                index_ = 0;
+            }
+            return buffer_[index_++];
+        }
+
+        /**
+         * @brief Draw a sample from a normal distribution
+         * @param mean Mean of the distribution
+         * @param stddev Standard deviation of the distribution
+         * @return Normally distributed number
+         */
+        double operator()(double mean, double stddev) { return mean + stddev * (*this)(); }
+
+        /**
+         * @brief Write the state of the sampler to a stream
+         * @param os Stream to write to
+         * @param sampler Sampler to store
+         * @return Stream after writing
+         *
+         * Only the engine state before filling the current buffer is stored, the buffer itself is regenerated when reading.
+         * An exhausted buffer is not regenerated, the current engine state is stored instead.
+         */
+        friend std::ostream& operator<<(std::ostream& os, const NormalSampler& sampler) {
+            return os << (sampler.index_ < N ? sampler.fill_engine_ : sampler.engine_) << " " << sampler.index_;
+        }
+
+        /**
+         * @brief Read the state of the sampler from a stream
+         * @param is Stream to read from
+         * @param sampler Sampler to restore
+         * @return Stream after reading
+         */
+        friend std::istream& operator>>(std::istream& is, NormalSampler& sampler) {
+            is >> sampler.fill_engine_ >> sampler.index_;
+            sampler.engine_ = sampler.fill_engine_;
+            if(sampler.index_ < N) {
+                fill_normal(sampler.engine_, sampler.buffer_.data(), N);
+            }
+            return is;
+        }
+
+    private:
+        Engine engine_;
+        Engine fill_engine_;
+        std::array<double, N> buffer_{};
+        size_t index_{N};
+    };
+} // namespace allpix
+
+#endif /* ALLPIX_PRNG_H */
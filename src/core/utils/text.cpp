@@ -12,6 +12,9 @@
 
 #include "text.h"
 
+#include <cstdint>
+#include <iomanip>
+
 #include "unit.h"
 
 using namespace allpix;
@@ -79,3 +82,15 @@ bool allpix::from_string_impl(std::string str, type_tag<bool>) {
 
     return ret_value;
 }
+
+std::string allpix::hash_string(const std::string& str) {
+    uint64_t hash = 0xcbf29ce484222325;
+    for(auto character : str) {
+        hash ^= static_cast<unsigned char>(character);
+        hash *= 0x100000001b3;
+    }
+
+    std::ostringstream out;
+    out << std::hex << std::setw(16) << std::setfill('0') << hash;
+    return out.str();
+}
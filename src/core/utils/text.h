@@ -118,6 +118,13 @@ namespace allpix {
      * @return List of all the substrings with all empty substrings ignored (thus removed)
      */
     template <typename T> std::vector<T> split(std::string str, const std::string& delims = " \t,");
+
+    /**
+     * @brief Calculates a hash of a string which is stable between runs and platforms
+     * @param str String to hash
+     * @return Hexadecimal representation of the 64-bit FNV-1a hash of the string
+     */
+    std::string hash_string(const std::string& str);
 } // namespace allpix
 
 // Include template definitions
@@ -20,6 +20,7 @@
 #include "core/config/ConfigManager.hpp"
 #include "core/geometry/GeometryManager.hpp"
 #include "core/utils/exceptions.h"
+#include "core/utils/file.h"
 
 #include "core/utils/log.h"
 
@@ -94,6 +95,8 @@ int main(int argc, const char* argv[]) {
     // Parse arguments
     std::string config_file_name;
     std::string log_file_name;
+    std::string job_directory;
+    bool server_once = false;
     std::vector<std::string> module_options;
     std::vector<std::string> detector_options;
     for(int i = 1; i < argc; i++) {
@@ -125,6 +128,13 @@ int main(int argc, const char* argv[]) {
             module_options.emplace_back(std::string(argv[++i]));
         } else if(strcmp(argv[i], "-g") == 0 && (i + 1 < argc)) {
             detector_options.emplace_back(std::string(argv[++i]));
+        } else if(strcmp(argv[i], "--resume") == 0) {
+            module_options.emplace_back("resume=true");
+        } else if(strcmp(argv[i], "--server") == 0 && (i + 1 < argc)) {
+            job_directory = std::string(argv[++i]);
+        } else if(strcmp(argv[i], "--server-once") == 0 && (i + 1 < argc)) {
+            job_directory = std::string(argv[++i]);
+            server_once = true;
         } else {
             LOG(ERROR) << "Unrecognized command line argument \"" << argv[i] << "\"";
             print_help = true;
@@ -145,6 +155,9 @@ int main(int argc, const char* argv[]) {
         std::cout << "  -o <option>  extra module configuration option(s) to pass" << std::endl;
         std::cout << "  -g <option>  extra detector configuration options(s) to pass" << std::endl;
         std::cout << "  -v <level>   verbosity level, overwriting the global level" << std::endl;
+        std::cout << "  --resume     resume an interrupted run from its checkpoint" << std::endl;
+        std::cout << "  --server <dir> serve the jobs submitted to the job directory" << std::endl;
+        std::cout << "  --server-once <dir> serve the jobs in the job directory until none is left" << std::endl;
         std::cout << "  --version    print version information and quit" << std::endl;
         std::cout << std::endl;
         std::cout << "For more help, please see <https://cern.ch/allpix-squared>" << std::endl;
@@ -173,6 +186,17 @@ int main(int argc, const char* argv[]) {
         Log::addStream(log_file);
     }
 
+    // The job directory is resolved before changing to the output directory
+    if(!job_directory.empty()) {
+        try {
+            job_directory = allpix::get_canonical_path(job_directory);
+        } catch(std::invalid_argument&) {
+            LOG(FATAL) << "Job directory " << job_directory << " does not exist";
+            clean();
+            return 1;
+        }
+    }
+
     try {
         // Construct main Allpix object
         apx = std::make_unique<Allpix>(config_file_name, module_options, detector_options);
@@ -181,14 +205,19 @@ int main(int argc, const char* argv[]) {
         // Load modules
         apx->load();
 
-        // Initialize modules (pre-run)
-        apx->init();
+        if(job_directory.empty()) {
+            // Initialize modules (pre-run)
+            apx->init();
 
-        // Run modules and event-loop
-        apx->run();
+            // Run modules and event-loop
+            apx->run();
 
-        // Finalize modules (post-run)
-        apx->finalize();
+            // Finalize modules (post-run)
+            apx->finalize();
+        } else {
+            // Run all submitted jobs with the modules initialized once
+            apx->serve(job_directory, server_once);
+        }
     } catch(ConfigurationError& e) {
         LOG(FATAL) << "Error in the configuration:" << std::endl
                    << e.what() << std::endl
@@ -172,6 +172,9 @@ void CSADigitizerModule::init() {
 }
 
 void CSADigitizerModule::run(unsigned int event_num) {
+    // Seed the random generators for this event if requested
+    seed_event(random_generator_, event_num);
+
     // Loop through all pixels with charges
     std::vector<PixelHit> hits;
     for(const auto& pixel_charge : pixel_message_->getData()) {
@@ -395,3 +398,11 @@ void CSADigitizerModule::finalize() {
         h_pxq_vs_tot->Write();
     }
 }
+
+void CSADigitizerModule::saveState(std::ostream& state) {
+    state << random_generator_;
+}
+
+void CSADigitizerModule::loadState(std::istream& state) {
+    state >> random_generator_;
+}
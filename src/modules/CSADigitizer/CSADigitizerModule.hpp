@@ -68,6 +68,16 @@ namespace allpix {
          */
         void finalize() override;
 
+        /**
+         * @brief Store the state of the random number generator in a checkpoint
+         */
+        void saveState(std::ostream& state) override;
+
+        /**
+         * @brief Restore the state of the random number generator from a checkpoint
+         */
+        void loadState(std::istream& state) override;
+
     private:
         // Control of module output settings
         bool output_plots_{}, output_pulsegraphs_{};
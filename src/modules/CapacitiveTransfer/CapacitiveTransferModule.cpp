@@ -39,6 +39,7 @@ CapacitiveTransferModule::CapacitiveTransferModule(Configuration& config,
     config_.setDefault("cross_coupling", 1);
     config_.setDefault("nominal_gap", 0.0);
     config_.setDefault("minimum_gap", config_.get<double>("nominal_gap"));
+    config_.setDefault("max_depth_distance", Units::get(5.0, "um"));
 
     // Require propagated deposits for single detector
     messenger->bindSingle(this, &CapacitiveTransferModule::propagated_message_, MsgFlags::REQUIRED);
@@ -53,6 +54,8 @@ void CapacitiveTransferModule::init() {
         relative_coupling = config_.getMatrix<double>("coupling_matrix");
         max_row = static_cast<unsigned int>(relative_coupling.size());
         max_col = static_cast<unsigned int>(relative_coupling[0].size());
+        matrix_rows = max_row;
+        matrix_cols = max_col;
 
         if(config_.get<bool>("output_plots")) {
             LOG(TRACE) << "Creating output plots";
@@ -249,19 +252,82 @@ void CapacitiveTransferModule::init() {
             "Capacitive coupling was not defined. Please, check the README file for configuration options or use "
             "the SimpleTransfer module.");
     }
+
+    max_depth_distance_ = config_.get<double>("max_depth_distance");
+    build_coupling_table();
+}
+
+void CapacitiveTransferModule::build_coupling_table() {
+    auto center_row = matrix_rows / 2;
+    auto center_col = matrix_cols / 2;
+
+    // Elements (row, column) of the coupling matrix to consider, only the central one if cross-coupling is disabled
+    std::vector<std::pair<unsigned int, unsigned int>> elements;
+    if(config_.get<int>("cross_coupling") == 0) {
+        elements.emplace_back(center_row, center_col);
+    } else {
+        for(unsigned int row = 0; row < max_row; row++) {
+            for(unsigned int col = 0; col < max_col; col++) {
+                elements.emplace_back(row, col);
+            }
+        }
+    }
+
+    neighbour_offsets_.clear();
+    for(auto& element : elements) {
+        neighbour_offsets_.emplace_back(static_cast<int>(element.second) - static_cast<int>(center_col),
+                                        static_cast<int>(element.first) - static_cast<int>(center_row));
+    }
+
+    // Coupling matrices are the same for all pixels
+    pixel_dependent_coupling_ = config_.has("coupling_scan_file");
+    if(!pixel_dependent_coupling_) {
+        coupling_table_.clear();
+        for(auto& element : elements) {
+            if(config_.has("coupling_file")) {
+                coupling_table_.push_back(relative_coupling[element.second][element.first]);
+            } else {
+                coupling_table_.push_back(relative_coupling[max_row - element.first - 1][element.second]);
+            }
+        }
+        return;
+    }
+
+    // The coupling from a capacitance scan depends on the gap at the receiving pixel
+    auto xpixels = model_->getNPixels().x();
+    auto ypixels = model_->getNPixels().y();
+    coupling_table_.resize(static_cast<size_t>(xpixels) * ypixels * elements.size());
+    for(unsigned int y = 0; y < ypixels; y++) {
+        for(unsigned int x = 0; x < xpixels; x++) {
+            Eigen::Vector3d pixel_point(x * model_->getPixelSize().x(), y * model_->getPixelSize().y(), 0);
+            auto gap = static_cast<double>(Units::convert(plane.projection(pixel_point)[2], "um"));
+
+            auto offset = (static_cast<size_t>(y) * xpixels + x) * elements.size();
+            for(size_t i = 0; i < elements.size(); i++) {
+                coupling_table_[offset + i] =
+                    capacitances[elements[i].first * 3 + elements[i].second]->Eval(gap, nullptr, "S") * normalization;
+            }
+        }
+    }
+    LOG(DEBUG) << "Precomputed " << coupling_table_.size() << " coupling coefficients for " << xpixels << "x" << ypixels
+               << " pixels";
 }
 
 void CapacitiveTransferModule::run(unsigned int) {
 
-    // Find corresponding pixels for all propagated charges
-    LOG(TRACE) << "Transferring charges to pixels";
-    unsigned int transferred_charges_count = 0;
-    std::map<Pixel::Index, std::pair<double, std::vector<const PropagatedCharge*>>> pixel_map;
+    // Sum up the propagated charges at their nearest pixel, which may lie outside of the pixel grid
+    LOG(TRACE) << "Collecting charges at nearest pixels";
+    struct NearestPixelCharge {
+        double charge{};
+        double absolute_charge{};
+        std::vector<const PropagatedCharge*> propagated_charges;
+    };
+    std::map<std::pair<int, int>, NearestPixelCharge> nearest_pixel_map;
     for(const auto& propagated_charge : propagated_message_->getData()) {
         auto position = propagated_charge.getLocalPosition();
         // Ignore if outside depth range of implant
         if(std::fabs(position.z() - (model_->getSensorCenter().z() + model_->getSensorSize().z() / 2.0)) >
-           config_.get<double>("max_depth_distance")) {
+           max_depth_distance_) {
             LOG(DEBUG) << "Skipping set of " << propagated_charge.getCharge() << " propagated charges at "
                        << propagated_charge.getLocalPosition() << " because their local position is not in implant range";
             continue;
@@ -272,67 +338,54 @@ void CapacitiveTransferModule::run(unsigned int) {
         auto ypixel = static_cast<int>(std::round(position.y() / model_->getPixelSize().y()));
         LOG(DEBUG) << "Hit at pixel " << xpixel << ", " << ypixel;
 
-        Pixel::Index pixel_index;
-        double neighbour_charge = 0;
-        double ccpd_factor = 0;
-
-        Eigen::Vector3d pixel_point;
-        Eigen::Vector3d pixel_projection;
-
-        for(size_t row = 0; row < max_row; row++) {
-            for(size_t col = 0; col < max_col; col++) {
-                if(config_.get<int>("cross_coupling") == 0) {
-                    col = static_cast<size_t>(std::floor(matrix_cols / 2));
-                    row = static_cast<size_t>(std::floor(matrix_rows / 2));
-                }
-
-                auto xcoord = xpixel + static_cast<int>(col - static_cast<size_t>(std::floor(matrix_cols / 2)));
-                auto ycoord = ypixel + static_cast<int>(row - static_cast<size_t>(std::floor(matrix_rows / 2)));
-
-                // Ignore if out of pixel grid
-                if(!detector_->isWithinPixelGrid(xcoord, ycoord)) {
-                    LOG(DEBUG) << "Skipping set of propagated charges at " << propagated_charge.getLocalPosition()
-                               << " because their nearest pixel (" << xpixel << "," << ypixel
-                               << ") is outside the pixel matrix";
-                    continue;
-                }
-
-                pixel_index = Pixel::Index(static_cast<unsigned int>(xcoord), static_cast<unsigned int>(ycoord));
-
-                if(config_.has("coupling_scan_file")) {
-                    double local_x = pixel_index.x() * model_->getPixelSize().x();
-                    double local_y = pixel_index.y() * model_->getPixelSize().y();
-                    pixel_point = Eigen::Vector3d(local_x, local_y, 0);
-                    pixel_projection = plane.projection(pixel_point);
-                    pixel_gap = pixel_projection[2];
-
-                    ccpd_factor = capacitances[row * 3 + col]->Eval(
-                                      static_cast<double>(Units::convert(pixel_gap, "um")), nullptr, "S") *
-                                  normalization;
-                } else if(config_.has("coupling_file")) {
-                    ccpd_factor = relative_coupling[col][row];
-                } else if(config_.has("coupling_matrix")) {
-                    ccpd_factor = relative_coupling[max_row - row - 1][col];
-                } else {
-                    ccpd_factor = 1;
-                    LOG(ERROR) << "This shouldn't happen. Transferring 100% of detected charge";
-                }
-
-                // Update statistics
-                unique_pixels_.insert(pixel_index);
-
-                transferred_charges_count += static_cast<unsigned int>(propagated_charge.getCharge() * ccpd_factor);
-                neighbour_charge =
-                    static_cast<double>(propagated_charge.getSign() * propagated_charge.getCharge()) * ccpd_factor;
+        auto& nearest_pixel = nearest_pixel_map[std::make_pair(xpixel, ypixel)];
+        nearest_pixel.charge += static_cast<double>(propagated_charge.getSign() * propagated_charge.getCharge());
+        nearest_pixel.absolute_charge += propagated_charge.getCharge();
+        nearest_pixel.propagated_charges.emplace_back(&propagated_charge);
+    }
 
-                LOG(DEBUG) << "Set of " << propagated_charge.getCharge() * ccpd_factor << " charges brought to neighbour "
-                           << col << "," << row << " pixel " << pixel_index << "with cross-coupling of " << ccpd_factor * 100
-                           << "%";
+    // Transfer the charge of every nearest pixel to its neighbours using the precomputed coupling coefficients
+    LOG(TRACE) << "Transferring charges to pixels";
+    unsigned int transferred_charges_count = 0;
+    auto xpixels = model_->getNPixels().x();
+    std::map<Pixel::Index, std::pair<double, std::vector<const PropagatedCharge*>>> pixel_map;
+    for(auto& nearest_pixel : nearest_pixel_map) {
+        auto xpixel = nearest_pixel.first.first;
+        auto ypixel = nearest_pixel.first.second;
+
+        for(size_t i = 0; i < neighbour_offsets_.size(); i++) {
+            auto xcoord = xpixel + neighbour_offsets_[i].first;
+            auto ycoord = ypixel + neighbour_offsets_[i].second;
+
+            // Ignore if out of pixel grid
+            if(!detector_->isWithinPixelGrid(xcoord, ycoord)) {
+                LOG(DEBUG) << "Skipping set of propagated charges at pixel (" << xpixel << "," << ypixel
+                           << ") because their neighbour (" << xcoord << "," << ycoord << ") is outside the pixel matrix";
+                continue;
+            }
 
-                // Add the pixel the list of hit pixels
-                pixel_map[pixel_index].first += neighbour_charge;
-                pixel_map[pixel_index].second.emplace_back(&propagated_charge);
+            Pixel::Index pixel_index(static_cast<unsigned int>(xcoord), static_cast<unsigned int>(ycoord));
+            auto table_index = i;
+            if(pixel_dependent_coupling_) {
+                auto pixel_offset = static_cast<size_t>(ycoord) * xpixels + static_cast<size_t>(xcoord);
+                table_index += pixel_offset * neighbour_offsets_.size();
             }
+            auto ccpd_factor = coupling_table_[table_index];
+
+            // Update statistics
+            unique_pixels_.insert(pixel_index);
+            transferred_charges_count += static_cast<unsigned int>(nearest_pixel.second.absolute_charge * ccpd_factor);
+
+            LOG(DEBUG) << "Set of " << nearest_pixel.second.absolute_charge * ccpd_factor
+                       << " charges brought to neighbour pixel " << pixel_index << " with cross-coupling of "
+                       << ccpd_factor * 100 << "%";
+
+            // Add the pixel the list of hit pixels
+            auto& pixel_charge = pixel_map[pixel_index];
+            pixel_charge.first += nearest_pixel.second.charge * ccpd_factor;
+            pixel_charge.second.insert(pixel_charge.second.end(),
+                                       nearest_pixel.second.propagated_charges.begin(),
+                                       nearest_pixel.second.propagated_charges.end());
         }
     }
 
@@ -8,6 +8,7 @@
 #include <map>
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include <TFile.h>
@@ -91,6 +92,19 @@ namespace allpix {
 
         int cross_coupling;
 
+        /**
+         * @brief Precompute the coupling coefficients of all neighbours considered
+         *
+         * Coefficients from a capacitance scan depend on the gap at the receiving pixel and are stored for every pixel.
+         */
+        void build_coupling_table();
+
+        // Offsets of the coupled pixels relative to the nearest pixel, and their coupling coefficients stored per pixel
+        std::vector<std::pair<int, int>> neighbour_offsets_;
+        std::vector<double> coupling_table_;
+        bool pixel_dependent_coupling_{};
+        double max_depth_distance_{};
+
         void getCapacitanceScan(TFile* root_file);
         TGraph* capacitances[9];
 
@@ -9,10 +9,13 @@
 
 #include "DefaultDigitizerModule.hpp"
 
+#include <cmath>
+
 #include "core/utils/unit.h"
-#include "objects/PixelHit.hpp"
 #include "tools/ROOT.h"
 
+#include <Math/ProbFuncMathCore.h>
+#include <Math/QuantFuncMathCore.h>
 #include <TFile.h>
 #include <TH1D.h>
 #include <TProfile.h>
@@ -26,9 +29,6 @@ DefaultDigitizerModule::DefaultDigitizerModule(Configuration& config,
     // Enable parallelization of this module if multithreading is enabled
     enable_parallelization();
 
-    // Require PixelCharge message for single detector
-    messenger_->bindSingle(this, &DefaultDigitizerModule::pixel_message_, MsgFlags::REQUIRED);
-
     // Seed the random generator with the global seed
     random_generator_.seed(getRandomSeed());
 
@@ -44,6 +44,7 @@ DefaultDigitizerModule::DefaultDigitizerModule(Configuration& config,
     config_.setDefault<double>("gain_smearing", 0.0);
     config_.setDefault<int>("threshold", Units::get(600, "e"));
     config_.setDefault<int>("threshold_smearing", Units::get(30, "e"));
+    config_.setDefault<bool>("noise_hits", false);
 
     // QDC configuration
     config_.setDefault<int>("qdc_resolution", 0);
@@ -64,6 +65,11 @@ DefaultDigitizerModule::DefaultDigitizerModule(Configuration& config,
     config_.setDefault<int>("output_plots_scale", Units::get(30, "ke"));
     config_.setDefault<int>("output_plots_timescale", Units::get(300, "ns"));
     config_.setDefault<int>("output_plots_bins", 100);
+
+    // Require PixelCharge message for single detector, unless noise hits are added to pixels without charge
+    noise_hits_ = config_.get<bool>("noise_hits");
+    messenger_->bindSingle(
+        this, &DefaultDigitizerModule::pixel_message_, noise_hits_ ? MsgFlags::NONE : MsgFlags::REQUIRED);
 }
 
 void DefaultDigitizerModule::init() {
@@ -83,6 +89,19 @@ void DefaultDigitizerModule::init() {
                   << "bit, max. value " << ((1 << config_.get<int>("tdc_resolution")) - 1);
     }
 
+    if(noise_hits_) {
+        // Noise exceeds the threshold if the difference of the amplified noise and the smeared threshold is positive
+        auto gain = config_.get<double>("gain");
+        auto noise = gain * config_.get<double>("electronics_noise");
+        noise_width_ = std::hypot(noise, config_.get<double>("threshold_smearing"));
+        noise_probability_ =
+            (noise_width_ > 0 ? ROOT::Math::normal_cdf_c(config_.get<double>("threshold"), noise_width_) : 0.);
+
+        auto number_of_pixels = getDetector()->getModel()->getNPixels();
+        LOG(INFO) << "Adding noise hits with probability " << noise_probability_ << " per pixel, "
+                  << noise_probability_ * number_of_pixels.x() * number_of_pixels.y() << " noise hits per event expected";
+    }
+
     if(config_.get<bool>("output_plots")) {
         LOG(TRACE) << "Creating output plots";
 
@@ -147,13 +166,25 @@ void DefaultDigitizerModule::init() {
     }
 }
 
-void DefaultDigitizerModule::run(unsigned int) {
+void DefaultDigitizerModule::run(unsigned int event_num) {
+    // Seed the random generators for this event if requested
+    seed_event(random_generator_, event_num);
+
+    // The message is only missing in events without charge if noise hits are enabled
+    std::vector<PixelCharge> no_charges;
+    const auto& pixel_charges = (pixel_message_ != nullptr ? pixel_message_->getData() : no_charges);
+
     // Loop through all pixels with charges
     std::vector<PixelHit> hits;
-    for(const auto& pixel_charge : pixel_message_->getData()) {
+    std::set<unsigned long long> charged_pixels;
+    auto columns = static_cast<unsigned long long>(getDetector()->getModel()->getNPixels().x());
+    for(const auto& pixel_charge : pixel_charges) {
         auto pixel = pixel_charge.getPixel();
         auto pixel_index = pixel.getIndex();
         auto charge = static_cast<double>(pixel_charge.getAbsoluteCharge());
+        if(noise_hits_) {
+            charged_pixels.insert(pixel_index.x() + pixel_index.y() * columns);
+        }
 
         LOG(DEBUG) << "Received pixel " << pixel_index << ", (absolute) charge " << Units::display(charge, "e");
         if(config_.get<bool>("output_plots")) {
@@ -204,32 +235,7 @@ void DefaultDigitizerModule::run(unsigned int) {
         }
 
         // Simulate QDC if resolution set to more than 0bit
-        if(config_.get<int>("qdc_resolution") > 0) {
-            // temporarily store old charge for histogramming:
-            auto original_charge = charge;
-
-            // Add ADC smearing:
-            std::normal_distribution<double> adc_smearing(0, config_.get<unsigned int>("qdc_smearing"));
-            charge += adc_smearing(random_generator_);
-            if(config_.get<bool>("output_plots")) {
-                h_pxq_adc_smear->Fill(charge / 1e3);
-            }
-            LOG(DEBUG) << "Smeared for simulating limited QDC sensitivity: " << Units::display(charge, "e");
-
-            // Convert to ADC units and precision, make sure ADC count is at least 1:
-            charge = static_cast<double>(std::max(
-                std::min(static_cast<int>((config_.get<double>("qdc_offset") + charge) / config_.get<double>("qdc_slope")),
-                         (1 << config_.get<int>("qdc_resolution")) - 1),
-                (config_.get<bool>("allow_zero_qdc") ? 0 : 1)));
-            LOG(DEBUG) << "Charge converted to QDC units: " << charge;
-
-            if(config_.get<bool>("output_plots")) {
-                h_calibration->Fill(original_charge / 1e3, charge);
-                h_pxq_adc->Fill(charge);
-            }
-        } else if(config_.get<bool>("output_plots")) {
-            h_pxq_adc->Fill(charge / 1e3);
-        }
+        charge = convert_charge(charge);
 
         auto time = time_of_arrival(pixel_charge, threshold);
         LOG(DEBUG) << "Local time of arrival: " << Units::display(time, {"ns", "ps"});
@@ -238,37 +244,17 @@ void DefaultDigitizerModule::run(unsigned int) {
         }
 
         // Simulate TDC if resolution set to more than 0bit
-        if(config_.get<int>("tdc_resolution") > 0) {
-            // temporarily store full arrival time for histogramming:
-            auto original_time = time;
-
-            // Add TDC smearing:
-            std::normal_distribution<double> tdc_smearing(0, config_.get<unsigned int>("tdc_smearing"));
-            time += tdc_smearing(random_generator_);
-            if(config_.get<bool>("output_plots")) {
-                h_px_tdc_smear->Fill(time);
-            }
-            LOG(DEBUG) << "Smeared for simulating limited TDC sensitivity: " << Units::display(time, {"ns", "ps"});
-
-            // Convert to TDC units and precision, make sure TDC count is at least 1:
-            time = static_cast<double>(std::max(
-                std::min(static_cast<int>((config_.get<double>("tdc_offset") + time) / config_.get<double>("tdc_slope")),
-                         (1 << config_.get<int>("tdc_resolution")) - 1),
-                (config_.get<bool>("allow_zero_tdc") ? 0 : 1)));
-            LOG(DEBUG) << "Time converted to TDC units: " << time;
-
-            if(config_.get<bool>("output_plots")) {
-                h_toa_calibration->Fill(original_time, time);
-                h_px_tdc->Fill(time);
-            }
-        } else if(config_.get<bool>("output_plots")) {
-            h_px_tdc->Fill(time);
-        }
+        time = convert_time(time);
 
         // Add the hit to the hitmap
         hits.emplace_back(pixel, time, pixel_charge.getGlobalTime() + time, charge, &pixel_charge);
     }
 
+    // Add noise hits in all pixels without charge
+    if(noise_hits_) {
+        add_noise_hits(hits, charged_pixels);
+    }
+
     // Output summary and update statistics
     LOG(INFO) << "Digitized " << hits.size() << " pixel hits";
     total_hits_ += hits.size();
@@ -280,6 +266,119 @@ void DefaultDigitizerModule::run(unsigned int) {
     }
 }
 
+double DefaultDigitizerModule::convert_charge(double charge) {
+    if(config_.get<int>("qdc_resolution") > 0) {
+        // temporarily store old charge for histogramming:
+        auto original_charge = charge;
+
+        // Add ADC smearing:
+        std::normal_distribution<double> adc_smearing(0, config_.get<unsigned int>("qdc_smearing"));
+        charge += adc_smearing(random_generator_);
+        if(config_.get<bool>("output_plots")) {
+            h_pxq_adc_smear->Fill(charge / 1e3);
+        }
+        LOG(DEBUG) << "Smeared for simulating limited QDC sensitivity: " << Units::display(charge, "e");
+
+        // Convert to ADC units and precision, make sure ADC count is at least 1:
+        charge = static_cast<double>(std::max(
+            std::min(static_cast<int>((config_.get<double>("qdc_offset") + charge) / config_.get<double>("qdc_slope")),
+                     (1 << config_.get<int>("qdc_resolution")) - 1),
+            (config_.get<bool>("allow_zero_qdc") ? 0 : 1)));
+        LOG(DEBUG) << "Charge converted to QDC units: " << charge;
+
+        if(config_.get<bool>("output_plots")) {
+            h_calibration->Fill(original_charge / 1e3, charge);
+            h_pxq_adc->Fill(charge);
+        }
+    } else if(config_.get<bool>("output_plots")) {
+        h_pxq_adc->Fill(charge / 1e3);
+    }
+
+    return charge;
+}
+
+double DefaultDigitizerModule::convert_time(double time) {
+    if(config_.get<int>("tdc_resolution") > 0) {
+        // temporarily store full arrival time for histogramming:
+        auto original_time = time;
+
+        // Add TDC smearing:
+        std::normal_distribution<double> tdc_smearing(0, config_.get<unsigned int>("tdc_smearing"));
+        time += tdc_smearing(random_generator_);
+        if(config_.get<bool>("output_plots")) {
+            h_px_tdc_smear->Fill(time);
+        }
+        LOG(DEBUG) << "Smeared for simulating limited TDC sensitivity: " << Units::display(time, {"ns", "ps"});
+
+        // Convert to TDC units and precision, make sure TDC count is at least 1:
+        time = static_cast<double>(std::max(
+            std::min(static_cast<int>((config_.get<double>("tdc_offset") + time) / config_.get<double>("tdc_slope")),
+                     (1 << config_.get<int>("tdc_resolution")) - 1),
+            (config_.get<bool>("allow_zero_tdc") ? 0 : 1)));
+        LOG(DEBUG) << "Time converted to TDC units: " << time;
+
+        if(config_.get<bool>("output_plots")) {
+            h_toa_calibration->Fill(original_time, time);
+            h_px_tdc->Fill(time);
+        }
+    } else if(config_.get<bool>("output_plots")) {
+        h_px_tdc->Fill(time);
+    }
+
+    return time;
+}
+
+void DefaultDigitizerModule::add_noise_hits(std::vector<PixelHit>& hits,
+                                            const std::set<unsigned long long>& charged_pixels) {
+    if(noise_probability_ <= 0) {
+        return;
+    }
+
+    auto number_of_pixels = getDetector()->getModel()->getNPixels();
+    auto columns = static_cast<unsigned long long>(number_of_pixels.x());
+    auto pixels = columns * static_cast<unsigned long long>(number_of_pixels.y());
+    auto threshold_mean = config_.get<double>("threshold");
+    auto threshold_width = config_.get<double>("threshold_smearing");
+    auto log_complement = std::log1p(-noise_probability_);
+    std::uniform_real_distribution<double> uniform(0, 1);
+
+    unsigned long long noise_hits = 0;
+    unsigned long long index = 0;
+    while(true) {
+        // The number of pixels without noise hit before the next one follows a geometric distribution
+        auto skip = std::floor(std::log(1 - uniform(random_generator_)) / log_complement);
+        if(skip >= static_cast<double>(pixels - index)) {
+            break;
+        }
+        index += static_cast<unsigned long long>(skip);
+
+        // Pixels with charge have already been digitized including their noise
+        if(charged_pixels.find(index) == charged_pixels.end()) {
+            // Sample the excess of the noise over the threshold from the tail of their difference beyond zero
+            auto tail = (1 - uniform(random_generator_)) * noise_probability_;
+            auto excess = ROOT::Math::normal_quantile_c(tail, noise_width_) - threshold_mean;
+
+            // Split the excess into the threshold and the charge according to their correlation
+            auto variance_fraction = threshold_width * threshold_width / (noise_width_ * noise_width_);
+            std::normal_distribution<double> thr_smearing(threshold_mean - variance_fraction * (excess + threshold_mean),
+                                                          threshold_width * std::sqrt(1 - variance_fraction));
+            auto threshold = thr_smearing(random_generator_);
+            auto charge = convert_charge(excess + threshold);
+            auto time = convert_time(0);
+
+            auto pixel = getDetector()->getPixel(static_cast<unsigned int>(index % columns),
+                                                 static_cast<unsigned int>(index / columns));
+            LOG(DEBUG) << "Noise hit in pixel " << pixel.getIndex() << " with charge " << Units::display(charge, "e");
+            hits.emplace_back(pixel, time, time, charge);
+            ++noise_hits;
+        }
+        ++index;
+    }
+
+    LOG(DEBUG) << "Added " << noise_hits << " noise hits";
+    total_noise_hits_ += noise_hits;
+}
+
 double DefaultDigitizerModule::time_of_arrival(const PixelCharge& pixel_charge, double threshold) const {
 
     // If this PixelCharge has a pulse, we can find out when it crossed the threshold:
@@ -330,4 +429,15 @@ void DefaultDigitizerModule::finalize() {
     }
 
     LOG(INFO) << "Digitized " << total_hits_ << " pixel hits in total";
+    if(noise_hits_) {
+        LOG(INFO) << "Added " << total_noise_hits_ << " noise hits in total";
+    }
+}
+
+void DefaultDigitizerModule::saveState(std::ostream& state) {
+    state << random_generator_;
+}
+
+void DefaultDigitizerModule::loadState(std::istream& state) {
+    state >> random_generator_;
 }
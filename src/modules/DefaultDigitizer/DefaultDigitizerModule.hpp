@@ -12,13 +12,16 @@
 
 #include <memory>
 #include <random>
+#include <set>
 #include <string>
+#include <vector>
 
 #include "core/config/Configuration.hpp"
 #include "core/messenger/Messenger.hpp"
 #include "core/module/Module.hpp"
 
 #include "objects/PixelCharge.hpp"
+#include "objects/PixelHit.hpp"
 
 #include <TH1D.h>
 #include <TH2D.h>
@@ -58,6 +61,16 @@ namespace allpix {
          */
         void finalize() override;
 
+        /**
+         * @brief Store the state of the random number generator in a checkpoint
+         */
+        void saveState(std::ostream& state) override;
+
+        /**
+         * @brief Restore the state of the random number generator from a checkpoint
+         */
+        void loadState(std::istream& state) override;
+
     private:
         std::mt19937_64 random_generator_;
 
@@ -74,8 +87,38 @@ namespace allpix {
          */
         double time_of_arrival(const PixelCharge& pixel_charge, double threshold) const;
 
+        /**
+         * @brief Helper function to simulate the QDC, if enabled
+         * @param  charge Charge above threshold
+         * @return        Charge in QDC units if the QDC simulation is enabled, the unchanged charge otherwise
+         */
+        double convert_charge(double charge);
+
+        /**
+         * @brief Helper function to simulate the TDC, if enabled
+         * @param  time Time of arrival
+         * @return      Time in TDC units if the TDC simulation is enabled, the unchanged time otherwise
+         */
+        double convert_time(double time);
+
+        /**
+         * @brief Add hits from noise exceeding the threshold in pixels without charge
+         * @param hits           List of hits to add the noise hits to
+         * @param charged_pixels Linear indices of the pixels with charge, which are not considered
+         *
+         * Instead of sampling the noise of every pixel, the distance to the next pixel with a noise hit is sampled from a
+         * geometric distribution, such that the time required only scales with the number of noise hits.
+         */
+        void add_noise_hits(std::vector<PixelHit>& hits, const std::set<unsigned long long>& charged_pixels);
+
+        // Noise hits in pixels without charge
+        bool noise_hits_{};
+        double noise_probability_{};
+        double noise_width_{};
+
         // Statistics
         unsigned long long total_hits_{};
+        unsigned long long total_noise_hits_{};
 
         // Output histograms
         TH1D *h_pxq{}, *h_pxq_noise{}, *h_gain{}, *h_pxq_gain{}, *h_thr{}, *h_pxq_thr{}, *h_pxq_adc_smear{}, *h_pxq_adc{};
@@ -10,11 +10,17 @@
 
 #include "DepositionGeant4Module.hpp"
 
+#include <array>
+#include <fstream>
+#include <iomanip>
 #include <limits>
+#include <map>
+#include <sstream>
 #include <string>
 #include <utility>
 
 #include <G4EmParameters.hh>
+#include <G4FastSimulationPhysics.hh>
 #include <G4HadronicProcessStore.hh>
 #include <G4LogicalVolume.hh>
 #include <G4PhysListFactory.hh>
@@ -23,6 +29,9 @@
 #include <G4StepLimiterPhysics.hh>
 #include <G4UImanager.hh>
 #include <G4UserLimits.hh>
+#include <G4VModularPhysicsList.hh>
+#include <G4Version.hh>
+#include <Randomize.hh>
 
 #include "G4FieldManager.hh"
 #include "G4TransportationManager.hh"
@@ -31,11 +40,14 @@
 #include "core/config/exceptions.h"
 #include "core/geometry/GeometryManager.hpp"
 #include "core/module/exceptions.h"
+#include "core/utils/file.h"
 #include "core/utils/log.h"
+#include "core/utils/text.h"
 #include "objects/DepositedCharge.hpp"
 #include "tools/ROOT.h"
 #include "tools/geant4.h"
 
+#include "FastDepositionModelG4.hpp"
 #include "GeneratorActionG4.hpp"
 #include "SensitiveDetectorActionG4.hpp"
 #include "SetTrackInfoUserHookG4.hpp"
@@ -48,7 +60,7 @@ using namespace allpix;
  * Includes the particle source point to the geometry using \ref GeometryManager::addPoint.
  */
 DepositionGeant4Module::DepositionGeant4Module(Configuration& config, Messenger* messenger, GeometryManager* geo_manager)
-    : Module(config), messenger_(messenger), geo_manager_(geo_manager), last_event_num_(1), run_manager_g4_(nullptr) {
+    : Module(config), messenger_(messenger), geo_manager_(geo_manager), run_manager_g4_(nullptr) {
 
     // Set default physics list
     config_.setDefault("physics_list", "FTFP_BERT_LIV");
@@ -59,6 +71,10 @@ DepositionGeant4Module::DepositionGeant4Module(Configuration& config, Messenger*
     config_.setDefault<double>("max_step_length", Units::get(1.0, "um"));
     // Default value chosen to ensure proper gamma generation for Cs137 decay
     config_.setDefault<double>("cutoff_time", 2.21e+11);
+    config_.setDefault<double>("deposit_voxel_size", 0);
+    config_.setDefault<bool>("enable_fast_simulation", false);
+    config_.setDefault<double>("fast_simulation_energy", Units::get(1.0, "GeV"));
+    config_.setDefault<double>("delta_ray_cutoff", Units::get(10.0, "keV"));
 
     // Set alias for support of old particle source definition
     config_.setAlias("source_position", "beam_position");
@@ -112,11 +128,11 @@ void DepositionGeant4Module::init() {
     // Get UI manager for sending commands
     G4UImanager* ui_g4 = G4UImanager::GetUIpointer();
 
-    // Apply optional PAI model
-    if(config_.get<bool>("enable_pai", false)) {
-        LOG(TRACE) << "Enabling PAI model on all detectors";
-        G4EmParameters::Instance();
-
+    // Create a region for the sensor of every detector if required by the PAI model or the fast simulation
+    auto enable_pai = config_.get<bool>("enable_pai", false);
+    auto enable_fast_simulation = config_.get<bool>("enable_fast_simulation");
+    std::map<std::string, G4Region*> sensor_regions;
+    if(enable_pai || enable_fast_simulation) {
         for(auto& detector : geo_manager_->getDetectors()) {
             // Get logical volume
             auto logical_volume = geo_manager_->getExternalObject<G4LogicalVolume>(detector->getName(), "sensor_log");
@@ -126,19 +142,28 @@ void DepositionGeant4Module::init() {
             // Create region
             auto* region = new G4Region(detector->getName() + "_sensor_region");
             region->AddRootLogicalVolume(logical_volume.get());
+            sensor_regions[detector->getName()] = region;
+        }
+    }
 
-            auto pai_model = config_.get<std::string>("pai_model", "pai");
-            auto lcase_model = pai_model;
-            std::transform(lcase_model.begin(), lcase_model.end(), lcase_model.begin(), ::tolower);
-            if(lcase_model == "pai") {
-                pai_model = "PAI";
-            } else if(lcase_model == "paiphoton") {
-                pai_model = "PAIphoton";
-            } else {
-                throw InvalidValueError(config_, "pai_model", "model has to be either 'pai' or 'paiphoton'");
-            }
+    // Apply optional PAI model
+    if(enable_pai) {
+        LOG(TRACE) << "Enabling PAI model on all detectors";
+        G4EmParameters::Instance();
 
-            ui_g4->ApplyCommand("/process/em/AddPAIRegion all " + region->GetName() + " " + pai_model);
+        auto pai_model = config_.get<std::string>("pai_model", "pai");
+        auto lcase_model = pai_model;
+        std::transform(lcase_model.begin(), lcase_model.end(), lcase_model.begin(), ::tolower);
+        if(lcase_model == "pai") {
+            pai_model = "PAI";
+        } else if(lcase_model == "paiphoton") {
+            pai_model = "PAIphoton";
+        } else {
+            throw InvalidValueError(config_, "pai_model", "model has to be either 'pai' or 'paiphoton'");
+        }
+
+        for(auto& region : sensor_regions) {
+            ui_g4->ApplyCommand("/process/em/AddPAIRegion all " + region.second->GetName() + " " + pai_model);
         }
     }
 
@@ -176,6 +201,17 @@ void DepositionGeant4Module::init() {
     // Register radioactive decay physics lists
     physicsList->RegisterPhysics(new G4RadioactiveDecayPhysics());
 
+    // Register the fast simulation process for the charged particles which can be handled by the fast deposition model
+    if(enable_fast_simulation) {
+        LOG(TRACE) << "Enabling fast simulation of particles above "
+                   << Units::display(config_.get<double>("fast_simulation_energy"), {"MeV", "GeV"});
+        auto* fast_simulation_physics = new G4FastSimulationPhysics();
+        for(const auto* particle : {"e-", "e+", "mu-", "mu+", "pi-", "pi+", "kaon-", "kaon+", "proton", "anti_proton"}) {
+            fast_simulation_physics->ActivateFastSimulation(particle);
+        }
+        physicsList->RegisterPhysics(fast_simulation_physics);
+    }
+
     // Set the range-cut off threshold for secondary production:
     double production_cut = NAN;
     if(config_.has("range_cut")) {
@@ -208,8 +244,37 @@ void DepositionGeant4Module::init() {
         world_log_volume->SetUserLimits(user_limits_world_.get());
     }
 
+    // Retrieve the physics tables if they have been stored before for the same geometry and physics configuration
+    if(config_.has("cache_directory")) {
+        auto geometry_hash = geo_manager_->getExternalObject<std::string>("", "geometry_hash");
+        if(geometry_hash == nullptr) {
+            LOG(WARNING) << "Geometry does not provide a hash, physics tables are not cached";
+        } else {
+            std::ostringstream physics_description;
+            physics_description << std::setprecision(17) << *geometry_hash << " " << G4VERSION_NUMBER << " "
+                                << config_.get<std::string>("physics_list") << " " << production_cut << " " << enable_pai
+                                << " " << config_.get<std::string>("pai_model", "pai") << " " << enable_fast_simulation;
+            physics_table_directory_ =
+                config_.getPath("cache_directory") + "/physics_" + allpix::hash_string(physics_description.str());
+
+            if(allpix::path_is_file(physics_table_directory_ + "/complete")) {
+                LOG(INFO) << "Retrieving physics tables from " << physics_table_directory_;
+                physicsList->SetPhysicsTableRetrieved(physics_table_directory_);
+                physics_table_directory_.clear();
+            } else {
+                try {
+                    allpix::create_directories(physics_table_directory_);
+                } catch(std::invalid_argument& e) {
+                    throw InvalidValueError(config_, "cache_directory", e.what());
+                }
+                LOG(INFO) << "Physics tables will be stored in " << physics_table_directory_;
+            }
+        }
+    }
+
     // Initialize the physics list
     LOG(TRACE) << "Initializing physics processes";
+    physics_list_ = physicsList;
     run_manager_g4_->SetUserInitialization(physicsList);
     run_manager_g4_->InitializePhysics();
 
@@ -276,7 +341,8 @@ void DepositionGeant4Module::init() {
                                                                         charge_creation_energy,
                                                                         fano_factor,
                                                                         config_.get<double>("cutoff_time"),
-                                                                        getRandomSeed());
+                                                                        getRandomSeed(),
+                                                                        config_.get<double>("deposit_voxel_size"));
         auto logical_volume = geo_manager_->getExternalObject<G4LogicalVolume>(detector->getName(), "sensor_log");
         if(logical_volume == nullptr) {
             throw ModuleError("Detector " + detector->getName() + " has no sensitive device (broken Geant4 geometry)");
@@ -289,6 +355,15 @@ void DepositionGeant4Module::init() {
         logical_volume->SetSensitiveDetector(sensitive_detector_action);
         sensors_.push_back(sensitive_detector_action);
 
+        // Attach the fast deposition model to the region of the sensor
+        if(enable_fast_simulation) {
+            fast_models_.push_back(std::make_unique<FastDepositionModelG4>(sensor_regions.at(detector->getName()),
+                                                                           sensitive_detector_action,
+                                                                           config_.get<double>("fast_simulation_energy"),
+                                                                           config_.get<double>("delta_ray_cutoff"),
+                                                                           config_.get<double>("max_step_length")));
+        }
+
         // If requested, prepare output plots
         if(config_.get<bool>("output_plots")) {
             LOG(TRACE) << "Creating output plots";
@@ -328,10 +403,34 @@ void DepositionGeant4Module::run(unsigned int event_num) {
         SUPPRESS_STREAM(G4cout);
     }
 
+    // Seed Geant4 and the charge creation fluctuations for this event if requested
+    if(isSeededPerEvent()) {
+        auto random_engine = RandomEngine(getEventSeed(event_num));
+        // Seeds have to be non-zero, the list is terminated by a zero
+        std::array<long, G4_NUM_SEEDS + 1> seeds{};
+        for(int i = 0; i < G4_NUM_SEEDS; ++i) {
+            seeds[static_cast<size_t>(i)] = static_cast<long>(random_engine() % (INT_MAX - 1) + 1);
+        }
+        G4Random::setTheSeeds(seeds.data());
+        for(auto& sensor : sensors_) {
+            sensor->setRandomSeed(random_engine());
+        }
+    }
+
     // Start a single event from the beam
     LOG(TRACE) << "Enabling beam";
     run_manager_g4_->BeamOn(static_cast<int>(config_.get<unsigned int>("number_of_particles", 1)));
-    last_event_num_ = event_num;
+    ++number_of_events_;
+
+    // Store the physics tables once they have been built for the first event
+    if(!physics_table_directory_.empty()) {
+        if(physics_list_->StorePhysicsTable(physics_table_directory_)) {
+            std::ofstream(physics_table_directory_ + "/complete") << config_.get<std::string>("physics_list") << std::endl;
+        } else {
+            LOG(WARNING) << "Could not store physics tables in " << physics_table_directory_;
+        }
+        physics_table_directory_.clear();
+    }
 
     // Release the stream (if it was suspended)
     RELEASE_STREAM(G4cout);
@@ -369,11 +468,27 @@ void DepositionGeant4Module::finalize() {
     }
 
     // Print summary or warns if module did not output any charges
-    if(!sensors_.empty() && total_charges > 0 && last_event_num_ > 0) {
-        size_t average_charge = total_charges / sensors_.size() / last_event_num_;
+    if(!sensors_.empty() && total_charges > 0 && number_of_events_ > 0) {
+        size_t average_charge = total_charges / sensors_.size() / number_of_events_;
         LOG(INFO) << "Deposited total of " << total_charges << " charges in " << sensors_.size() << " sensor(s) (average of "
                   << average_charge << " per sensor for every event)";
     } else {
         LOG(WARNING) << "No charges deposited";
     }
 }
+
+void DepositionGeant4Module::saveState(std::ostream& state) {
+    state << number_of_events_ << " ";
+    for(auto& sensor : sensors_) {
+        sensor->saveState(state);
+    }
+    G4Random::saveFullState(state);
+}
+
+void DepositionGeant4Module::loadState(std::istream& state) {
+    state >> number_of_events_;
+    for(auto& sensor : sensors_) {
+        sensor->loadState(state);
+    }
+    G4Random::restoreFullState(state);
+}
@@ -18,6 +18,7 @@
 #include "core/messenger/Messenger.hpp"
 #include "core/module/Module.hpp"
 
+#include "FastDepositionModelG4.hpp"
 #include "SensitiveDetectorActionG4.hpp"
 #include "TrackInfoManager.hpp"
 
@@ -25,6 +26,7 @@
 
 class G4UserLimits;
 class G4RunManager;
+class G4VModularPhysicsList;
 
 namespace allpix {
     /**
@@ -61,6 +63,16 @@ namespace allpix {
          */
         void finalize() override;
 
+        /**
+         * @brief Store the state of the Geant4 random number engine and of all sensitive detectors in a checkpoint
+         */
+        void saveState(std::ostream& state) override;
+
+        /**
+         * @brief Restore the state of the Geant4 random number engine and of all sensitive detectors from a checkpoint
+         */
+        void loadState(std::istream& state) override;
+
     private:
         Messenger* messenger_;
         GeometryManager* geo_manager_;
@@ -71,8 +83,11 @@ namespace allpix {
         // Handling of the charge deposition in all the sensitive devices
         std::vector<SensitiveDetectorActionG4*> sensors_;
 
-        // Number of the last event
-        unsigned int last_event_num_;
+        // Fast simulation models attached to the sensors
+        std::vector<std::unique_ptr<FastDepositionModelG4>> fast_models_;
+
+        // Number of events simulated
+        unsigned int number_of_events_{};
 
         // Class holding the limits for the step size
         std::unique_ptr<G4UserLimits> user_limits_;
@@ -81,6 +96,10 @@ namespace allpix {
         // Pointer to the Geant4 manager (owned by GeometryBuilderGeant4)
         G4RunManager* run_manager_g4_;
 
+        // Physics list (owned by the Geant4 manager) and directory to store its tables in after the first event
+        G4VModularPhysicsList* physics_list_{};
+        std::string physics_table_directory_;
+
         // Vector of histogram pointers for debugging plots
         std::map<std::string, TH1D*> charge_per_event_;
     };
@@ -0,0 +1,193 @@
+/**
+ * @file
+ * @brief Implements the parametrised fast simulation of the energy deposition in the sensors
+ * @copyright Copyright (c) 2017-2020 CERN and the Allpix Squared authors.
+ * This software is distributed under the terms of the MIT License, copied verbatim in the file "LICENSE.md".
+ * In applying this license, CERN does not waive the privileges and immunities granted to it by virtue of its status as an
+ * Intergovernmental Organization or submit itself to any jurisdiction.
+ */
+
+#include "FastDepositionModelG4.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include <G4DynamicParticle.hh>
+#include <G4Electron.hh>
+#include <G4GeometryTolerance.hh>
+#include <G4LogicalVolume.hh>
+#include <G4Material.hh>
+#include <G4PhysicalConstants.hh>
+#include <G4Poisson.hh>
+#include <G4Positron.hh>
+#include <Randomize.hh>
+
+#include <Math/QuantFuncMathCore.h>
+
+#include "core/utils/log.h"
+#include "core/utils/unit.h"
+
+using namespace allpix;
+
+namespace {
+    // Number of quantiles tabulated for the Landau distribution
+    static constexpr size_t landau_table_size = 10000;
+    // Most probable value of the reduced variable of the Landau distribution
+    static constexpr double landau_most_probable = -0.22278;
+} // namespace
+
+FastDepositionModelG4::FastDepositionModelG4(G4Region* region,
+                                             SensitiveDetectorActionG4* sensor,
+                                             double energy_threshold,
+                                             double delta_ray_cutoff,
+                                             double segment_length)
+    : G4VFastSimulationModel("FastDeposition_" + sensor->getName(), region), sensor_(sensor),
+      energy_threshold_(energy_threshold), delta_ray_cutoff_(delta_ray_cutoff), segment_length_(segment_length) {
+    // Tabulate the inverse of the cumulative distribution function once to sample it by interpolation
+    landau_table_.resize(landau_table_size);
+    for(size_t i = 0; i < landau_table_size; ++i) {
+        auto probability = (static_cast<double>(i) + 0.5) / static_cast<double>(landau_table_size);
+        landau_table_[i] = ROOT::Math::landau_quantile(probability);
+    }
+}
+
+G4bool FastDepositionModelG4::IsApplicable(const G4ParticleDefinition& particle) {
+    return particle.GetPDGCharge() != 0 && particle.GetPDGMass() > 0 && particle.GetParticleType() != "nucleus";
+}
+
+G4bool FastDepositionModelG4::ModelTrigger(const G4FastTrack& fast_track) {
+    if(fast_track.GetPrimaryTrack()->GetKineticEnergy() < energy_threshold_) {
+        return false;
+    }
+
+    // Leave tracks on the exit surface to the regular transportation
+    auto distance = fast_track.GetEnvelopeSolid()->DistanceToOut(fast_track.GetPrimaryTrackLocalPosition(),
+                                                                 fast_track.GetPrimaryTrackLocalDirection());
+    return distance > G4GeometryTolerance::GetInstance()->GetSurfaceTolerance();
+}
+
+double FastDepositionModelG4::sample_landau(double maximum) const {
+    // Restrict the sampled probability to the part of the table below the maximum
+    auto count = static_cast<size_t>(std::upper_bound(landau_table_.begin(), landau_table_.end(), maximum) -
+                                     landau_table_.begin());
+    if(count < 2) {
+        return std::min(landau_table_.front(), maximum);
+    }
+
+    auto position = G4UniformRand() * static_cast<double>(count - 1);
+    auto index = std::min(static_cast<size_t>(position), count - 2);
+    auto fraction = position - static_cast<double>(index);
+    return landau_table_[index] + fraction * (landau_table_[index + 1] - landau_table_[index]);
+}
+
+/**
+ * The most probable energy loss of a particle with charge \f$z\f$ and velocity \f$\beta\f$ over a path of length \f$x\f$ is
+ * \f[
+ *     \Delta_p = \xi \left[ \ln(2 m c^2 \beta^2 \gamma^2 / I) + \ln(\xi / I) + 0.200 - \beta^2 - \delta(\beta\gamma)\right]
+ * \f]
+ * with \f$\xi = 2 \pi r_e^2 m c^2 n_e z^2 x / \beta^2\f$, the electron density \f$n_e\f$ and the mean excitation energy
+ * \f$I\f$ of the sensor material. Energy transfers above the delta ray cutoff are excluded from the sampled loss and are
+ * created as secondary electrons instead, following the \f$1/T^2\f$ spectrum of free electrons.
+ */
+void FastDepositionModelG4::DoIt(const G4FastTrack& fast_track, G4FastStep& fast_step) {
+    const auto* track = fast_track.GetPrimaryTrack();
+    const auto* particle = track->GetDynamicParticle();
+
+    // Straight path from the current position to the exit of the sensor
+    auto length = fast_track.GetEnvelopeSolid()->DistanceToOut(fast_track.GetPrimaryTrackLocalPosition(),
+                                                               fast_track.GetPrimaryTrackLocalDirection());
+    auto entry = track->GetPosition();
+    auto direction = track->GetMomentumDirection();
+    auto exit = entry + length * direction;
+
+    // Kinematics of the particle
+    auto mass = particle->GetMass();
+    auto kinetic_energy = particle->GetKineticEnergy();
+    auto gamma = kinetic_energy / mass + 1;
+    auto beta2 = 1 - 1 / (gamma * gamma);
+    auto beta_gamma2 = gamma * gamma * beta2;
+    auto velocity = std::sqrt(beta2) * c_light;
+    auto momentum = particle->GetTotalMomentum();
+
+    // Maximum energy transfer to a single electron
+    double max_transfer = NAN;
+    if(particle->GetDefinition() == G4Electron::Definition()) {
+        max_transfer = kinetic_energy / 2;
+    } else if(particle->GetDefinition() == G4Positron::Definition()) {
+        max_transfer = kinetic_energy;
+    } else {
+        auto ratio = electron_mass_c2 / mass;
+        max_transfer = 2 * electron_mass_c2 * beta_gamma2 / (1 + 2 * gamma * ratio + ratio * ratio);
+    }
+    auto cutoff = std::min(delta_ray_cutoff_, max_transfer);
+
+    // Parameters of the energy loss distribution in the sensor material
+    const auto* material = fast_track.GetEnvelopeLogicalVolume()->GetMaterial();
+    auto* ionisation = material->GetIonisation();
+    auto mean_excitation = ionisation->GetMeanExcitationEnergy();
+    auto charge = particle->GetCharge() / eplus;
+    auto xi = twopi_mc2_rcl2 * material->GetElectronDensity() * charge * charge * length / beta2;
+    auto density_correction = ionisation->DensityCorrection(0.5 * std::log10(beta_gamma2));
+    auto most_probable = xi * (std::log(2 * electron_mass_c2 * beta_gamma2 / mean_excitation) +
+                               std::log(xi / mean_excitation) + 0.200 - beta2 - density_correction);
+
+    // Sample the restricted energy loss along the path
+    auto lambda = sample_landau(landau_most_probable + cutoff / xi);
+    auto energy_loss = std::max(0.0, most_probable + xi * (lambda - landau_most_probable));
+
+    // Create delta rays above the cutoff, uniformly distributed along the path
+    auto delta_rays = (cutoff < max_transfer ? G4Poisson(xi * (1 / cutoff - 1 / max_transfer)) : 0);
+    double delta_ray_energy = 0;
+    fast_step.SetNumberOfSecondaryTracks(static_cast<G4int>(delta_rays));
+    for(long i = 0; i < delta_rays; ++i) {
+        auto energy = cutoff * max_transfer / (max_transfer - G4UniformRand() * (max_transfer - cutoff));
+        auto distance = G4UniformRand() * length;
+
+        // Emission angle from the kinematics of the collision with a free electron
+        auto delta_momentum = std::sqrt(energy * (energy + 2 * electron_mass_c2));
+        auto cos_theta =
+            std::min(1.0, energy * (particle->GetTotalEnergy() + electron_mass_c2) / (delta_momentum * momentum));
+        auto sin_theta = std::sqrt(1 - cos_theta * cos_theta);
+        auto phi = twopi * G4UniformRand();
+        G4ThreeVector delta_direction(sin_theta * std::cos(phi), sin_theta * std::sin(phi), cos_theta);
+        delta_direction.rotateUz(direction);
+
+        fast_step.CreateSecondaryTrack(G4DynamicParticle(G4Electron::Definition(), delta_direction, energy),
+                                       entry + distance * direction,
+                                       track->GetGlobalTime() + distance / velocity,
+                                       false);
+        delta_ray_energy += energy;
+    }
+
+    // Distribute the energy loss over the segments of the path with exponentially distributed weights
+    auto segments = std::max(1, static_cast<int>(std::ceil(length / segment_length_)));
+    auto step = length / segments;
+    std::vector<double> weights(static_cast<size_t>(segments));
+    double total_weight = 0;
+    for(auto& weight : weights) {
+        weight = -std::log(G4UniformRand());
+        total_weight += weight;
+    }
+    for(size_t i = 0; i < weights.size(); ++i) {
+        auto begin = entry + static_cast<double>(i) * step * direction;
+        auto end = begin + step * direction;
+        auto time = track->GetGlobalTime() + (static_cast<double>(i) + 0.5) * step / velocity;
+        sensor_->addDeposit(track, begin, end, (begin + end) / 2, time, energy_loss * weights[i] / total_weight);
+    }
+
+    LOG(DEBUG) << "Deposited " << Units::display(energy_loss, {"keV", "MeV"}) << " along "
+               << Units::display(length, {"um", "mm"}) << " in " << sensor_->getName() << " with " << delta_rays
+               << " delta rays above " << Units::display(cutoff, {"keV", "MeV"});
+
+    // Move the particle to the exit of the sensor, the deposits are handled above and not reported to Geant4
+    fast_step.ProposePrimaryTrackFinalPosition(exit, false);
+    fast_step.ProposePrimaryTrackFinalTime(track->GetGlobalTime() + length / velocity);
+    fast_step.ProposePrimaryTrackPathLength(length);
+    auto final_energy = kinetic_energy - energy_loss - delta_ray_energy;
+    if(final_energy > 0) {
+        fast_step.ProposePrimaryTrackFinalKineticEnergy(final_energy);
+    } else {
+        fast_step.ProposePrimaryTrackFinalKineticEnergy(0);
+        fast_step.KillPrimaryTrack();
+    }
+}
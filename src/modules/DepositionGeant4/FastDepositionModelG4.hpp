@@ -0,0 +1,87 @@
+/**
+ * @file
+ * @brief Defines a parametrised fast simulation of the energy deposition of minimum ionizing particles in the sensors
+ * @copyright Copyright (c) 2017-2020 CERN and the Allpix Squared authors.
+ * This software is distributed under the terms of the MIT License, copied verbatim in the file "LICENSE.md".
+ * In applying this license, CERN does not waive the privileges and immunities granted to it by virtue of its status as an
+ * Intergovernmental Organization or submit itself to any jurisdiction.
+ */
+
+#ifndef ALLPIX_SIMPLE_DEPOSITION_MODULE_FAST_DEPOSITION_MODEL_H
+#define ALLPIX_SIMPLE_DEPOSITION_MODULE_FAST_DEPOSITION_MODEL_H
+
+#include <vector>
+
+#include <G4FastStep.hh>
+#include <G4FastTrack.hh>
+#include <G4ParticleDefinition.hh>
+#include <G4Region.hh>
+#include <G4VFastSimulationModel.hh>
+
+#include "SensitiveDetectorActionG4.hpp"
+
+namespace allpix {
+    /**
+     * @brief Deposits the energy of fast charged particles along their straight path through a sensor
+     *
+     * Instead of tracking the particle through the sensor in small steps, the restricted energy loss along the full path is
+     * sampled from a Landau distribution, with its most probable value and width given by the thin-absorber approximation
+     * of Bichsel. The energy loss is distributed over segments of the path and handed to the sensitive detector. Delta rays
+     * above a cutoff energy are created as secondary electrons and are simulated in full by Geant4. The particle leaves the
+     * sensor without change of direction.
+     */
+    class FastDepositionModelG4 : public G4VFastSimulationModel {
+    public:
+        /**
+         * @brief Constructs the model and attaches it to the region of a sensor
+         * @param region Region of the sensor to attach the model to
+         * @param sensor Sensitive detector action of the sensor to hand the deposits to
+         * @param energy_threshold Minimum kinetic energy of the particles handled by the model
+         * @param delta_ray_cutoff Minimum kinetic energy of delta rays to be simulated by Geant4
+         * @param segment_length Length of the path segments the energy is deposited in
+         */
+        FastDepositionModelG4(G4Region* region,
+                              SensitiveDetectorActionG4* sensor,
+                              double energy_threshold,
+                              double delta_ray_cutoff,
+                              double segment_length);
+
+        /**
+         * @brief Check if the model can handle a particle type, which is true for all charged particles except ions
+         * @param particle Definition of the particle
+         */
+        G4bool IsApplicable(const G4ParticleDefinition& particle) override;
+
+        /**
+         * @brief Check if the model should be applied to a track, based on its kinetic energy
+         * @param fast_track Track inside the sensor
+         */
+        G4bool ModelTrigger(const G4FastTrack& fast_track) override;
+
+        /**
+         * @brief Deposit the energy along the path of the track and move it to the exit of the sensor
+         * @param fast_track Track inside the sensor
+         * @param fast_step Final state of the track and created delta rays
+         */
+        void DoIt(const G4FastTrack& fast_track, G4FastStep& fast_step) override;
+
+    private:
+        /**
+         * @brief Sample the reduced variable of the Landau distribution
+         * @param maximum Maximum value to sample
+         * @return Random value distributed according to the Landau distribution, truncated at the maximum
+         */
+        double sample_landau(double maximum) const;
+
+        SensitiveDetectorActionG4* sensor_;
+
+        double energy_threshold_;
+        double delta_ray_cutoff_;
+        double segment_length_;
+
+        // Quantiles of the Landau distribution for equidistant probabilities
+        std::vector<double> landau_table_;
+    };
+} // namespace allpix
+
+#endif /* ALLPIX_SIMPLE_DEPOSITION_MODULE_FAST_DEPOSITION_MODEL_H */
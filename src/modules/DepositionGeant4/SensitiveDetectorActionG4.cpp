@@ -11,6 +11,7 @@
 #include "SensitiveDetectorActionG4.hpp"
 #include "TrackInfoG4.hpp"
 
+#include <cmath>
 #include <memory>
 
 #include "G4DecayTable.hh"
@@ -40,10 +41,11 @@ SensitiveDetectorActionG4::SensitiveDetectorActionG4(Module* module,
                                                      double charge_creation_energy,
                                                      double fano_factor,
                                                      double cutoff_time,
-                                                     uint64_t random_seed)
+                                                     uint64_t random_seed,
+                                                     double voxel_size)
     : G4VSensitiveDetector("SensitiveDetector_" + detector->getName()), module_(module), detector_(detector),
       messenger_(msg), track_info_manager_(track_info_manager), charge_creation_energy_(charge_creation_energy),
-      fano_factor_(fano_factor), cutoff_time_(cutoff_time) {
+      fano_factor_(fano_factor), cutoff_time_(cutoff_time), voxel_size_(voxel_size) {
 
     // Add the sensor to the internal sensitive detector manager
     G4SDManager* sd_man_g4 = G4SDManager::GetSDMpointer();
@@ -70,27 +72,47 @@ G4bool SensitiveDetectorActionG4::ProcessHits(G4Step* step, G4TouchableHistory*)
     G4ThreeVector step_pos = is_photon ? postStep->GetPosition() : (preStep->GetPosition() + postStep->GetPosition()) / 2;
     double step_time = is_photon ? postStep->GetGlobalTime() : (preStep->GetGlobalTime() + postStep->GetGlobalTime()) / 2;
 
-    // If this arrives very late, skip MCParticle and DepositedCharge creation:
-    if(step_time > cutoff_time_) {
+    if(!addDeposit(step->GetTrack(), preStep->GetPosition(), postStep->GetPosition(), step_pos, step_time, edep)) {
         return false;
     }
 
-    // Calculate the charge deposit at a local position
+    // Compare the local position to the transformation of Geant4
     auto deposit_position = detector_->getLocalPosition(static_cast<ROOT::Math::XYZPoint>(step_pos));
     auto deposit_position_g4 = theTouchable->GetHistory()->GetTopTransform().TransformPoint(step_pos);
+    auto deposit_position_g4loc =
+        ROOT::Math::XYZPoint(deposit_position_g4.x() + detector_->getModel()->getSensorCenter().x(),
+                             deposit_position_g4.y() + detector_->getModel()->getSensorCenter().y(),
+                             deposit_position_g4.z() + detector_->getModel()->getSensorCenter().z());
+
+    LOG(DEBUG) << "Geant4 transformation to local: " << Units::display(deposit_position_g4loc, {"mm", "um"});
+    if((deposit_position_g4loc - deposit_position).mag2() > 0.001) {
+        LOG(ERROR) << "Difference G4 to internal: "
+                   << Units::display((deposit_position_g4loc - deposit_position), {"mm", "um"});
+    }
+    return true;
+}
+
+bool SensitiveDetectorActionG4::addDeposit(const G4Track* track,
+                                           const G4ThreeVector& begin,
+                                           const G4ThreeVector& end,
+                                           const G4ThreeVector& position,
+                                           double time,
+                                           double energy) {
+    // If this arrives very late, skip MCParticle and DepositedCharge creation:
+    if(time > cutoff_time_) {
+        return false;
+    }
+
+    // Calculate the charge deposit at a local position
+    auto deposit_position = detector_->getLocalPosition(static_cast<ROOT::Math::XYZPoint>(position));
 
     // Calculate number of electron hole pairs produced, taking into account fluctuations between ionization and lattice
     // excitations via the Fano factor. We assume Gaussian statistics here.
-    auto mean_charge = edep / charge_creation_energy_;
+    auto mean_charge = energy / charge_creation_energy_;
     std::normal_distribution<double> charge_fluctuation(mean_charge, std::sqrt(mean_charge * fano_factor_));
     auto charge = static_cast<unsigned int>(charge_fluctuation(random_generator_));
 
-    auto deposit_position_g4loc =
-        ROOT::Math::XYZPoint(deposit_position_g4.x() + detector_->getModel()->getSensorCenter().x(),
-                             deposit_position_g4.y() + detector_->getModel()->getSensorCenter().y(),
-                             deposit_position_g4.z() + detector_->getModel()->getSensorCenter().z());
-
-    const auto* userTrackInfo = dynamic_cast<TrackInfoG4*>(step->GetTrack()->GetUserInformation());
+    const auto* userTrackInfo = dynamic_cast<TrackInfoG4*>(track->GetUserInformation());
     if(userTrackInfo == nullptr) {
         throw ModuleError("No track information attached to track.");
     }
@@ -100,15 +122,15 @@ G4bool SensitiveDetectorActionG4::ProcessHits(G4Step* step, G4TouchableHistory*)
     // Save begin point when track is seen for the first time
     if(track_begin_.find(trackID) == track_begin_.end()) {
         track_info_manager_->setTrackInfoToBeStored(trackID);
-        auto start_position = detector_->getLocalPosition(static_cast<ROOT::Math::XYZPoint>(preStep->GetPosition()));
+        auto start_position = detector_->getLocalPosition(static_cast<ROOT::Math::XYZPoint>(begin));
         track_begin_.emplace(trackID, start_position);
         track_parents_.emplace(trackID, parentTrackID);
-        track_time_.emplace(trackID, step_time);
-        track_pdg_.emplace(trackID, step->GetTrack()->GetDynamicParticle()->GetPDGcode());
+        track_time_.emplace(trackID, time);
+        track_pdg_.emplace(trackID, track->GetDynamicParticle()->GetPDGcode());
     }
 
     // Update current end point with the current last step
-    auto end_position = detector_->getLocalPosition(static_cast<ROOT::Math::XYZPoint>(postStep->GetPosition()));
+    auto end_position = detector_->getLocalPosition(static_cast<ROOT::Math::XYZPoint>(end));
     track_end_[trackID] = end_position;
 
     // Add new deposit if the charge is more than zero
@@ -116,17 +138,36 @@ G4bool SensitiveDetectorActionG4::ProcessHits(G4Step* step, G4TouchableHistory*)
         return false;
     }
 
-    // Store relevant quantities to create charge deposits:
-    deposit_position_.push_back(deposit_position);
-    deposit_charge_.push_back(charge);
-    deposit_time_.push_back(step_time);
-    deposit_to_id_.push_back(trackID);
+    // Merge with the previous deposit if it stems from the same track and lies in the same voxel
+    bool merged = false;
+    if(voxel_size_ > 0) {
+        std::array<long, 3> voxel{{static_cast<long>(std::floor(deposit_position.x() / voxel_size_)),
+                                   static_cast<long>(std::floor(deposit_position.y() / voxel_size_)),
+                                   static_cast<long>(std::floor(deposit_position.z() / voxel_size_))}};
+        if(!deposit_to_id_.empty() && deposit_to_id_.back() == trackID && voxel == last_voxel_) {
+            // Place the merged deposit at the charge-weighted mean position and time
+            auto previous_weight = static_cast<double>(deposit_charge_.back()) / (deposit_charge_.back() + charge);
+            auto weight = 1.0 - previous_weight;
+            auto& merged_position = deposit_position_.back();
+            merged_position.SetXYZ(previous_weight * merged_position.x() + weight * deposit_position.x(),
+                                   previous_weight * merged_position.y() + weight * deposit_position.y(),
+                                   previous_weight * merged_position.z() + weight * deposit_position.z());
+            deposit_time_.back() = previous_weight * deposit_time_.back() + weight * time;
+            deposit_charge_.back() += charge;
+            merged = true;
+            LOG(TRACE) << "Merged step with previous deposit of track " << trackID;
+        }
+        last_voxel_ = voxel;
+    }
 
-    LOG(DEBUG) << "Geant4 transformation to local: " << Units::display(deposit_position_g4loc, {"mm", "um"});
-    if((deposit_position_g4loc - deposit_position).mag2() > 0.001) {
-        LOG(ERROR) << "Difference G4 to internal: "
-                   << Units::display((deposit_position_g4loc - deposit_position), {"mm", "um"});
+    // Store relevant quantities to create charge deposits:
+    if(!merged) {
+        deposit_position_.push_back(deposit_position);
+        deposit_charge_.push_back(charge);
+        deposit_time_.push_back(time);
+        deposit_to_id_.push_back(trackID);
     }
+
     return true;
 }
 
@@ -134,6 +175,18 @@ std::string SensitiveDetectorActionG4::getName() const {
     return detector_->getName();
 }
 
+void SensitiveDetectorActionG4::setRandomSeed(uint64_t random_seed) {
+    random_generator_.seed(random_seed);
+}
+
+void SensitiveDetectorActionG4::saveState(std::ostream& state) const {
+    state << random_generator_ << " " << total_deposited_charge_ << " ";
+}
+
+void SensitiveDetectorActionG4::loadState(std::istream& state) {
+    state >> random_generator_ >> total_deposited_charge_;
+}
+
 unsigned int SensitiveDetectorActionG4::getTotalDepositedCharge() const {
     return total_deposited_charge_;
 }
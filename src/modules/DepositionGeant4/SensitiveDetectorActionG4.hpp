@@ -10,8 +10,13 @@
 #ifndef ALLPIX_SIMPLE_DEPOSITION_MODULE_SENSITIVE_DETECTOR_ACTION_H
 #define ALLPIX_SIMPLE_DEPOSITION_MODULE_SENSITIVE_DETECTOR_ACTION_H
 
+#include <array>
+#include <istream>
 #include <memory>
+#include <ostream>
 
+#include <G4ThreeVector.hh>
+#include <G4Track.hh>
 #include <G4VSensitiveDetector.hh>
 #include <G4WrapperProcess.hh>
 
@@ -37,6 +42,7 @@ namespace allpix {
          * @param charge_creation_energy Energy needed per deposited charge
          * @param fano_factor Fano factor for fluctuations in the energy fraction going into e/h pair creation
          * @param random_seed Seed for the random number generator for Fano fluctuations
+         * @param voxel_size Size of the voxels in which consecutive steps of a track are merged, zero to disable merging
          */
         SensitiveDetectorActionG4(Module* module,
                                   const std::shared_ptr<Detector>& detector,
@@ -45,7 +51,26 @@ namespace allpix {
                                   double charge_creation_energy,
                                   double fano_factor,
                                   double cutoff_time,
-                                  uint64_t random_seed);
+                                  uint64_t random_seed,
+                                  double voxel_size = 0);
+
+        /**
+         * @brief Reseed the random number generator for Fano fluctuations
+         * @param random_seed Seed for the random number generator
+         */
+        void setRandomSeed(uint64_t random_seed);
+
+        /**
+         * @brief Store the state of the random number generator and the total deposited charge
+         * @param state Stream to write the state to
+         */
+        void saveState(std::ostream& state) const;
+
+        /**
+         * @brief Restore the state of the random number generator and the total deposited charge
+         * @param state Stream to read the state from
+         */
+        void loadState(std::istream& state);
 
         /**
          * @brief Get total number of charges deposited in the sensitive device bound to this action
@@ -71,6 +96,26 @@ namespace allpix {
          */
         G4bool ProcessHits(G4Step* step, G4TouchableHistory* history) override;
 
+        /**
+         * @brief Add an energy deposit of a track to this sensor
+         * @param track Track depositing the energy
+         * @param begin Global position where the track segment begins
+         * @param end Global position where the track segment ends
+         * @param position Global position of the deposit
+         * @param time Global time of the deposit
+         * @param energy Deposited energy
+         * @return True if charge carriers have been deposited, false otherwise
+         *
+         * Used for every step of the full simulation, and by \ref FastDepositionModelG4 for the segments of a track which
+         * is not tracked by Geant4 inside the sensor.
+         */
+        bool addDeposit(const G4Track* track,
+                        const G4ThreeVector& begin,
+                        const G4ThreeVector& end,
+                        const G4ThreeVector& position,
+                        double time,
+                        double energy);
+
         /**
          * @brief Send the MCParticle and DepositedCharge messages
          */
@@ -87,6 +132,10 @@ namespace allpix {
         double charge_creation_energy_;
         double fano_factor_;
         double cutoff_time_;
+        double voxel_size_;
+
+        // Voxel of the last deposit, to merge consecutive steps of the same track
+        std::array<long, 3> last_voxel_{};
 
         // Random number generator for e/h pair creation fluctuation
         std::mt19937_64 random_generator_;
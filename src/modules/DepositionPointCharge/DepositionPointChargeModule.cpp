@@ -113,6 +113,8 @@ void DepositionPointChargeModule::init() {
 }
 
 void DepositionPointChargeModule::run(unsigned int event) {
+    // Seed the random generators for this event if requested
+    seed_event(random_generator_, event);
 
     ROOT::Math::XYZPoint position;
     auto model = detector_->getModel();
@@ -237,3 +239,11 @@ void DepositionPointChargeModule::DepositLine(const ROOT::Math::XYZPoint& positi
     auto deposit_message = std::make_shared<DepositedChargeMessage>(std::move(charges), detector_);
     messenger_->dispatchMessage(this, deposit_message);
 }
+
+void DepositionPointChargeModule::saveState(std::ostream& state) {
+    state << random_generator_;
+}
+
+void DepositionPointChargeModule::loadState(std::istream& state) {
+    state >> random_generator_;
+}
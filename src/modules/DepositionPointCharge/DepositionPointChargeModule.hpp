@@ -57,6 +57,16 @@ namespace allpix {
          */
         void init() override;
 
+        /**
+         * @brief Store the state of the random number generator in a checkpoint
+         */
+        void saveState(std::ostream& state) override;
+
+        /**
+         * @brief Restore the state of the random number generator from a checkpoint
+         */
+        void loadState(std::istream& state) override;
+
     private:
         /**
          * @brief Helper function to deposit charges at a single point
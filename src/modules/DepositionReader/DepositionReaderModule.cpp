@@ -11,6 +11,7 @@
 #include "DepositionReaderModule.hpp"
 
 #include <string>
+#include <tuple>
 #include <utility>
 
 #include "core/utils/log.h"
@@ -31,6 +32,7 @@ DepositionReaderModule::DepositionReaderModule(Configuration& config, Messenger*
     config_.setDefault<std::string>("unit_energy", "MeV");
     config_.setDefault<bool>("assign_timestamps", true);
     config_.setDefault<bool>("create_mcparticles", true);
+    config_.setDefault<bool>("assign_by_position", false);
 
     config_.setDefaultArray<std::string>("branch_names",
                                          {"event",
@@ -51,6 +53,7 @@ DepositionReaderModule::DepositionReaderModule(Configuration& config, Messenger*
     charge_creation_energy_ = config_.get<double>("charge_creation_energy");
     fano_factor_ = config_.get<double>("fano_factor");
     volume_chars_ = config_.get<size_t>("detector_name_chars");
+    assign_by_position_ = config_.get<bool>("assign_by_position");
 
     unit_length_ = config_.get<std::string>("unit_length");
     unit_time_ = config_.get<std::string>("unit_time");
@@ -69,6 +72,9 @@ void DepositionReaderModule::init() {
         LOG(WARNING) << "No MCParticle objects will be produced";
     }
 
+    // Events before the first event of the run are skipped
+    auto first_event = getConfigManager()->getGlobalConfiguration().get<unsigned int>("first_event");
+
     // Check which file type we want to read:
     file_model_ = config_.get<std::string>("model");
     std::transform(file_model_.begin(), file_model_.end(), file_model_.begin(), ::tolower);
@@ -79,6 +85,23 @@ void DepositionReaderModule::init() {
         if(!input_file_->is_open()) {
             throw InvalidValueError(config_, "file_name", "could not open input file");
         }
+
+        // Consume all lines up to the header of the first event, event numbers in the file start at zero
+        if(first_event > 1) {
+            std::string line, tmp;
+            unsigned int event_read = 0;
+            while(std::getline(*input_file_, line)) {
+                line = allpix::trim(line);
+                if(!line.empty() && line.front() == 'E') {
+                    std::stringstream lse(line);
+                    lse >> tmp >> event_read;
+                    if(event_read + 1 >= first_event) {
+                        break;
+                    }
+                }
+            }
+            LOG(INFO) << "Skipped input file to event " << first_event;
+        }
     } else if(file_model_ == "root") {
         auto file_path = config_.getPathWithExtension("file_name", "root", true);
         input_file_root_ = std::make_unique<TFile>(file_path.c_str(), "READ");
@@ -164,6 +187,23 @@ void DepositionReaderModule::init() {
             check_tree_reader(parent_id_);
         }
 
+        // Seek the first entry of the first event, entries are ordered by event number such that a bisection suffices
+        if(first_event > 1) {
+            Long64_t lower = 0;
+            Long64_t upper = tree_reader_->GetEntries(false);
+            while(lower < upper) {
+                auto middle = lower + (upper - lower) / 2;
+                tree_reader_->SetEntry(middle);
+                if(static_cast<unsigned int>(*event_->Get()) + 1 < first_event) {
+                    lower = middle + 1;
+                } else {
+                    upper = middle;
+                }
+            }
+            tree_reader_->SetEntry(lower);
+            LOG(INFO) << "Skipped " << lower << " tree entries to event " << first_event;
+        }
+
     } else {
         throw InvalidValueError(config_, "model", "only models 'root' and 'csv' are currently supported");
     }
@@ -198,6 +238,8 @@ template <typename T> void DepositionReaderModule::check_tree_reader(std::shared
 }
 
 void DepositionReaderModule::run(unsigned int event) {
+    // Seed the random generators for this event if requested
+    seed_event(random_generator_, event);
 
     // Set of deposited charges in this event
     std::map<std::shared_ptr<Detector>, std::vector<ROOT::Math::XYZPoint>> deposit_position;
@@ -239,24 +281,31 @@ void DepositionReaderModule::run(unsigned int event) {
             break;
         }
 
-        auto detectors = geo_manager_->getDetectors();
-        auto pos = std::find_if(detectors.begin(), detectors.end(), [volume](const std::shared_ptr<Detector>& d) {
-            return d->getName() == volume;
-        });
-        if(pos == detectors.end()) {
+        // Assign detector from the volume name, or from the position if the volume does not name a detector
+        std::shared_ptr<Detector> detector;
+        ROOT::Math::XYZPoint local_position;
+        if(geo_manager_->hasDetector(volume)) {
+            detector = geo_manager_->getDetector(volume);
+            LOG(DEBUG) << "Found detector \"" << detector->getName() << "\"";
+
+            local_position = detector->getLocalPosition(global_position);
+            if(!detector->isWithinSensor(local_position)) {
+                LOG(WARNING) << "Found deposition outside sensor at " << Units::display(local_position, {"mm", "um"})
+                             << ", global " << Units::display(global_position, {"mm", "um"}) << ". Skipping.";
+                continue;
+            }
+        } else if(assign_by_position_) {
+            std::tie(detector, local_position) = geo_manager_->findDetector(global_position);
+            if(detector == nullptr) {
+                LOG(TRACE) << "Ignored deposition at " << Units::display(global_position, {"mm", "um"})
+                           << ", not inside the sensor of any detector";
+                continue;
+            }
+            LOG(DEBUG) << "Found detector \"" << detector->getName() << "\" from position of deposition";
+        } else {
             LOG(TRACE) << "Ignored detector \"" << volume << "\", not found in current simulation";
             continue;
         }
-        // Assign detector
-        auto detector = (*pos);
-        LOG(DEBUG) << "Found detector \"" << detector->getName() << "\"";
-
-        auto local_position = detector->getLocalPosition(global_position);
-        if(!detector->isWithinSensor(local_position)) {
-            LOG(WARNING) << "Found deposition outside sensor at " << Units::display(local_position, {"mm", "um"})
-                         << ", global " << Units::display(global_position, {"mm", "um"}) << ". Skipping.";
-            continue;
-        }
 
         // Calculate number of electron hole pairs produced, taking into account fluctuations between ionization and lattice
         // excitations via the Fano factor. We assume Gaussian statistics here.
@@ -526,3 +575,32 @@ bool DepositionReaderModule::read_csv(unsigned int event_num,
 
     return true;
 }
+
+void DepositionReaderModule::saveState(std::ostream& state) {
+    // The position is stored as offset in the CSV file or as entry of the tree, -1 denotes the end of the input
+    long long position = -1;
+    if(file_model_ == "csv") {
+        if(input_file_->good()) {
+            position = static_cast<long long>(input_file_->tellg());
+        }
+    } else if(tree_reader_->GetEntryStatus() == TTreeReader::kEntryValid) {
+        position = tree_reader_->GetCurrentEntry();
+    }
+    state << position << " " << random_generator_;
+}
+
+void DepositionReaderModule::loadState(std::istream& state) {
+    long long position = -1;
+    state >> position >> random_generator_;
+
+    if(file_model_ == "csv") {
+        if(position < 0) {
+            input_file_->seekg(0, std::ios::end);
+        } else {
+            input_file_->seekg(position);
+        }
+    } else {
+        tree_reader_->SetEntry(position < 0 ? tree_reader_->GetEntries(false) : position);
+    }
+    LOG(DEBUG) << "Continuing to read input file at position " << position;
+}
@@ -61,6 +61,16 @@ namespace allpix {
          */
         void finalize() override;
 
+        /**
+         * @brief Store the position in the input file and the state of the random number generator in a checkpoint
+         */
+        void saveState(std::ostream& state) override;
+
+        /**
+         * @brief Restore the position in the input file and the state of the random number generator from a checkpoint
+         */
+        void loadState(std::istream& state) override;
+
     private:
         // General module members
         GeometryManager* geo_manager_;
@@ -93,7 +103,7 @@ namespace allpix {
         size_t volume_chars_{};
         std::string unit_length_{}, unit_time_{}, unit_energy_{};
 
-        bool create_mcparticles_{}, time_available_{};
+        bool create_mcparticles_{}, time_available_{}, assign_by_position_{};
 
         bool read_csv(unsigned int event_num,
                       std::string& volume,
@@ -11,6 +11,7 @@
 
 #include <algorithm>
 #include <memory>
+#include <numeric>
 #include <string>
 #include <utility>
 
@@ -26,6 +27,9 @@ DetectorHistogrammerModule::DetectorHistogrammerModule(Configuration& config,
                                                        Messenger* messenger,
                                                        std::shared_ptr<Detector> detector)
     : Module(config, detector), detector_(std::move(detector)), pixels_message_(nullptr) {
+    // Enable parallelization of this module if multithreading is enabled
+    enable_parallelization();
+
     // Bind messages
     messenger->bindSingle(this, &DetectorHistogrammerModule::pixels_message_);
     messenger->bindSingle(this, &DetectorHistogrammerModule::mcparticle_message_, MsgFlags::REQUIRED);
@@ -50,6 +54,9 @@ void DetectorHistogrammerModule::init() {
     auto xpixels = static_cast<int>(model->getNPixels().x());
     auto ypixels = static_cast<int>(model->getNPixels().y());
 
+    // Allocate the pixel grid used for clustering
+    pixel_grid_.assign(model->getNPixels().x() * model->getNPixels().y(), 0);
+
     // Create histogram of hitmap
     LOG(TRACE) << "Creating histograms";
     std::string hit_map_title = "Hitmap for " + detector_->getName() + ";x (pixels);y (pixels);hits";
@@ -239,7 +246,10 @@ void DetectorHistogrammerModule::init() {
         new TH1D("total_charge", total_charge_title.c_str(), 1000, 0., static_cast<double>(max_cluster_charge * 4));
 }
 
-void DetectorHistogrammerModule::run(unsigned int) {
+void DetectorHistogrammerModule::run(unsigned int event_num) {
+    // Seed the random generators for this event if requested
+    seed_event(random_generator_, event_num);
+
     using namespace ROOT::Math;
 
     // Check that we actually received pixel hits - we might have none and just received MCParticles!
@@ -512,57 +522,80 @@ void DetectorHistogrammerModule::finalize() {
     total_charge->Write();
 }
 
+/**
+ * Adjacent pixel hits, including diagonal neighbors, are joined with a union-find over the indices of the hits. The hits are
+ * marked on a dense grid of all pixels to find their neighbors in constant time. The root of every set is its first hit,
+ * such that the clusters are created in the order of their first hit, which is also used as seed.
+ */
 std::vector<Cluster> DetectorHistogrammerModule::doClustering() {
     std::vector<Cluster> clusters;
-    std::map<const PixelHit*, bool> usedPixel;
 
     if(pixels_message_ == nullptr) {
         return clusters;
     }
 
-    auto pixel_it = pixels_message_->getData().begin();
-    for(; pixel_it != pixels_message_->getData().end(); pixel_it++) {
-        const PixelHit* pixel_hit = &(*pixel_it);
+    const auto& pixel_hits = pixels_message_->getData();
+    auto npixels = detector_->getModel()->getNPixels();
 
-        // Check if the pixel has been used:
-        if(usedPixel[pixel_hit]) {
-            continue;
+    // Union-find with path halving, keeping the lower hit index as root
+    std::vector<size_t> parent(pixel_hits.size());
+    std::iota(parent.begin(), parent.end(), 0);
+    auto find = [&](size_t idx) {
+        while(parent[idx] != idx) {
+            parent[idx] = parent[parent[idx]];
+            idx = parent[idx];
         }
+        return idx;
+    };
+    auto unite = [&](size_t lhs, size_t rhs) {
+        lhs = find(lhs);
+        rhs = find(rhs);
+        if(lhs < rhs) {
+            parent[rhs] = lhs;
+        } else if(rhs < lhs) {
+            parent[lhs] = rhs;
+        }
+    };
 
-        // Create new cluster
-        Cluster cluster(pixel_hit);
-        usedPixel[pixel_hit] = true;
-        LOG(TRACE) << "Creating new cluster with seed: " << pixel_hit->getPixel().getIndex();
-
-        auto touching = [&](const PixelHit* pixel) {
-            auto pxi1 = pixel->getIndex();
-            for(const auto& cluster_pixel : cluster.getPixelHits()) {
-
-                auto distance = [](unsigned int lhs, unsigned int rhs) { return (lhs > rhs ? lhs - rhs : rhs - lhs); };
+    // Mark all hits on the pixel grid and join them with the already marked hits around them
+    for(size_t idx = 0; idx < pixel_hits.size(); ++idx) {
+        auto pixel_idx = pixel_hits[idx].getIndex();
+        if(pixel_idx.x() >= npixels.x() || pixel_idx.y() >= npixels.y()) {
+            continue;
+        }
 
-                auto pxi2 = cluster_pixel->getIndex();
-                if(distance(pxi1.x(), pxi2.x()) <= 1 && distance(pxi1.y(), pxi2.y()) <= 1) {
-                    return true;
+        for(unsigned int y = (pixel_idx.y() > 0 ? pixel_idx.y() - 1 : 0); y <= pixel_idx.y() + 1 && y < npixels.y(); ++y) {
+            for(unsigned int x = (pixel_idx.x() > 0 ? pixel_idx.x() - 1 : 0); x <= pixel_idx.x() + 1 && x < npixels.x();
+                ++x) {
+                auto neighbor = pixel_grid_[y * npixels.x() + x];
+                if(neighbor != 0) {
+                    unite(idx, neighbor - 1);
                 }
             }
-            return false;
-        };
-
-        // Keep adding pixels to the cluster:
-        for(auto other_pixel = pixel_it + 1; other_pixel != pixels_message_->getData().end(); other_pixel++) {
-            const PixelHit* neighbor = &(*other_pixel);
+        }
+        pixel_grid_[pixel_idx.y() * npixels.x() + pixel_idx.x()] = idx + 1;
+    }
 
-            // Check if neighbor has been used or if it touches the current cluster:
-            if(usedPixel[neighbor] || !touching(neighbor)) {
-                continue;
-            }
+    // Clear the pixel grid for the next event
+    for(const auto& pixel_hit : pixel_hits) {
+        auto pixel_idx = pixel_hit.getIndex();
+        if(pixel_idx.x() < npixels.x() && pixel_idx.y() < npixels.y()) {
+            pixel_grid_[pixel_idx.y() * npixels.x() + pixel_idx.x()] = 0;
+        }
+    }
 
-            cluster.addPixelHit(neighbor);
-            LOG(TRACE) << "Adding pixel: " << neighbor->getPixel().getIndex();
-            usedPixel[neighbor] = true;
-            other_pixel = pixel_it;
+    // Create the clusters from the sets of joined hits
+    std::vector<size_t> cluster_idx(pixel_hits.size());
+    for(size_t idx = 0; idx < pixel_hits.size(); ++idx) {
+        auto root = find(idx);
+        if(root == idx) {
+            LOG(TRACE) << "Creating new cluster with seed: " << pixel_hits[idx].getPixel().getIndex();
+            cluster_idx[idx] = clusters.size();
+            clusters.emplace_back(&pixel_hits[idx]);
+        } else {
+            LOG(TRACE) << "Adding pixel: " << pixel_hits[idx].getPixel().getIndex();
+            clusters[cluster_idx[root]].addPixelHit(&pixel_hits[idx]);
         }
-        clusters.push_back(cluster);
     }
     return clusters;
 }
@@ -586,3 +619,11 @@ std::vector<const MCParticle*> DetectorHistogrammerModule::getPrimaryParticles()
 
     return primaries;
 }
+
+void DetectorHistogrammerModule::saveState(std::ostream& state) {
+    state << random_generator_;
+}
+
+void DetectorHistogrammerModule::loadState(std::istream& state) {
+    state >> random_generator_;
+}
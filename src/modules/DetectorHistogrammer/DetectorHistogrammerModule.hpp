@@ -60,9 +60,19 @@ namespace allpix {
          */
         void finalize() override;
 
+        /**
+         * @brief Store the state of the random number generator in a checkpoint
+         */
+        void saveState(std::ostream& state) override;
+
+        /**
+         * @brief Restore the state of the random number generator from a checkpoint
+         */
+        void loadState(std::istream& state) override;
+
     private:
         /**
-         * @brief Perform a sparse clustering on the PixelHits
+         * @brief Perform a clustering of adjacent PixelHits
          */
         std::vector<Cluster> doClustering();
 
@@ -89,6 +99,9 @@ namespace allpix {
         ROOT::Math::XYVector track_resolution_{};
         std::mt19937_64 random_generator_;
 
+        // Index of the pixel hit plus one for every pixel of the detector, zero if not hit
+        std::vector<size_t> pixel_grid_;
+
         // Histograms to output
         TH2D *hit_map, *charge_map, *cluster_map;
         TProfile2D *cluster_size_map, *cluster_size_x_map, *cluster_size_y_map;
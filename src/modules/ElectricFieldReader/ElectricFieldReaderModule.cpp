@@ -29,6 +29,9 @@ using namespace allpix;
 
 ElectricFieldReaderModule::ElectricFieldReaderModule(Configuration& config, Messenger*, std::shared_ptr<Detector> detector)
     : Module(config, detector), detector_(std::move(detector)) {
+    // Enable parallelization of this module if multithreading is enabled
+    enable_parallelization();
+
     // NOTE use voltage as a synonym for bias voltage
     config_.setAlias("bias_voltage", "voltage");
 
@@ -181,6 +184,13 @@ FieldData<double> ElectricFieldReaderModule::read_field(std::pair<double, double
     }
 }
 
+void ElectricFieldReaderModule::finalize() {
+    // Write the output plots to the module file
+    for(auto* plot : output_plots_) {
+        plot->Write();
+    }
+}
+
 void ElectricFieldReaderModule::create_output_plots() {
     LOG(TRACE) << "Creating output plots";
 
@@ -338,12 +348,8 @@ void ElectricFieldReaderModule::create_output_plots() {
         }
     }
 
-    // Write the histograms to module file
-    histogram->Write();
-    histogram_x->Write();
-    histogram_y->Write();
-    histogram_z->Write();
-    histogram1D->Write();
+    // Store the histograms to write them to the module file at the end
+    output_plots_ = {histogram, histogram_x, histogram_y, histogram_z, histogram1D};
 }
 
 /**
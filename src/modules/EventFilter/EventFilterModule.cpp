@@ -0,0 +1,71 @@
+/**
+ * @file
+ * @brief Implementation of module to reject events without sufficient deposited charge
+ * @copyright Copyright (c) 2020 CERN and the Allpix Squared authors.
+ * This software is distributed under the terms of the MIT License, copied verbatim in the file "LICENSE.md".
+ * In applying this license, CERN does not waive the privileges and immunities granted to it by virtue of its status as an
+ * Intergovernmental Organization or submit itself to any jurisdiction.
+ */
+
+#include "EventFilterModule.hpp"
+
+#include <map>
+#include <string>
+#include <utility>
+
+#include "core/utils/log.h"
+
+using namespace allpix;
+
+EventFilterModule::EventFilterModule(Configuration& config, Messenger* messenger, GeometryManager* geo_manager)
+    : Module(config), geo_manager_(geo_manager) {
+    // Events without any deposited charge are rejected, hence the messages are not required
+    messenger->bindMulti(this, &EventFilterModule::messages_);
+
+    config_.setDefault<double>("minimum_deposited_charge", 1);
+    minimum_charge_ = config_.get<double>("minimum_deposited_charge");
+}
+
+void EventFilterModule::init() {
+    if(config_.has("detectors")) {
+        for(auto& name : config_.getArray<std::string>("detectors")) {
+            if(!geo_manager_->hasDetector(name)) {
+                throw InvalidValueError(config_, "detectors", "detector " + name + " is not part of the geometry");
+            }
+            detectors_.insert(name);
+        }
+    }
+}
+
+void EventFilterModule::run(unsigned int event) {
+    // Sum the number of deposited electron-hole pairs per detector
+    std::map<std::string, double> deposited_charge;
+    for(auto& message : messages_) {
+        auto name = message->getDetector()->getName();
+        if(!detectors_.empty() && detectors_.find(name) == detectors_.end()) {
+            continue;
+        }
+        for(auto& charge : message->getData()) {
+            if(charge.getType() == CarrierType::ELECTRON) {
+                deposited_charge[name] += charge.getCharge();
+            }
+        }
+    }
+
+    for(auto& detector_charge : deposited_charge) {
+        if(detector_charge.second >= minimum_charge_) {
+            LOG(DEBUG) << "Accepted event " << event << " with " << Units::display(detector_charge.second, "ke")
+                       << " deposited in detector " << detector_charge.first;
+            ++accepted_events_;
+            return;
+        }
+    }
+
+    ++rejected_events_;
+    throw SkipEventException("No selected detector received a deposited charge of at least " +
+                             Units::display(minimum_charge_, {"e", "ke"}));
+}
+
+void EventFilterModule::finalize() {
+    LOG(STATUS) << "Accepted " << accepted_events_ << " and rejected " << rejected_events_ << " events";
+}
@@ -0,0 +1,69 @@
+/**
+ * @file
+ * @brief Definition of module to reject events without sufficient deposited charge
+ * @copyright Copyright (c) 2020 CERN and the Allpix Squared authors.
+ * This software is distributed under the terms of the MIT License, copied verbatim in the file "LICENSE.md".
+ * In applying this license, CERN does not waive the privileges and immunities granted to it by virtue of its status as an
+ * Intergovernmental Organization or submit itself to any jurisdiction.
+ */
+
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "core/config/Configuration.hpp"
+#include "core/geometry/GeometryManager.hpp"
+#include "core/messenger/Messenger.hpp"
+#include "core/module/Module.hpp"
+
+#include "objects/DepositedCharge.hpp"
+
+namespace allpix {
+    /**
+     * @ingroup Modules
+     * @brief Module to reject events in which the selected detectors received too little deposited charge
+     *
+     * Sums the deposited charge of every detector and rejects the event if none of the selected detectors has received the
+     * configured minimum charge. None of the modules following in the event loop is executed for rejected events, such that
+     * placing this module before the propagation saves the full simulation of events not reaching the detectors of interest.
+     */
+    class EventFilterModule : public Module {
+    public:
+        /**
+         * @brief Constructor for this unique module
+         * @param config Configuration object for this module as retrieved from the steering file
+         * @param messenger Pointer to the messenger object to allow binding to messages on the bus
+         * @param geo_manager Pointer to the geometry manager, containing the detectors
+         */
+        EventFilterModule(Configuration& config, Messenger* messenger, GeometryManager* geo_manager);
+
+        /**
+         * @brief Check the list of selected detectors
+         */
+        void init() override;
+
+        /**
+         * @brief Reject the event if no selected detector received the minimum deposited charge
+         */
+        void run(unsigned int) override;
+
+        /**
+         * @brief Print the number of accepted and rejected events
+         */
+        void finalize() override;
+
+    private:
+        GeometryManager* geo_manager_;
+
+        // Detectors to consider, all detectors are considered if empty
+        std::set<std::string> detectors_;
+        double minimum_charge_{};
+
+        std::vector<std::shared_ptr<DepositedChargeMessage>> messages_;
+
+        // Statistics
+        unsigned int accepted_events_{};
+        unsigned int rejected_events_{};
+    };
+} // namespace allpix
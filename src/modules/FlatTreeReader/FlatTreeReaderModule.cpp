@@ -0,0 +1,316 @@
+/**
+ * @file
+ * @brief Implementation of module reading the flat columnar trees written by the FlatTreeWriter
+ * @copyright Copyright (c) 2020 CERN and the Allpix Squared authors.
+ * This software is distributed under the terms of the MIT License, copied verbatim in the file "LICENSE.md".
+ * In applying this license, CERN does not waive the privileges and immunities granted to it by virtue of its status as an
+ * Intergovernmental Organization or submit itself to any jurisdiction.
+ */
+
+#include "FlatTreeReaderModule.hpp"
+
+#include <string>
+#include <utility>
+
+#include <Math/Point3D.h>
+
+#include "core/utils/log.h"
+
+using namespace allpix;
+
+FlatTreeReaderModule::FlatTreeReaderModule(Configuration& config, Messenger* messenger, GeometryManager* geo_manager)
+    : Module(config), messenger_(messenger), geo_manager_(geo_manager) {}
+
+void FlatTreeReaderModule::init() {
+    // Check which object types should be read
+    std::set<std::string> types{"MCParticle", "PixelCharge", "PixelHit"};
+    if(config_.has("include")) {
+        for(auto& type : config_.getArray<std::string>("include")) {
+            if(types.find(type) == types.end()) {
+                throw InvalidValueError(config_, "include", "object type " + type + " cannot be read from flat trees");
+            }
+            include_.insert(type);
+        }
+    } else {
+        include_ = types;
+    }
+
+    // Open the file with the trees
+    auto input_file_name = config_.getPathWithExtension("file_name", "root", true);
+    input_file_ = std::make_unique<TFile>(input_file_name.c_str());
+    if(input_file_->IsZombie()) {
+        throw InvalidValueError(config_, "file_name", "file cannot be read");
+    }
+
+    // Resolve the detectors referenced by their index
+    TTree* detector_tree = nullptr;
+    input_file_->GetObject("detectors", detector_tree);
+    if(detector_tree == nullptr) {
+        throw InvalidValueError(config_, "file_name", "file does not contain flat trees written by the FlatTreeWriter");
+    }
+    std::string* detector_name = nullptr;
+    detector_tree->SetBranchAddress("name", &detector_name);
+    for(Long64_t entry = 0; entry < detector_tree->GetEntries(); ++entry) {
+        detector_tree->GetEntry(entry);
+        if(!geo_manager_->hasDetector(*detector_name)) {
+            throw InvalidValueError(config_, "file_name", "detector " + *detector_name + " is not part of the geometry");
+        }
+        detectors_.push_back(geo_manager_->getDetector(*detector_name));
+    }
+    detector_tree->ResetBranchAddresses();
+    delete detector_name;
+
+    // Attach to the trees of the selected object types which are available in the file
+    std::vector<FlatTree*> trees;
+    if(include_.count("MCParticle") != 0 && attach_tree(mc_particle_tree_,
+                                                        "MCParticle",
+                                                        {"detector", "pdg", "parent"},
+                                                        {"local_start_x",
+                                                         "local_start_y",
+                                                         "local_start_z",
+                                                         "local_end_x",
+                                                         "local_end_y",
+                                                         "local_end_z",
+                                                         "global_start_x",
+                                                         "global_start_y",
+                                                         "global_start_z",
+                                                         "global_end_x",
+                                                         "global_end_y",
+                                                         "global_end_z",
+                                                         "local_time",
+                                                         "global_time"})) {
+        trees.push_back(&mc_particle_tree_);
+    }
+    if(include_.count("PixelCharge") != 0 &&
+       attach_tree(pixel_charge_tree_,
+                   "PixelCharge",
+                   {"detector", "x", "y", "charge", "mc_particle_count", "mc_particles"},
+                   {"local_time", "global_time"})) {
+        // Pulses are only available if they have been stored by the writer
+        auto* tree = pixel_charge_tree_.tree;
+        if(tree->GetBranch("pulse") != nullptr) {
+            tree->SetBranchAddress("pulse_size", &pixel_charge_tree_.int_columns["pulse_size"]);
+            tree->SetBranchAddress("pulse_binning", &pixel_charge_tree_.double_columns["pulse_binning"]);
+            tree->SetBranchAddress("pulse", &pixel_charge_tree_.double_columns["pulse"]);
+        }
+        trees.push_back(&pixel_charge_tree_);
+    }
+    if(include_.count("PixelHit") != 0 &&
+       attach_tree(
+           pixel_hit_tree_, "PixelHit", {"detector", "x", "y", "pixel_charge"}, {"signal", "local_time", "global_time"})) {
+        trees.push_back(&pixel_hit_tree_);
+    }
+    if(trees.empty()) {
+        throw InvalidValueError(config_, "file_name", "file does not contain any of the requested object types");
+    }
+
+    // All trees are filled for every event, hence the event numbers of a single tree index all of them
+    auto* tree = trees.front()->tree;
+    unsigned int event = 0;
+    tree->SetBranchStatus("*", false);
+    tree->SetBranchStatus("event", true);
+    tree->SetBranchAddress("event", &event);
+    for(Long64_t entry = 0; entry < tree->GetEntries(); ++entry) {
+        tree->GetEntry(entry);
+        event_entries_[event] = entry;
+    }
+    tree->ResetBranchAddress(tree->GetBranch("event"));
+    tree->SetBranchStatus("*", true);
+    tree->SetBranchStatus("event", false);
+    LOG(INFO) << "Found " << event_entries_.size() << " events in flat trees of file " << input_file_name;
+}
+
+bool FlatTreeReaderModule::attach_tree(FlatTree& tree,
+                                       const std::string& name,
+                                       const std::vector<std::string>& int_columns,
+                                       const std::vector<std::string>& double_columns) {
+    input_file_->GetObject(name.c_str(), tree.tree);
+    if(tree.tree == nullptr) {
+        LOG(WARNING) << "File does not contain objects of type " << name;
+        return false;
+    }
+
+    // The event number is only read while indexing the events
+    tree.tree->SetBranchStatus("event", false);
+    for(auto& column : int_columns) {
+        tree.tree->SetBranchAddress(column.c_str(), &tree.int_columns[column]);
+    }
+    for(auto& column : double_columns) {
+        tree.tree->SetBranchAddress(column.c_str(), &tree.double_columns[column]);
+    }
+    return true;
+}
+
+void FlatTreeReaderModule::run(unsigned int event_num) {
+    auto event_entry = event_entries_.find(event_num);
+    if(event_entry == event_entries_.end()) {
+        if(event_entries_.empty() || event_num > event_entries_.rbegin()->first) {
+            throw EndOfRunException("Requesting end of run because the flat trees do not contain any further events");
+        }
+        // Events which were skipped while writing do not contain any objects
+        LOG(DEBUG) << "No objects stored for event " << event_num;
+        return;
+    }
+
+    // Objects are read in order of their references, such that all referenced objects exist already
+    LOG(TRACE) << "Building objects from entry " << event_entry->second << " of the flat trees";
+    if(mc_particle_tree_.tree != nullptr) {
+        mc_particle_tree_.tree->GetEntry(event_entry->second);
+        read_mc_particles();
+    }
+    if(pixel_charge_tree_.tree != nullptr) {
+        pixel_charge_tree_.tree->GetEntry(event_entry->second);
+        read_pixel_charges();
+    }
+    if(pixel_hit_tree_.tree != nullptr) {
+        pixel_hit_tree_.tree->GetEntry(event_entry->second);
+        read_pixel_hits();
+    }
+
+    for(auto& message : messages_) {
+        messenger_->dispatchMessage(this, message);
+    }
+    messages_.clear();
+    mc_particles_.clear();
+    pixel_charges_.clear();
+}
+
+void FlatTreeReaderModule::read_mc_particles() {
+    auto& ints = mc_particle_tree_.int_columns;
+    auto& doubles = mc_particle_tree_.double_columns;
+    const auto& detector = *ints["detector"];
+
+    // Reserve the objects of every detector in advance, such that the references to them stay valid
+    std::map<int, size_t> counts;
+    for(auto index : detector) {
+        ++counts[index];
+    }
+    std::map<int, std::vector<MCParticle>> mc_particles;
+    for(auto& count : counts) {
+        mc_particles[count.first].reserve(count.second);
+    }
+
+    for(size_t i = 0; i < detector.size(); ++i) {
+        auto& objects = mc_particles[detector[i]];
+        auto point = [&](const std::string& prefix) {
+            return ROOT::Math::XYZPoint(
+                doubles[prefix + "_x"]->at(i), doubles[prefix + "_y"]->at(i), doubles[prefix + "_z"]->at(i));
+        };
+        objects.emplace_back(point("local_start"),
+                             point("global_start"),
+                             point("local_end"),
+                             point("global_end"),
+                             ints["pdg"]->at(i),
+                             doubles["local_time"]->at(i),
+                             doubles["global_time"]->at(i));
+        mc_particles_.push_back(&objects.back());
+    }
+
+    const auto& parent = *ints["parent"];
+    for(size_t i = 0; i < parent.size(); ++i) {
+        if(parent[i] >= 0) {
+            mc_particles_[i]->setParent(mc_particles_.at(static_cast<size_t>(parent[i])));
+        }
+    }
+
+    for(auto& objects : mc_particles) {
+        read_cnt_ += objects.second.size();
+        auto detector_ptr = (objects.first >= 0 ? detectors_.at(static_cast<size_t>(objects.first)) : nullptr);
+        messages_.push_back(std::make_shared<MCParticleMessage>(std::move(objects.second), detector_ptr));
+    }
+}
+
+void FlatTreeReaderModule::read_pixel_charges() {
+    auto& ints = pixel_charge_tree_.int_columns;
+    auto& doubles = pixel_charge_tree_.double_columns;
+    const auto& detector = *ints["detector"];
+    auto has_pulses = (doubles.find("pulse") != doubles.end());
+
+    std::map<int, size_t> counts;
+    for(auto index : detector) {
+        ++counts[index];
+    }
+    std::map<int, std::vector<PixelCharge>> pixel_charges;
+    for(auto& count : counts) {
+        pixel_charges[count.first].reserve(count.second);
+    }
+
+    size_t mc_particle_position = 0;
+    size_t pulse_position = 0;
+    for(size_t i = 0; i < detector.size(); ++i) {
+        auto detector_ptr = detectors_.at(static_cast<size_t>(detector[i]));
+        auto pixel = detector_ptr->getPixel(static_cast<unsigned int>(ints["x"]->at(i)),
+                                            static_cast<unsigned int>(ints["y"]->at(i)));
+        auto charge = ints["charge"]->at(i);
+
+        // Restore the pulse if stored, otherwise the full charge is placed in the first bin
+        Pulse pulse;
+        if(has_pulses && doubles["pulse_binning"]->at(i) > 0) {
+            pulse = Pulse(doubles["pulse_binning"]->at(i));
+        }
+        if(has_pulses) {
+            auto pulse_size = static_cast<size_t>(ints["pulse_size"]->at(i));
+            for(size_t bin = 0; bin < pulse_size; ++bin) {
+                pulse.addCharge(doubles["pulse"]->at(pulse_position + bin), static_cast<double>(bin) * pulse.getBinning());
+            }
+            pulse_position += pulse_size;
+        } else {
+            pulse.addCharge(static_cast<double>(charge), 0);
+        }
+
+        // Monte-Carlo particles are only available if they have been read as well
+        std::vector<const MCParticle*> mc_particles;
+        auto mc_particle_count = static_cast<size_t>(ints["mc_particle_count"]->at(i));
+        if(!mc_particles_.empty()) {
+            for(size_t j = 0; j < mc_particle_count; ++j) {
+                auto mc_particle_index = ints["mc_particles"]->at(mc_particle_position + j);
+                mc_particles.push_back(mc_particles_.at(static_cast<size_t>(mc_particle_index)));
+            }
+        }
+        mc_particle_position += mc_particle_count;
+
+        auto& objects = pixel_charges[detector[i]];
+        objects.emplace_back(
+            pixel, charge, pulse, doubles["local_time"]->at(i), doubles["global_time"]->at(i), mc_particles);
+        pixel_charges_.push_back(&objects.back());
+    }
+
+    for(auto& objects : pixel_charges) {
+        read_cnt_ += objects.second.size();
+        messages_.push_back(std::make_shared<PixelChargeMessage>(std::move(objects.second),
+                                                                 detectors_.at(static_cast<size_t>(objects.first))));
+    }
+}
+
+void FlatTreeReaderModule::read_pixel_hits() {
+    auto& ints = pixel_hit_tree_.int_columns;
+    auto& doubles = pixel_hit_tree_.double_columns;
+    const auto& detector = *ints["detector"];
+
+    std::map<int, std::vector<PixelHit>> pixel_hits;
+    for(size_t i = 0; i < detector.size(); ++i) {
+        auto detector_ptr = detectors_.at(static_cast<size_t>(detector[i]));
+        auto pixel = detector_ptr->getPixel(static_cast<unsigned int>(ints["x"]->at(i)),
+                                            static_cast<unsigned int>(ints["y"]->at(i)));
+
+        // Pixel charges are only available if they have been read as well
+        auto pixel_charge_index = ints["pixel_charge"]->at(i);
+        const PixelCharge* pixel_charge = nullptr;
+        if(pixel_charge_index >= 0 && !pixel_charges_.empty()) {
+            pixel_charge = pixel_charges_.at(static_cast<size_t>(pixel_charge_index));
+        }
+
+        pixel_hits[detector[i]].emplace_back(
+            pixel, doubles["local_time"]->at(i), doubles["global_time"]->at(i), doubles["signal"]->at(i), pixel_charge);
+    }
+
+    for(auto& objects : pixel_hits) {
+        read_cnt_ += objects.second.size();
+        messages_.push_back(
+            std::make_shared<PixelHitMessage>(std::move(objects.second), detectors_.at(static_cast<size_t>(objects.first))));
+    }
+}
+
+void FlatTreeReaderModule::finalize() {
+    LOG(STATUS) << "Read " << read_cnt_ << " objects from flat trees";
+}
@@ -0,0 +1,120 @@
+/**
+ * @file
+ * @brief Definition of module reading the flat columnar trees written by the FlatTreeWriter
+ * @copyright Copyright (c) 2020 CERN and the Allpix Squared authors.
+ * This software is distributed under the terms of the MIT License, copied verbatim in the file "LICENSE.md".
+ * In applying this license, CERN does not waive the privileges and immunities granted to it by virtue of its status as an
+ * Intergovernmental Organization or submit itself to any jurisdiction.
+ */
+
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <TFile.h>
+#include <TTree.h>
+
+#include "core/config/Configuration.hpp"
+#include "core/geometry/GeometryManager.hpp"
+#include "core/messenger/Messenger.hpp"
+#include "core/module/Module.hpp"
+
+#include "objects/MCParticle.hpp"
+#include "objects/PixelCharge.hpp"
+#include "objects/PixelHit.hpp"
+
+namespace allpix {
+    /**
+     * @ingroup Modules
+     * @brief Module to restore the simulated objects from the flat trees written by the FlatTreeWriter
+     *
+     * Reads the columns of the MCParticle, PixelCharge and PixelHit trees for every event, reconstructs the objects
+     * including their references and dispatches them as messages for every detector. The entries of the trees are matched
+     * to the events of the run by their stored event number.
+     */
+    class FlatTreeReaderModule : public Module {
+    public:
+        /**
+         * @brief Constructor for this unique module
+         * @param config Configuration object for this module as retrieved from the steering file
+         * @param messenger Pointer to the messenger object to allow binding to messages on the bus
+         * @param geo_manager Pointer to the geometry manager, containing the detectors
+         */
+        FlatTreeReaderModule(Configuration& config, Messenger* messenger, GeometryManager* geo_manager);
+
+        /**
+         * @brief Open the input file, attach to the trees and index their events
+         */
+        void init() override;
+
+        /**
+         * @brief Reconstruct the objects of the event from the trees and dispatch them
+         */
+        void run(unsigned int event_num) override;
+
+        /**
+         * @brief Output summary of the objects read
+         */
+        void finalize() override;
+
+    private:
+        /**
+         * @brief Tree with its columns, every column holds one value per object of the current event
+         */
+        struct FlatTree {
+            TTree* tree{};
+            std::map<std::string, std::vector<int>*> int_columns;
+            std::map<std::string, std::vector<double>*> double_columns;
+        };
+
+        /**
+         * @brief Attach to a tree in the input file and to the branches of all its columns
+         * @param tree Tree to attach to
+         * @param name Name of the tree
+         * @param int_columns Names of the integer columns
+         * @param double_columns Names of the floating point columns
+         * @return True if the tree is available in the file, false otherwise
+         */
+        bool attach_tree(FlatTree& tree,
+                         const std::string& name,
+                         const std::vector<std::string>& int_columns,
+                         const std::vector<std::string>& double_columns);
+
+        // Reconstruct the objects of the different types from the columns of the current entry
+        void read_mc_particles();
+        void read_pixel_charges();
+        void read_pixel_hits();
+
+        Messenger* messenger_;
+        GeometryManager* geo_manager_;
+
+        // File containing the trees
+        std::unique_ptr<TFile> input_file_;
+
+        // Object types to read
+        std::set<std::string> include_;
+
+        // Detectors referenced by their index in the detector tree
+        std::vector<std::shared_ptr<Detector>> detectors_;
+
+        // Trees of the different object types
+        FlatTree mc_particle_tree_;
+        FlatTree pixel_charge_tree_;
+        FlatTree pixel_hit_tree_;
+
+        // Entry of the trees belonging to every stored event
+        std::map<unsigned int, Long64_t> event_entries_;
+
+        // Objects of the current event, referenced by their index in their tree
+        std::vector<MCParticle*> mc_particles_;
+        std::vector<PixelCharge*> pixel_charges_;
+
+        // Messages of the current event, dispatched once all references are set
+        std::vector<std::shared_ptr<BaseMessage>> messages_;
+
+        // Statistics for total amount of objects read
+        unsigned long read_cnt_{};
+    };
+} // namespace allpix
@@ -0,0 +1,272 @@
+/**
+ * @file
+ * @brief Implementation of module writing flat columnar trees of the simulated objects
+ * @copyright Copyright (c) 2020 CERN and the Allpix Squared authors.
+ * This software is distributed under the terms of the MIT License, copied verbatim in the file "LICENSE.md".
+ * In applying this license, CERN does not waive the privileges and immunities granted to it by virtue of its status as an
+ * Intergovernmental Organization or submit itself to any jurisdiction.
+ */
+
+#include "FlatTreeWriterModule.hpp"
+
+#include <string>
+#include <utility>
+
+#include "core/utils/file.h"
+#include "core/utils/log.h"
+#include "objects/exceptions.h"
+
+using namespace allpix;
+
+FlatTreeWriterModule::FlatTreeWriterModule(Configuration& config, Messenger* messenger, GeometryManager* geo_manager)
+    : Module(config), geo_manager_(geo_manager) {
+    // None of the objects are required, empty events are stored as well
+    messenger->bindMulti(this, &FlatTreeWriterModule::mc_particle_messages_);
+    messenger->bindMulti(this, &FlatTreeWriterModule::pixel_charge_messages_);
+    messenger->bindMulti(this, &FlatTreeWriterModule::pixel_hit_messages_);
+
+    config_.setDefault("file_name", "data");
+    config_.setDefault<bool>("store_pulses", false);
+
+    store_pulses_ = config_.get<bool>("store_pulses");
+}
+
+void FlatTreeWriterModule::init() {
+    // Check which object types should be written
+    std::set<std::string> types{"MCParticle", "PixelCharge", "PixelHit"};
+    if(config_.has("include")) {
+        for(auto& type : config_.getArray<std::string>("include")) {
+            if(types.find(type) == types.end()) {
+                throw InvalidValueError(config_, "include", "object type " + type + " cannot be written to flat trees");
+            }
+            include_.insert(type);
+        }
+    } else {
+        include_ = types;
+    }
+
+    // Create output file
+    output_file_name_ = createOutputFile(allpix::add_file_extension(config_.get<std::string>("file_name"), "root"), true);
+    output_file_ = std::make_unique<TFile>(output_file_name_.c_str(), "RECREATE");
+    output_file_->cd();
+
+    // Store the names of the detectors, the detector columns of the object trees hold the index in this tree
+    auto* detector_tree = new TTree("detectors", "Names of the detectors referenced in the other trees");
+    std::string detector_name;
+    detector_tree->Branch("name", &detector_name);
+    for(auto& detector : geo_manager_->getDetectors()) {
+        detector_name = detector->getName();
+        detector_index_[detector_name] = static_cast<int>(detector_index_.size());
+        detector_tree->Fill();
+    }
+    detector_tree->ResetBranchAddresses();
+
+    // Create the trees of the selected object types
+    if(include_.count("MCParticle") != 0) {
+        create_tree(mc_particle_tree_,
+                    "MCParticle",
+                    {"detector", "pdg", "parent"},
+                    {"local_start_x",
+                     "local_start_y",
+                     "local_start_z",
+                     "local_end_x",
+                     "local_end_y",
+                     "local_end_z",
+                     "global_start_x",
+                     "global_start_y",
+                     "global_start_z",
+                     "global_end_x",
+                     "global_end_y",
+                     "global_end_z",
+                     "local_time",
+                     "global_time"});
+    }
+    if(include_.count("PixelCharge") != 0) {
+        std::vector<std::string> int_columns{"detector", "x", "y", "charge", "mc_particle_count", "mc_particles"};
+        std::vector<std::string> double_columns{"local_time", "global_time"};
+        if(store_pulses_) {
+            int_columns.emplace_back("pulse_size");
+            double_columns.emplace_back("pulse_binning");
+            double_columns.emplace_back("pulse");
+        }
+        create_tree(pixel_charge_tree_, "PixelCharge", int_columns, double_columns);
+    }
+    if(include_.count("PixelHit") != 0) {
+        create_tree(
+            pixel_hit_tree_, "PixelHit", {"detector", "x", "y", "pixel_charge"}, {"signal", "local_time", "global_time"});
+    }
+}
+
+void FlatTreeWriterModule::create_tree(FlatTree& tree,
+                                       const std::string& name,
+                                       const std::vector<std::string>& int_columns,
+                                       const std::vector<std::string>& double_columns) {
+    tree.tree = new TTree(name.c_str(), ("Columns of the " + name + " objects").c_str());
+    tree.tree->Branch("event", &event_);
+    for(auto& column : int_columns) {
+        tree.tree->Branch(column.c_str(), &tree.int_columns[column]);
+    }
+    for(auto& column : double_columns) {
+        tree.tree->Branch(column.c_str(), &tree.double_columns[column]);
+    }
+}
+
+void FlatTreeWriterModule::fill_tree(FlatTree& tree) {
+    tree.tree->Fill();
+    for(auto& column : tree.int_columns) {
+        column.second.clear();
+    }
+    for(auto& column : tree.double_columns) {
+        column.second.clear();
+    }
+}
+
+int FlatTreeWriterModule::get_detector_index(const std::shared_ptr<const Detector>& detector) const {
+    if(detector == nullptr) {
+        return -1;
+    }
+    return detector_index_.at(detector->getName());
+}
+
+void FlatTreeWriterModule::run(unsigned int event_num) {
+    event_ = event_num;
+
+    // Objects are filled in order of their references, such that the index of all referenced objects is known
+    if(include_.count("MCParticle") != 0) {
+        fill_mc_particles();
+        fill_tree(mc_particle_tree_);
+    }
+    if(include_.count("PixelCharge") != 0) {
+        fill_pixel_charges();
+        fill_tree(pixel_charge_tree_);
+    }
+    if(include_.count("PixelHit") != 0) {
+        fill_pixel_hits();
+        fill_tree(pixel_hit_tree_);
+    }
+
+    mc_particle_index_.clear();
+    pixel_charge_index_.clear();
+}
+
+void FlatTreeWriterModule::fill_mc_particles() {
+    auto& ints = mc_particle_tree_.int_columns;
+    auto& doubles = mc_particle_tree_.double_columns;
+
+    for(auto& message : mc_particle_messages_) {
+        for(auto& mc_particle : message->getData()) {
+            mc_particle_index_[&mc_particle] = static_cast<int>(mc_particle_index_.size());
+        }
+    }
+
+    for(auto& message : mc_particle_messages_) {
+        auto detector = get_detector_index(message->getDetector());
+        for(auto& mc_particle : message->getData()) {
+            // Parents which are not part of the written particles are not referenced
+            auto parent = mc_particle_index_.find(mc_particle.getParent());
+            ints["detector"].push_back(detector);
+            ints["pdg"].push_back(mc_particle.getParticleID());
+            ints["parent"].push_back(parent != mc_particle_index_.end() ? parent->second : -1);
+
+            auto local_start = mc_particle.getLocalStartPoint();
+            auto local_end = mc_particle.getLocalEndPoint();
+            auto global_start = mc_particle.getGlobalStartPoint();
+            auto global_end = mc_particle.getGlobalEndPoint();
+            doubles["local_start_x"].push_back(local_start.x());
+            doubles["local_start_y"].push_back(local_start.y());
+            doubles["local_start_z"].push_back(local_start.z());
+            doubles["local_end_x"].push_back(local_end.x());
+            doubles["local_end_y"].push_back(local_end.y());
+            doubles["local_end_z"].push_back(local_end.z());
+            doubles["global_start_x"].push_back(global_start.x());
+            doubles["global_start_y"].push_back(global_start.y());
+            doubles["global_start_z"].push_back(global_start.z());
+            doubles["global_end_x"].push_back(global_end.x());
+            doubles["global_end_y"].push_back(global_end.y());
+            doubles["global_end_z"].push_back(global_end.z());
+            doubles["local_time"].push_back(mc_particle.getLocalTime());
+            doubles["global_time"].push_back(mc_particle.getGlobalTime());
+            ++write_cnt_;
+        }
+    }
+}
+
+void FlatTreeWriterModule::fill_pixel_charges() {
+    auto& ints = pixel_charge_tree_.int_columns;
+    auto& doubles = pixel_charge_tree_.double_columns;
+
+    for(auto& message : pixel_charge_messages_) {
+        auto detector = get_detector_index(message->getDetector());
+        for(auto& pixel_charge : message->getData()) {
+            pixel_charge_index_[&pixel_charge] = static_cast<int>(pixel_charge_index_.size());
+
+            auto index = pixel_charge.getIndex();
+            ints["detector"].push_back(detector);
+            ints["x"].push_back(static_cast<int>(index.x()));
+            ints["y"].push_back(static_cast<int>(index.y()));
+            ints["charge"].push_back(static_cast<int>(pixel_charge.getCharge()));
+            doubles["local_time"].push_back(pixel_charge.getLocalTime());
+            doubles["global_time"].push_back(pixel_charge.getGlobalTime());
+
+            // Only the particles which are written themselves can be referenced
+            int mc_particle_count = 0;
+            try {
+                for(auto& mc_particle : pixel_charge.getMCParticles()) {
+                    auto mc_particle_index = mc_particle_index_.find(mc_particle);
+                    if(mc_particle_index != mc_particle_index_.end()) {
+                        ints["mc_particles"].push_back(mc_particle_index->second);
+                        ++mc_particle_count;
+                    }
+                }
+            } catch(MissingReferenceException& e) {
+                LOG(TRACE) << "Not all Monte-Carlo particles of pixel charge " << pixel_charge.getIndex()
+                           << " are available, references are not stored";
+            }
+            ints["mc_particle_count"].push_back(mc_particle_count);
+
+            if(store_pulses_) {
+                const auto& pulse = pixel_charge.getPulse();
+                ints["pulse_size"].push_back(static_cast<int>(pulse.getPulse().size()));
+                doubles["pulse_binning"].push_back(pulse.isInitialized() ? pulse.getBinning() : 0.);
+                doubles["pulse"].insert(doubles["pulse"].end(), pulse.getPulse().begin(), pulse.getPulse().end());
+            }
+            ++write_cnt_;
+        }
+    }
+}
+
+void FlatTreeWriterModule::fill_pixel_hits() {
+    auto& ints = pixel_hit_tree_.int_columns;
+    auto& doubles = pixel_hit_tree_.double_columns;
+
+    for(auto& message : pixel_hit_messages_) {
+        auto detector = get_detector_index(message->getDetector());
+        for(auto& pixel_hit : message->getData()) {
+            auto index = pixel_hit.getIndex();
+            ints["detector"].push_back(detector);
+            ints["x"].push_back(static_cast<int>(index.x()));
+            ints["y"].push_back(static_cast<int>(index.y()));
+            doubles["signal"].push_back(pixel_hit.getSignal());
+            doubles["local_time"].push_back(pixel_hit.getLocalTime());
+            doubles["global_time"].push_back(pixel_hit.getGlobalTime());
+
+            int pixel_charge = -1;
+            try {
+                auto pixel_charge_index = pixel_charge_index_.find(pixel_hit.getPixelCharge());
+                if(pixel_charge_index != pixel_charge_index_.end()) {
+                    pixel_charge = pixel_charge_index->second;
+                }
+            } catch(MissingReferenceException& e) {
+                LOG(TRACE) << "Pixel charge of pixel hit " << pixel_hit.getIndex()
+                           << " is not available, reference is not stored";
+            }
+            ints["pixel_charge"].push_back(pixel_charge);
+            ++write_cnt_;
+        }
+    }
+}
+
+void FlatTreeWriterModule::finalize() {
+    output_file_->Write();
+    LOG(STATUS) << "Wrote " << write_cnt_ << " objects to flat trees in file:" << std::endl << output_file_name_;
+}
@@ -0,0 +1,136 @@
+/**
+ * @file
+ * @brief Definition of module writing flat columnar trees of the simulated objects
+ * @copyright Copyright (c) 2020 CERN and the Allpix Squared authors.
+ * This software is distributed under the terms of the MIT License, copied verbatim in the file "LICENSE.md".
+ * In applying this license, CERN does not waive the privileges and immunities granted to it by virtue of its status as an
+ * Intergovernmental Organization or submit itself to any jurisdiction.
+ */
+
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <TFile.h>
+#include <TTree.h>
+
+#include "core/config/Configuration.hpp"
+#include "core/geometry/GeometryManager.hpp"
+#include "core/messenger/Messenger.hpp"
+#include "core/module/Module.hpp"
+
+#include "objects/MCParticle.hpp"
+#include "objects/PixelCharge.hpp"
+#include "objects/PixelHit.hpp"
+
+namespace allpix {
+    /**
+     * @ingroup Modules
+     * @brief Module to write the simulated objects to flat trees with one column per object property
+     *
+     * Stores the MCParticle, PixelCharge and PixelHit objects of every event in a separate tree per object type. Every
+     * property of the objects is written to a branch holding a plain vector of numbers, with one element per object in the
+     * event. References between objects are stored as the index of the referenced object in its tree, such that the data
+     * can be analysed without the object dictionaries of the framework.
+     */
+    class FlatTreeWriterModule : public Module {
+    public:
+        /**
+         * @brief Constructor for this unique module
+         * @param config Configuration object for this module as retrieved from the steering file
+         * @param messenger Pointer to the messenger object to allow binding to messages on the bus
+         * @param geo_manager Pointer to the geometry manager, containing the detectors
+         */
+        FlatTreeWriterModule(Configuration& config, Messenger* messenger, GeometryManager* geo_manager);
+
+        /**
+         * @brief Open the output file and create the trees
+         */
+        void init() override;
+
+        /**
+         * @brief Fill the columns of all trees with the objects of the event
+         */
+        void run(unsigned int event_num) override;
+
+        /**
+         * @brief Write the trees to the output file
+         */
+        void finalize() override;
+
+    private:
+        /**
+         * @brief Tree with its columns, every column holds one value per object of the current event
+         */
+        struct FlatTree {
+            TTree* tree{};
+            std::map<std::string, std::vector<int>> int_columns;
+            std::map<std::string, std::vector<double>> double_columns;
+        };
+
+        /**
+         * @brief Create a tree and a branch for each of its columns
+         * @param tree Tree to create
+         * @param name Name of the tree
+         * @param int_columns Names of the integer columns
+         * @param double_columns Names of the floating point columns
+         */
+        void create_tree(FlatTree& tree,
+                         const std::string& name,
+                         const std::vector<std::string>& int_columns,
+                         const std::vector<std::string>& double_columns);
+
+        /**
+         * @brief Fill the current event to a tree and clear its columns
+         * @param tree Tree to fill
+         */
+        void fill_tree(FlatTree& tree);
+
+        // Fill the columns of the different object types
+        void fill_mc_particles();
+        void fill_pixel_charges();
+        void fill_pixel_hits();
+
+        /**
+         * @brief Get the index of a detector in the detector tree
+         * @param detector Detector to look up, can be a null pointer for objects not bound to a detector
+         * @return Index of the detector or -1 if the objects are not bound to a detector
+         */
+        int get_detector_index(const std::shared_ptr<const Detector>& detector) const;
+
+        GeometryManager* geo_manager_;
+
+        // Messages received in the current event
+        std::vector<std::shared_ptr<MCParticleMessage>> mc_particle_messages_;
+        std::vector<std::shared_ptr<PixelChargeMessage>> pixel_charge_messages_;
+        std::vector<std::shared_ptr<PixelHitMessage>> pixel_hit_messages_;
+
+        // Object types to write and whether to store the full pulses of the pixel charges
+        std::set<std::string> include_;
+        bool store_pulses_{};
+
+        // Output data file to write
+        std::unique_ptr<TFile> output_file_;
+        std::string output_file_name_{};
+
+        // Index of every detector in the detector tree
+        std::map<std::string, int> detector_index_;
+
+        // Trees of the different object types
+        FlatTree mc_particle_tree_;
+        FlatTree pixel_charge_tree_;
+        FlatTree pixel_hit_tree_;
+
+        // Event number of the current entry of all trees
+        unsigned int event_{};
+
+        // Index of the objects of the current event in their tree, used to store the references between objects
+        std::map<const MCParticle*, int> mc_particle_index_;
+        std::map<const PixelCharge*, int> pixel_charge_index_;
+
+        // Statistical information about number of objects
+        unsigned long write_cnt_{};
+    };
+} // namespace allpix
@@ -94,6 +94,7 @@ GenericPropagationModule::GenericPropagationModule(Configuration& config,
     }
 
     config_.setDefault<bool>("ignore_magnetic_field", false);
+    config_.setDefault<bool>("counter_based_random", false);
 
     // Copy some variables from configuration to avoid lookups:
     temperature_ = config_.get<double>("temperature");
@@ -108,6 +109,12 @@ GenericPropagationModule::GenericPropagationModule(Configuration& config,
     output_plots_step_ = config_.get<double>("output_plots_step");
     output_plots_lines_at_implants_ = config_.get<bool>("output_plots_lines_at_implants");
 
+    // Draw diffusion from batches of normal numbers generated with the counter-based engine if requested
+    counter_based_random_ = config_.get<bool>("counter_based_random");
+    if(counter_based_random_) {
+        normal_sampler_.reset(getRandomEngine());
+    }
+
     // Enable parallelization of this module if multithreading is enabled and no per-event output plots are requested:
     if(!(output_animations_ || output_linegraphs_)) {
         enable_parallelization();
@@ -544,6 +551,12 @@ void GenericPropagationModule::init() {
 }
 
 void GenericPropagationModule::run(unsigned int event_num) {
+    // Seed the random generators for this event if requested
+    seed_event(random_generator_, event_num);
+    // Derive a separate seed for the diffusion sampler, such that it is not correlated with the generator
+    if(isSeededPerEvent()) {
+        normal_sampler_.seed(RandomEngine(getEventSeed(event_num), 1)());
+    }
 
     // Create vector of propagated charges to output
     std::vector<PropagatedCharge> propagated_charges;
@@ -677,32 +690,34 @@ GenericPropagationModule::propagate(const ROOT::Math::XYZPoint& pos, const Carri
         double diffusion_std_dev = std::sqrt(2. * diffusion_constant * timestep);
 
         // Compute the independent diffusion in three
-        std::normal_distribution<double> gauss_distribution(0, diffusion_std_dev);
         Eigen::Vector3d diffusion;
-        for(int i = 0; i < 3; ++i) {
-            diffusion[i] = gauss_distribution(random_generator_);
+        if(counter_based_random_) {
+            for(int i = 0; i < 3; ++i) {
+                diffusion[i] = normal_sampler_(0, diffusion_std_dev);
+            }
+        } else {
+            std::normal_distribution<double> gauss_distribution(0, diffusion_std_dev);
+            for(int i = 0; i < 3; ++i) {
+                diffusion[i] = gauss_distribution(random_generator_);
+            }
         }
         return diffusion;
     };
 
-    // Define lambda functions to compute the charge carrier velocity with or without magnetic field
-    std::function<Eigen::Vector3d(double, const Eigen::Vector3d&)> carrier_velocity_noB =
-        [&](double, const Eigen::Vector3d& cur_pos) -> Eigen::Vector3d {
-        auto raw_field = detector_->getElectricField(static_cast<ROOT::Math::XYZPoint>(cur_pos));
-        Eigen::Vector3d efield(raw_field.x(), raw_field.y(), raw_field.z());
+    // Look up the electric field through a cursor caching the field cell along the path of this carrier
+    auto field_cursor = detector_->getElectricFieldCursor();
 
-        return static_cast<int>(type) * carrier_mobility(efield.norm()) * efield;
-    };
-
-    std::function<Eigen::Vector3d(double, const Eigen::Vector3d&)> carrier_velocity_withB =
-        [&](double, const Eigen::Vector3d& cur_pos) -> Eigen::Vector3d {
-        auto raw_field = detector_->getElectricField(static_cast<ROOT::Math::XYZPoint>(cur_pos));
+    // Define a lambda function to compute the charge carrier velocity with or without magnetic field
+    auto carrier_velocity = [&](double, const Eigen::Vector3d& cur_pos) -> Eigen::Vector3d {
+        auto raw_field = field_cursor.get(static_cast<ROOT::Math::XYZPoint>(cur_pos));
         Eigen::Vector3d efield(raw_field.x(), raw_field.y(), raw_field.z());
 
-        Eigen::Vector3d velocity;
-        Eigen::Vector3d bfield(magnetic_field_.x(), magnetic_field_.y(), magnetic_field_.z());
-
         auto mob = carrier_mobility(efield.norm());
+        if(!has_magnetic_field_) {
+            return static_cast<int>(type) * mob * efield;
+        }
+
+        Eigen::Vector3d bfield(magnetic_field_.x(), magnetic_field_.y(), magnetic_field_.z());
         auto exb = efield.cross(bfield);
 
         Eigen::Vector3d term1;
@@ -715,10 +730,8 @@ GenericPropagationModule::propagate(const ROOT::Math::XYZPoint& pos, const Carri
         return static_cast<int>(type) * mob * (efield + term1 + term2) / rnorm;
     };
 
-    // Create the runge kutta solver with an RKF5 tableau, using different velocity calculators depending on the magnetic
-    // field
-    auto runge_kutta = make_runge_kutta(
-        tableau::RK5, (has_magnetic_field_ ? carrier_velocity_withB : carrier_velocity_noB), timestep_start_, position);
+    // Create the runge kutta solver with a compile-time RKF5 tableau
+    auto runge_kutta = make_runge_kutta<tableau::Fehlberg5>(carrier_velocity, timestep_start_, position);
 
     // Continue propagation until the deposit is outside the sensor
     Eigen::Vector3d last_position = position;
@@ -739,21 +752,17 @@ GenericPropagationModule::propagate(const ROOT::Math::XYZPoint& pos, const Carri
         last_position = position;
         last_time = runge_kutta.getTime();
 
-        // Execute a Runge Kutta step
-        auto step = runge_kutta.step();
+        // Execute a Runge Kutta step followed by the diffusion step
+        auto step = runge_kutta.step([&](const Eigen::Vector3d& cur_pos, double timestep) {
+            // Get electric field at current position and fall back to empty field if it does not exist
+            auto efield = field_cursor.get(static_cast<ROOT::Math::XYZPoint>(cur_pos));
+            return carrier_diffusion(std::sqrt(efield.Mag2()), timestep);
+        });
 
         // Get the current result and timestep
         auto timestep = runge_kutta.getTimeStep();
         position = runge_kutta.getValue();
 
-        // Get electric field at current position and fall back to empty field if it does not exist
-        auto efield = detector_->getElectricField(static_cast<ROOT::Math::XYZPoint>(position));
-
-        // Apply diffusion step
-        auto diffusion = carrier_diffusion(std::sqrt(efield.Mag2()), timestep);
-        position += diffusion;
-        runge_kutta.setValue(position);
-
         // Adapt step size to match target precision
         double uncertainty = step.error.norm();
 
@@ -825,3 +834,11 @@ void GenericPropagationModule::finalize() {
     LOG(INFO) << "Propagated total of " << total_propagated_charges_ << " charges in " << total_steps_
               << " steps in average time of " << Units::display(average_time, "ns");
 }
+
+void GenericPropagationModule::saveState(std::ostream& state) {
+    state << random_generator_ << " " << normal_sampler_;
+}
+
+void GenericPropagationModule::loadState(std::istream& state) {
+    state >> random_generator_ >> normal_sampler_;
+}
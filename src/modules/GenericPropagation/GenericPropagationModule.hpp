@@ -20,6 +20,7 @@
 #include "core/geometry/DetectorModel.hpp"
 #include "core/messenger/Messenger.hpp"
 #include "core/module/Module.hpp"
+#include "core/utils/prng.h"
 
 #include "objects/DepositedCharge.hpp"
 #include "objects/PropagatedCharge.hpp"
@@ -60,6 +61,16 @@ namespace allpix {
          */
         void finalize() override;
 
+        /**
+         * @brief Store the state of the random number generators in a checkpoint
+         */
+        void saveState(std::ostream& state) override;
+
+        /**
+         * @brief Restore the state of the random number generators from a checkpoint
+         */
+        void loadState(std::istream& state) override;
+
     private:
         Messenger* messenger_;
         std::shared_ptr<const Detector> detector_;
@@ -83,6 +94,8 @@ namespace allpix {
 
         // Random generator for this module
         std::mt19937_64 random_generator_;
+        bool counter_based_random_{};
+        NormalSampler<> normal_sampler_;
 
         // Local copies of configuration parameters to avoid costly lookup:
         double temperature_{}, timestep_min_{}, timestep_max_{}, timestep_start_{}, integration_time_{},
@@ -10,7 +10,10 @@
 
 #include "GeometryConstructionG4.hpp"
 
+#include <fstream>
+#include <iomanip>
 #include <memory>
+#include <sstream>
 #include <string>
 #include <utility>
 
@@ -27,12 +30,16 @@
 #include <G4Tubs.hh>
 #include <G4UnionSolid.hh>
 #include <G4UserLimits.hh>
+#include <G4Version.hh>
 #include <G4VSolid.hh>
 #include <G4VisAttributes.hh>
 
+#include "core/config/exceptions.h"
 #include "core/geometry/HybridPixelDetectorModel.hpp"
 #include "core/module/exceptions.h"
+#include "core/utils/file.h"
 #include "core/utils/log.h"
+#include "core/utils/text.h"
 #include "tools/ROOT.h"
 #include "tools/geant4.h"
 
@@ -115,8 +122,27 @@ G4VPhysicalVolume* GeometryConstructionG4::Construct() {
     const auto& detBuilder = new DetectorConstructionG4(geo_manager_);
     detBuilder->build(materials_, world_log_);
 
-    // Check for overlaps:
-    check_overlaps();
+    // Identify the geometry to let other modules cache quantities depending on it
+    auto geometry_hash = get_geometry_hash();
+    geo_manager_->setExternalObject("", "geometry_hash", std::make_shared<std::string>(geometry_hash));
+    LOG(DEBUG) << "Hash of the Geant4 geometry is " << geometry_hash;
+
+    // Check for overlaps, unless the same geometry has been checked successfully before
+    std::string cache_file;
+    if(config_.has("cache_directory")) {
+        auto cache_directory = config_.getPath("cache_directory");
+        try {
+            allpix::create_directories(cache_directory);
+        } catch(std::invalid_argument& e) {
+            throw InvalidValueError(config_, "cache_directory", e.what());
+        }
+        cache_file = cache_directory + "/geometry_" + geometry_hash;
+    }
+    if(!cache_file.empty() && allpix::path_is_file(cache_file)) {
+        LOG(INFO) << "Skipping overlap check, geometry has been checked before";
+    } else if(check_overlaps() && !cache_file.empty()) {
+        std::ofstream(cache_file) << geometry_hash << std::endl;
+    }
 
     return world_phys_.get();
 }
@@ -209,7 +235,7 @@ void GeometryConstructionG4::init_materials() {
     materials_["vacuum"] = new G4Material("Vacuum", 1, 1.008 * CLHEP::g / CLHEP::mole, CLHEP::universe_mean_density);
 }
 
-void GeometryConstructionG4::check_overlaps() {
+bool GeometryConstructionG4::check_overlaps() {
     G4PhysicalVolumeStore* phys_volume_store = G4PhysicalVolumeStore::GetInstance();
     LOG(TRACE) << "Checking overlaps";
     bool overlapFlag = false;
@@ -225,4 +251,23 @@ void GeometryConstructionG4::check_overlaps() {
     } else {
         LOG(INFO) << "No overlapping volumes detected.";
     }
+    return !overlapFlag;
+}
+
+/**
+ * The description of every physical volume consists of its placement, multiplicity, material and the parameters of its
+ * solid. The Geant4 version is included as well, since the construction of the solids may differ between versions.
+ */
+std::string GeometryConstructionG4::get_geometry_hash() const {
+    std::ostringstream description;
+    description << std::setprecision(17) << G4VERSION_NUMBER << std::endl;
+    for(auto* volume : (*G4PhysicalVolumeStore::GetInstance())) {
+        auto* logical_volume = volume->GetLogicalVolume();
+        description << volume->GetName() << " " << volume->GetCopyNo() << " " << volume->GetMultiplicity() << " "
+                    << volume->GetObjectTranslation() << " " << volume->GetObjectRotationValue() << " "
+                    << logical_volume->GetMaterial()->GetName() << " " << logical_volume->GetMaterial()->GetDensity()
+                    << std::endl;
+        logical_volume->GetSolid()->StreamInfo(description);
+    }
+    return allpix::hash_string(description.str());
 }
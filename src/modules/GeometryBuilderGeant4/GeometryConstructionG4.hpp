@@ -11,6 +11,7 @@
 #define ALLPIX_MODULE_GEOMETRY_CONSTRUCTION_H
 
 #include <memory>
+#include <string>
 #include <utility>
 
 #include "G4Material.hh"
@@ -50,8 +51,15 @@ namespace allpix {
 
         /**
          * @brief Check all placed volumes for overlaps
+         * @return True if no overlaps have been found, false otherwise
          */
-        void check_overlaps();
+        bool check_overlaps();
+
+        /**
+         * @brief Calculate a hash of the placement, shape and material of all placed volumes
+         * @return Hexadecimal hash identifying the geometry
+         */
+        std::string get_geometry_hash() const;
 
         // List of all materials
         std::map<std::string, G4Material*> materials_;
@@ -0,0 +1,297 @@
+/**
+ * @file
+ * @brief Implementation of module overlaying pile-up events from a library of pre-simulated deposits
+ * @copyright Copyright (c) 2020 CERN and the Allpix Squared authors.
+ * This software is distributed under the terms of the MIT License, copied verbatim in the file "LICENSE.md".
+ * In applying this license, CERN does not waive the privileges and immunities granted to it by virtue of its status as an
+ * Intergovernmental Organization or submit itself to any jurisdiction.
+ */
+
+#include "PileupOverlayModule.hpp"
+
+#include <algorithm>
+#include <string>
+#include <utility>
+
+#include <TBranch.h>
+#include <TFile.h>
+#include <TObjArray.h>
+#include <TTree.h>
+
+#include "core/utils/log.h"
+#include "core/utils/unit.h"
+#include "objects/exceptions.h"
+
+using namespace allpix;
+
+PileupOverlayModule::PileupOverlayModule(Configuration& config, Messenger* messenger, GeometryManager* geo_manager)
+    : Module(config), messenger_(messenger), geo_manager_(geo_manager) {
+    // Enable parallelization of this module if multithreading is enabled
+    enable_parallelization();
+
+    // Events without any deposits receive pile-up as well
+    messenger_->bindMulti(this, &PileupOverlayModule::deposit_messages_);
+
+    // Seed the random generator with the global seed
+    random_generator_.seed(getRandomSeed());
+
+    config_.setDefault<double>("pileup", 1);
+    config_.setDefault<bool>("poisson_pileup", false);
+    config_.setDefault<double>("time_offset_min", 0);
+    config_.setDefault<double>("time_offset_max", 0);
+
+    pileup_ = config_.get<double>("pileup");
+    poisson_pileup_ = config_.get<bool>("poisson_pileup");
+    time_offset_min_ = config_.get<double>("time_offset_min");
+    time_offset_max_ = config_.get<double>("time_offset_max");
+}
+
+void PileupOverlayModule::init() {
+    // The merged deposits replace the deposits of the event for the modules listening to the output name
+    if(config_.get<std::string>("output").empty()) {
+        throw InvalidValueError(
+            config_, "output", "a message name is required to distinguish the merged deposits from the simulated ones");
+    }
+    if(pileup_ < 0) {
+        throw InvalidValueError(config_, "pileup", "number of overlaid events cannot be negative");
+    }
+    if(time_offset_max_ < time_offset_min_) {
+        throw InvalidCombinationError(config_,
+                                      {"time_offset_min", "time_offset_max"},
+                                      "maximum time offset needs to be larger than the minimum time offset");
+    }
+
+    // Open the library file written by the ROOTObjectWriter
+    auto file_name = config_.getPathWithExtension("file_name", "root", true);
+    TFile input_file(file_name.c_str());
+    if(input_file.IsZombie()) {
+        throw InvalidValueError(config_, "file_name", "file cannot be read");
+    }
+    TTree* deposit_tree = nullptr;
+    TTree* mc_particle_tree = nullptr;
+    input_file.GetObject("DepositedCharge", deposit_tree);
+    input_file.GetObject("MCParticle", mc_particle_tree);
+    if(deposit_tree == nullptr) {
+        throw InvalidValueError(config_, "file_name", "file does not contain any deposited charges");
+    }
+
+    // Bind the branches of all detectors in the geometry, all other branches are not read
+    std::map<std::string, std::vector<Object*>*> objects;
+    auto bind_branches = [&](TTree* tree) {
+        std::map<std::string, std::shared_ptr<const Detector>> detectors;
+        if(tree == nullptr) {
+            return detectors;
+        }
+        auto* branches = tree->GetListOfBranches();
+        for(int i = 0; i < branches->GetEntries(); ++i) {
+            auto* branch = static_cast<TBranch*>(branches->At(i));
+            std::string branch_name = branch->GetName();
+            auto detector_name = branch_name.substr(0, branch_name.find('_'));
+            if(!geo_manager_->hasDetector(detector_name)) {
+                LOG(WARNING) << "Ignoring branch " << branch_name << " of tree " << tree->GetName()
+                             << " because its detector is not part of the geometry";
+                tree->SetBranchStatus(branch_name.c_str(), false);
+                continue;
+            }
+
+            auto key = std::string(tree->GetName()) + "/" + branch_name;
+            objects[key] = new std::vector<Object*>;
+            branch->SetAddress(&objects[key]);
+            detectors[key] = geo_manager_->getDetector(detector_name);
+        }
+        return detectors;
+    };
+    auto deposit_branches = bind_branches(deposit_tree);
+    auto mc_particle_branches = bind_branches(mc_particle_tree);
+
+    // Read the library into memory, replacing the references between the objects by their indices
+    auto entries = deposit_tree->GetEntries();
+    if(config_.has("library_size")) {
+        entries = std::min(entries, config_.get<Long64_t>("library_size"));
+    }
+    library_.resize(static_cast<size_t>(entries));
+    size_t deposit_count = 0;
+    for(Long64_t entry = 0; entry < entries; ++entry) {
+        auto& library_event = library_[static_cast<size_t>(entry)];
+        deposit_tree->GetEntry(entry);
+        if(mc_particle_tree != nullptr) {
+            mc_particle_tree->GetEntry(entry);
+        }
+
+        // Detector and index of the particles in their library event, references are only kept within a detector
+        std::map<const Object*, std::pair<std::shared_ptr<const Detector>, int>> particle_index;
+        for(auto& branch : mc_particle_branches) {
+            auto& mc_particles = library_event[branch.second].mc_particles;
+            for(auto& object : *objects[branch.first]) {
+                particle_index[object] = std::make_pair(branch.second, static_cast<int>(mc_particles.size()));
+                auto* mc_particle = static_cast<MCParticle*>(object);
+                mc_particles.push_back({mc_particle->getLocalStartPoint(),
+                                        mc_particle->getGlobalStartPoint(),
+                                        mc_particle->getLocalEndPoint(),
+                                        mc_particle->getGlobalEndPoint(),
+                                        mc_particle->getParticleID(),
+                                        mc_particle->getLocalTime(),
+                                        mc_particle->getGlobalTime(),
+                                        -1});
+            }
+        }
+        for(auto& branch : mc_particle_branches) {
+            auto& mc_particles = library_event[branch.second].mc_particles;
+            for(auto& object : *objects[branch.first]) {
+                auto parent = particle_index.find(static_cast<MCParticle*>(object)->getParent());
+                if(parent != particle_index.end() && parent->second.first == branch.second) {
+                    mc_particles[static_cast<size_t>(particle_index[object].second)].parent = parent->second.second;
+                }
+            }
+        }
+
+        for(auto& branch : deposit_branches) {
+            auto& deposits = library_event[branch.second].deposits;
+            for(auto& object : *objects[branch.first]) {
+                auto* deposit = static_cast<DepositedCharge*>(object);
+                int mc_particle = -1;
+                try {
+                    auto index = particle_index.find(deposit->getMCParticle());
+                    if(index != particle_index.end() && index->second.first == branch.second) {
+                        mc_particle = index->second.second;
+                    }
+                } catch(MissingReferenceException& e) {
+                    LOG_ONCE(WARNING) << "Monte-Carlo particles of deposits in pile-up library are not available";
+                }
+                deposits.push_back({deposit->getLocalPosition(),
+                                    deposit->getGlobalPosition(),
+                                    deposit->getType(),
+                                    deposit->getCharge(),
+                                    deposit->getLocalTime(),
+                                    deposit->getGlobalTime(),
+                                    mc_particle});
+                ++deposit_count;
+            }
+        }
+    }
+
+    for(auto& object : objects) {
+        delete object.second;
+    }
+    input_file.Close();
+
+    if(library_.empty()) {
+        throw InvalidValueError(config_, "file_name", "file does not contain any events");
+    }
+    LOG(INFO) << "Loaded " << library_.size() << " pile-up events with " << deposit_count << " deposits from " << file_name;
+}
+
+void PileupOverlayModule::run(unsigned int event_num) {
+    // Seed the random generators for this event if requested
+    seed_event(random_generator_, event_num);
+
+    // Start from the deposits of the simulated event, keeping their references
+    std::map<std::shared_ptr<const Detector>, std::vector<DepositedCharge>> deposits;
+    for(auto& message : deposit_messages_) {
+        auto& detector_deposits = deposits[message->getDetector()];
+        detector_deposits.insert(detector_deposits.end(), message->getData().begin(), message->getData().end());
+    }
+
+    // Choose the number of overlaid events and the events themselves
+    unsigned int overlays = 0;
+    if(poisson_pileup_) {
+        std::poisson_distribution<unsigned int> pileup_distribution(pileup_);
+        overlays = pileup_distribution(random_generator_);
+    } else {
+        overlays = static_cast<unsigned int>(std::lround(pileup_));
+    }
+    std::uniform_int_distribution<size_t> library_distribution(0, library_.size() - 1);
+    std::uniform_real_distribution<double> offset_distribution(time_offset_min_, time_offset_max_);
+    std::vector<std::pair<size_t, double>> overlay_events;
+    for(unsigned int i = 0; i < overlays; ++i) {
+        auto library_index = library_distribution(random_generator_);
+        auto time_offset = (time_offset_max_ > time_offset_min_ ? offset_distribution(random_generator_) : time_offset_min_);
+        overlay_events.emplace_back(library_index, time_offset);
+        LOG(DEBUG) << "Overlaying library event " << library_index << " with time offset "
+                   << Units::display(time_offset, {"ns", "ps"});
+    }
+
+    // Create the Monte-Carlo particles of all overlaid events first, such that their references remain valid
+    std::map<std::shared_ptr<const Detector>, std::vector<MCParticle>> mc_particles;
+    std::map<std::shared_ptr<const Detector>, size_t> particle_count;
+    for(auto& overlay_event : overlay_events) {
+        for(auto& detector_event : library_[overlay_event.first]) {
+            particle_count[detector_event.first] += detector_event.second.mc_particles.size();
+        }
+    }
+    for(auto& count : particle_count) {
+        mc_particles[count.first].reserve(count.second);
+    }
+
+    for(auto& overlay_event : overlay_events) {
+        auto time_offset = overlay_event.second;
+        for(auto& detector_event : library_[overlay_event.first]) {
+            auto& detector_particles = mc_particles[detector_event.first];
+            auto first_particle = detector_particles.size();
+            for(auto& particle : detector_event.second.mc_particles) {
+                detector_particles.emplace_back(particle.local_start_point,
+                                                particle.global_start_point,
+                                                particle.local_end_point,
+                                                particle.global_end_point,
+                                                particle.particle_id,
+                                                particle.local_time + time_offset,
+                                                particle.global_time + time_offset);
+            }
+            for(size_t i = 0; i < detector_event.second.mc_particles.size(); ++i) {
+                auto parent = detector_event.second.mc_particles[i].parent;
+                if(parent >= 0) {
+                    detector_particles[first_particle + i].setParent(
+                        &detector_particles[first_particle + static_cast<size_t>(parent)]);
+                }
+            }
+
+            auto& detector_deposits = deposits[detector_event.first];
+            for(auto& deposit : detector_event.second.deposits) {
+                const MCParticle* mc_particle = nullptr;
+                if(deposit.mc_particle >= 0) {
+                    mc_particle = &detector_particles[first_particle + static_cast<size_t>(deposit.mc_particle)];
+                }
+                detector_deposits.emplace_back(deposit.local_position,
+                                               deposit.global_position,
+                                               deposit.type,
+                                               deposit.charge,
+                                               deposit.local_time + time_offset,
+                                               deposit.global_time + time_offset,
+                                               mc_particle);
+            }
+        }
+    }
+    total_overlays_ += overlays;
+
+    // Dispatch the particles of the overlaid events and the merged deposits
+    for(auto& detector_particles : mc_particles) {
+        if(detector_particles.second.empty()) {
+            continue;
+        }
+        auto message = std::make_shared<MCParticleMessage>(std::move(detector_particles.second), detector_particles.first);
+        messenger_->dispatchMessage(this, message);
+    }
+    for(auto& detector_deposits : deposits) {
+        if(detector_deposits.second.empty()) {
+            continue;
+        }
+        LOG(DEBUG) << "Dispatching " << detector_deposits.second.size() << " merged deposits for detector "
+                   << detector_deposits.first->getName();
+        auto message =
+            std::make_shared<DepositedChargeMessage>(std::move(detector_deposits.second), detector_deposits.first);
+        messenger_->dispatchMessage(this, message);
+    }
+    LOG(INFO) << "Overlaid " << overlays << " pile-up events";
+}
+
+void PileupOverlayModule::finalize() {
+    LOG(INFO) << "Overlaid " << total_overlays_ << " pile-up events in total";
+}
+
+void PileupOverlayModule::saveState(std::ostream& state) {
+    state << random_generator_;
+}
+
+void PileupOverlayModule::loadState(std::istream& state) {
+    state >> random_generator_;
+}
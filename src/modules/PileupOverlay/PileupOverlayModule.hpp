@@ -0,0 +1,133 @@
+/**
+ * @file
+ * @brief Definition of module overlaying pile-up events from a library of pre-simulated deposits
+ * @copyright Copyright (c) 2020 CERN and the Allpix Squared authors.
+ * This software is distributed under the terms of the MIT License, copied verbatim in the file "LICENSE.md".
+ * In applying this license, CERN does not waive the privileges and immunities granted to it by virtue of its status as an
+ * Intergovernmental Organization or submit itself to any jurisdiction.
+ */
+
+#ifndef ALLPIX_PILEUP_OVERLAY_MODULE_H
+#define ALLPIX_PILEUP_OVERLAY_MODULE_H
+
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <Math/Point3D.h>
+
+#include "core/config/Configuration.hpp"
+#include "core/geometry/GeometryManager.hpp"
+#include "core/messenger/Messenger.hpp"
+#include "core/module/Module.hpp"
+
+#include "objects/DepositedCharge.hpp"
+#include "objects/MCParticle.hpp"
+
+namespace allpix {
+    /**
+     * @ingroup Modules
+     * @brief Module to add the deposits of randomly chosen pile-up events from a library to every event
+     * @note This module supports parallelization
+     *
+     * Loads the deposited charges and Monte-Carlo particles of all events of a data file written by the ROOTObjectWriter
+     * into memory. For every event, a number of library events is chosen at random and their deposits are added to the
+     * deposits of the current event with a random time offset. The merged deposits are dispatched under the output name
+     * of the module, together with the Monte-Carlo particles of the overlaid events.
+     */
+    class PileupOverlayModule : public Module {
+    public:
+        /**
+         * @brief Constructor for this unique module
+         * @param config Configuration object for this module as retrieved from the steering file
+         * @param messenger Pointer to the messenger object to allow binding to messages on the bus
+         * @param geo_manager Pointer to the geometry manager, containing the detectors
+         */
+        PileupOverlayModule(Configuration& config, Messenger* messenger, GeometryManager* geo_manager);
+
+        /**
+         * @brief Load the pile-up events from the library file into memory
+         */
+        void init() override;
+
+        /**
+         * @brief Overlay randomly chosen pile-up events to the deposits of the event
+         */
+        void run(unsigned int event_num) override;
+
+        /**
+         * @brief Output statistics of the overlaid events
+         */
+        void finalize() override;
+
+        /**
+         * @brief Store the state of the random number generator in a checkpoint
+         */
+        void saveState(std::ostream& state) override;
+
+        /**
+         * @brief Restore the state of the random number generator from a checkpoint
+         */
+        void loadState(std::istream& state) override;
+
+    private:
+        /**
+         * @brief Monte-Carlo particle of a library event, with the parent referenced by its index
+         */
+        struct LibraryParticle {
+            ROOT::Math::XYZPoint local_start_point;
+            ROOT::Math::XYZPoint global_start_point;
+            ROOT::Math::XYZPoint local_end_point;
+            ROOT::Math::XYZPoint global_end_point;
+            int particle_id;
+            double local_time;
+            double global_time;
+            int parent;
+        };
+
+        /**
+         * @brief Deposited charge of a library event, with the Monte-Carlo particle referenced by its index
+         */
+        struct LibraryDeposit {
+            ROOT::Math::XYZPoint local_position;
+            ROOT::Math::XYZPoint global_position;
+            CarrierType type;
+            unsigned int charge;
+            double local_time;
+            double global_time;
+            int mc_particle;
+        };
+
+        /**
+         * @brief Particles and deposits of a library event in a single detector
+         */
+        struct LibraryEvent {
+            std::vector<LibraryParticle> mc_particles;
+            std::vector<LibraryDeposit> deposits;
+        };
+
+        std::mt19937_64 random_generator_;
+
+        Messenger* messenger_;
+        GeometryManager* geo_manager_;
+
+        // Messages of the simulated event
+        std::vector<std::shared_ptr<DepositedChargeMessage>> deposit_messages_;
+
+        // Library of pile-up events, with the objects of every event grouped per detector
+        std::vector<std::map<std::shared_ptr<const Detector>, LibraryEvent>> library_;
+
+        // Number of overlaid events and range of their time offsets
+        double pileup_{};
+        bool poisson_pileup_{};
+        double time_offset_min_{};
+        double time_offset_max_{};
+
+        // Statistics
+        unsigned long long total_overlays_{};
+    };
+} // namespace allpix
+
+#endif /* ALLPIX_PILEUP_OVERLAY_MODULE_H */
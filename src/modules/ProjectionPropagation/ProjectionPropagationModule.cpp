@@ -119,7 +119,9 @@ void ProjectionPropagationModule::init() {
     }
 }
 
-void ProjectionPropagationModule::run(unsigned int) {
+void ProjectionPropagationModule::run(unsigned int event_num) {
+    // Seed the random generators for this event if requested
+    seed_event(random_generator_, event_num);
 
     // Create vector of propagated charges to output
     std::vector<PropagatedCharge> propagated_charges;
@@ -147,6 +149,9 @@ void ProjectionPropagationModule::run(unsigned int) {
         unsigned int charges_remaining = deposit.getCharge();
         total_charge += charges_remaining;
 
+        // Look up the electric field through a cursor caching the field cell around this deposit
+        auto field_cursor = detector_->getElectricFieldCursor();
+
         auto charge_per_step = config_.get<unsigned int>("charge_per_step");
         while(charges_remaining > 0) {
             if(charge_per_step > charges_remaining) {
@@ -157,7 +162,7 @@ void ProjectionPropagationModule::run(unsigned int) {
             auto position = initial_position;
 
             // Get the electric field at the position of the deposited charge and the top of the sensor:
-            auto efield = detector_->getElectricField(position);
+            auto efield = field_cursor.get(position);
             double efield_mag = std::sqrt(efield.Mag2());
             auto efield_top = detector_->getElectricField(ROOT::Math::XYZPoint(0., 0., top_z_));
             double efield_mag_top = std::sqrt(efield_top.Mag2());
@@ -194,7 +199,7 @@ void ProjectionPropagationModule::run(unsigned int) {
 
                 auto local_position_diffusion = position + diffusion_vec;
 
-                auto efield_diffusion = detector_->getElectricField(local_position_diffusion);
+                auto efield_diffusion = field_cursor.get(local_position_diffusion);
                 double efield_mag_diffusion = std::sqrt(efield_diffusion.Mag2());
 
                 if(efield_mag_diffusion < std::numeric_limits<double>::epsilon() && (detector_->isWithinSensor(position))) {
@@ -203,13 +208,13 @@ void ProjectionPropagationModule::run(unsigned int) {
                 }
 
                 std::function<ROOT::Math::XYZPoint(const ROOT::Math::XYZPoint&, const ROOT::Math::XYZPoint&)> interval;
-                interval = [this, &interval](const ROOT::Math::XYZPoint& start,
-                                             const ROOT::Math::XYZPoint& stop) -> ROOT::Math::XYZPoint {
+                interval = [&field_cursor, &interval](const ROOT::Math::XYZPoint& start,
+                                                      const ROOT::Math::XYZPoint& stop) -> ROOT::Math::XYZPoint {
                     // Break nested intervals at a precision of 0.01 um
                     if(std::sqrt((stop - ROOT::Math::XYZVector(start)).Mag2()) < 0.00001) {
                         return stop;
                     }
-                    auto efield_center = detector_->getElectricField((stop + ROOT::Math::XYZVector(start)) / 2.);
+                    auto efield_center = field_cursor.get((stop + ROOT::Math::XYZVector(start)) / 2.);
                     double efield_center_mag = std::sqrt(efield_center.Mag2());
                     if(efield_center_mag > std::numeric_limits<double>::epsilon()) {
                         return interval(start, (stop + ROOT::Math::XYZVector(start)) / 2.);
@@ -219,7 +224,7 @@ void ProjectionPropagationModule::run(unsigned int) {
                 };
 
                 position = interval(position, local_position_diffusion);
-                efield = detector_->getElectricField(position);
+                efield = field_cursor.get(position);
                 efield_mag = std::sqrt(efield.Mag2());
                 diffusion_time = integration_time_ * std::sqrt((position - initial_position).Mag2() /
                                                                (local_position_diffusion - initial_position).Mag2());
@@ -335,3 +340,11 @@ void ProjectionPropagationModule::finalize() {
         }
     }
 }
+
+void ProjectionPropagationModule::saveState(std::ostream& state) {
+    state << random_generator_;
+}
+
+void ProjectionPropagationModule::loadState(std::istream& state) {
+    state >> random_generator_;
+}
@@ -9,15 +9,19 @@
 
 #include "ROOTObjectReaderModule.hpp"
 
+#include <algorithm>
 #include <climits>
 #include <string>
 #include <utility>
 
+#include <RConfigure.h>
 #include <TBranch.h>
 #include <TKey.h>
 #include <TObjArray.h>
 #include <TProcessID.h>
+#include <TROOT.h>
 #include <TTree.h>
+#include <TTreeCache.h>
 
 #include "core/messenger/Messenger.hpp"
 #include "core/utils/file.h"
@@ -114,6 +118,37 @@ void ROOTObjectReaderModule::init() {
         exclude_.insert(exc_arr.begin(), exc_arr.end());
     }
 
+    // Read include and exclude list of detectors
+    if(config_.has("include_detectors") && config_.has("exclude_detectors")) {
+        throw InvalidCombinationError(config_,
+                                      {"exclude_detectors", "include_detectors"},
+                                      "include_detectors and exclude_detectors parameter are mutually exclusive");
+    } else if(config_.has("include_detectors")) {
+        auto inc_arr = config_.getArray<std::string>("include_detectors");
+        include_detectors_.insert(inc_arr.begin(), inc_arr.end());
+    } else if(config_.has("exclude_detectors")) {
+        auto exc_arr = config_.getArray<std::string>("exclude_detectors");
+        exclude_detectors_.insert(exc_arr.begin(), exc_arr.end());
+    }
+
+    config_.setDefault<bool>("prefetch", false);
+    auto prefetch = config_.get<bool>("prefetch");
+
+    // Enable parallel decompression of the baskets if requested, the implicit multithreading is global to the process
+    config_.setDefault<unsigned int>("unzip_threads", 0);
+    auto unzip_threads = config_.get<unsigned int>("unzip_threads");
+    if(unzip_threads > 0) {
+#ifdef R__USE_IMT
+        if(!ROOT::IsImplicitMTEnabled()) {
+            LOG(INFO) << "Enabling implicit multithreading of ROOT for the whole process with " << unzip_threads
+                      << " threads";
+            ROOT::EnableImplicitMT(unzip_threads);
+        }
+#else
+        LOG(WARNING) << "ROOT has been built without implicit multithreading support, cannot decompress in parallel";
+#endif
+    }
+
     // Initialize the call map from the tuple of available objects
     message_creator_map_ = gen_creator_map<allpix::OBJECTS>();
 
@@ -194,20 +229,47 @@ void ROOTObjectReaderModule::init() {
                      << " - this might lead to unexpected behavior.";
     }
 
+    // Entries in the file are counted from the first event of the run which produced it
+    std::string* first_event_str = nullptr;
+    input_file_->GetObject("config/Allpix/first_event", first_event_str);
+    if(first_event_str != nullptr) {
+        file_first_event_ = allpix::from_string<unsigned int>(*first_event_str);
+    }
+    auto first_event = global_config.get<unsigned int>("first_event");
+    auto last_event = global_config.get<unsigned int>("last_event");
+    if(first_event < file_first_event_) {
+        throw InvalidValueError(global_config,
+                                "first_event",
+                                "input data only contains events starting from event " + std::to_string(file_first_event_));
+    }
+
+    // Entries of files with rejected events cannot be mapped to event numbers, only read them in order from the start
+    std::string* rejected_events_str = nullptr;
+    input_file_->GetObject("rejected_events", rejected_events_str);
+    if(rejected_events_str != nullptr) {
+        auto rejected_events = *rejected_events_str;
+        delete rejected_events_str;
+        if(first_event != file_first_event_) {
+            throw InvalidValueError(global_config,
+                                    "first_event",
+                                    "input data misses " + rejected_events +
+                                        " events rejected by modules, its entries can only be read starting from event " +
+                                        std::to_string(file_first_event_));
+        }
+        LOG(WARNING) << "Input data misses " << rejected_events
+                     << " events rejected by modules, entries are read in order and do not correspond to the event numbers "
+                        "of the run which produced them";
+    }
+
     // Loop over all found trees
     for(auto& tree : trees_) {
         // Loop over the list of branches and create the set of receiver objects
         TObjArray* branches = tree->GetListOfBranches();
+        bool tree_active = false;
         for(int i = 0; i < branches->GetEntries(); i++) {
             auto* branch = static_cast<TBranch*>(branches->At(i));
 
-            // Add a new vector of objects and bind it to the branch
-            message_info message_inf;
-            message_inf.objects = new std::vector<Object*>;
-            message_info_array_.emplace_back(message_inf);
-            branch->SetAddress(&(message_info_array_.back().objects));
-
-            // Fill the rest of the message information
+            // Fetch the message information
             // FIXME: we want to index this in a different way
             std::string branch_name = branch->GetName();
             auto split = allpix::split<std::string>(branch_name, "_");
@@ -241,6 +303,24 @@ void ROOTObjectReaderModule::init() {
                 throw ModuleError("Tree contains objects of the wrong type");
             }
 
+            // Disable branches of detectors which should not be read, objects without detector are always read
+            if(det_idx != INT_MAX && split[det_idx] != "global" &&
+               ((!include_detectors_.empty() && include_detectors_.find(split[det_idx]) == include_detectors_.end()) ||
+                (!exclude_detectors_.empty() && exclude_detectors_.find(split[det_idx]) != exclude_detectors_.end()))) {
+                LOG(TRACE) << "Disabling branch " << branch_name << " of tree " << tree->GetName()
+                           << " because its detector has been excluded or not explicitly included";
+                tree->SetBranchStatus(branch_name.c_str(), false);
+                continue;
+            }
+
+            // Add a new vector of objects and bind it to the branch
+            message_info message_inf;
+            message_inf.objects = new std::vector<Object*>;
+            message_info_array_.emplace_back(message_inf);
+            branch->SetAddress(&(message_info_array_.back().objects));
+            tree_active = true;
+
+            // Fill the rest of the message information
             if(name_idx != INT_MAX) {
                 message_info_array_.back().name = split[name_idx];
             }
@@ -250,17 +330,51 @@ void ROOTObjectReaderModule::init() {
                 }
             }
         }
+
+        // Do not read trees without any active branch
+        if(!tree_active) {
+            LOG(TRACE) << "Ignoring tree with " << tree->GetName() << " objects because all its branches are disabled";
+            tree = nullptr;
+        }
+    }
+    trees_.erase(std::remove(trees_.begin(), trees_.end(), nullptr), trees_.end());
+
+    // Set up the read cache for all active branches, such that each cluster is read with a single request
+    for(auto& tree : trees_) {
+        if(config_.has("cache_size")) {
+            tree->SetCacheSize(config_.get<Long64_t>("cache_size"));
+        }
+        tree->AddBranchToCache("*", true);
+        tree->StopCacheLearningPhase();
+        // Skip the clusters outside the range of events to simulate
+        tree->SetCacheEntryRange(first_event - file_first_event_, last_event - file_first_event_ + 1);
+
+        // Read all baskets of a cluster ahead and decompress them in parallel if enabled
+        tree->SetClusterPrefetch(prefetch);
+        if(prefetch) {
+            // Only the cache of this tree reads ahead asynchronously, other files of the process are not affected
+            auto* cache = tree->GetReadCache(input_file_.get());
+            if(cache != nullptr) {
+                LOG(DEBUG) << "Enabling asynchronous prefetching for tree with " << tree->GetName() << " objects";
+                cache->SetEnablePrefetching(true);
+            } else {
+                LOG(WARNING) << "Tree with " << tree->GetName() << " objects has no read cache, cannot prefetch";
+            }
+        }
+#ifdef R__USE_IMT
+        tree->SetImplicitMT(unzip_threads > 0);
+#endif
     }
 }
 
 void ROOTObjectReaderModule::run(unsigned int event_num) {
-    --event_num;
+    auto entry = event_num - file_first_event_;
     for(auto& tree : trees_) {
-        if(event_num >= tree->GetEntries()) {
+        if(entry >= tree->GetEntries()) {
             throw EndOfRunException("Requesting end of run because TTree only contains data for " +
-                                    std::to_string(event_num) + " events");
+                                    std::to_string(entry) + " events");
         }
-        tree->GetEntry(event_num);
+        tree->GetEntry(entry);
     }
     LOG(TRACE) << "Building messages from stored objects";
 
@@ -294,10 +408,7 @@ void ROOTObjectReaderModule::run(unsigned int event_num) {
 }
 
 void ROOTObjectReaderModule::finalize() {
-    int branch_count = 0;
-    for(auto& tree : trees_) {
-        branch_count += tree->GetListOfBranches()->GetEntries();
-    }
+    auto branch_count = message_info_array_.size();
 
     // Print statistics
     LOG(INFO) << "Read " << read_cnt_ << " objects from " << branch_count << " branches";
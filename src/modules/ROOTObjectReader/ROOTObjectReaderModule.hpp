@@ -80,12 +80,19 @@ namespace allpix {
         std::set<std::string> include_;
         std::set<std::string> exclude_;
 
+        // Detector names to include or exclude from reading
+        std::set<std::string> include_detectors_;
+        std::set<std::string> exclude_detectors_;
+
         // File containing the objects
         std::unique_ptr<TFile> input_file_;
 
         // Object trees in the file
         std::vector<TTree*> trees_;
 
+        // Number of the event stored in the first entry of the trees
+        unsigned int file_first_event_{1};
+
         // List of objects and message information converted from the trees
         std::list<message_info> message_info_array_;
 
@@ -10,6 +10,7 @@
 #include "ROOTObjectWriterModule.hpp"
 
 #include <fstream>
+#include <iomanip>
 #include <string>
 #include <utility>
 
@@ -17,6 +18,7 @@
 #include <TClass.h>
 
 #include "core/config/ConfigReader.hpp"
+#include "core/module/exceptions.h"
 #include "core/utils/file.h"
 #include "core/utils/log.h"
 #include "core/utils/type.h"
@@ -26,6 +28,27 @@
 
 using namespace allpix;
 
+// Name of the tree storing objects of the given class, which is the class name without the allpix namespace
+static std::string get_tree_name(const TClass* cls) {
+    std::string class_name = cls->GetName();
+    std::string apx_namespace = "allpix::";
+    size_t ap_idx = class_name.find(apx_namespace);
+    if(ap_idx != std::string::npos) {
+        class_name.replace(ap_idx, apx_namespace.size(), "");
+    }
+    return class_name;
+}
+
+// Name of the branch storing the objects of a detector and message name
+static std::string get_branch_name(const std::string& detector_name, const std::string& message_name) {
+    std::string branch_name = detector_name.empty() ? "global" : detector_name;
+    if(!message_name.empty()) {
+        branch_name += "_";
+        branch_name += message_name;
+    }
+    return branch_name;
+}
+
 ROOTObjectWriterModule::ROOTObjectWriterModule(Configuration& config, Messenger* messenger, GeometryManager* geo_mgr)
     : Module(config), geo_mgr_(geo_mgr) {
     // Bind to all messages
@@ -45,7 +68,14 @@ void ROOTObjectWriterModule::init() {
     // Create output file
     output_file_name_ =
         createOutputFile(allpix::add_file_extension(config_.get<std::string>("file_name", "data"), "root"), true);
-    output_file_ = std::make_unique<TFile>(output_file_name_.c_str(), "RECREATE");
+    // Continue the existing file if the run is resumed, the trees are attached when restoring the checkpoint
+    auto& global_config = getConfigManager()->getGlobalConfiguration();
+    auto resume = global_config.get<bool>("resume", false) && path_is_file(output_file_name_);
+    checkpointing_ = resume || global_config.get<unsigned int>("checkpoint_interval", 0u) > 0;
+    output_file_ = std::make_unique<TFile>(output_file_name_.c_str(), resume ? "UPDATE" : "RECREATE");
+    if(output_file_->IsZombie()) {
+        throw ModuleError("Cannot open output file " + output_file_name_);
+    }
     output_file_->cd();
 
     // Read include and exclude list
@@ -90,12 +120,7 @@ void ROOTObjectWriterModule::receive(std::shared_ptr<BaseMessage> message, std::
                 auto* cls = TClass::GetClass(typeid(first_object));
 
                 // Remove the allpix prefix
-                std::string class_name = cls->GetName();
-                std::string apx_namespace = "allpix::";
-                size_t ap_idx = class_name.find(apx_namespace);
-                if(ap_idx != std::string::npos) {
-                    class_name.replace(ap_idx, apx_namespace.size(), "");
-                }
+                std::string class_name = get_tree_name(cls);
 
                 // Check if this message should be kept
                 if((!include_.empty() && include_.find(class_name) == include_.end()) ||
@@ -107,6 +132,7 @@ void ROOTObjectWriterModule::receive(std::shared_ptr<BaseMessage> message, std::
 
                 // Add vector of objects to write to the write list
                 write_list_[index_tuple] = new std::vector<Object*>();
+                write_classes_[index_tuple] = cls;
                 auto* addr = &write_list_[index_tuple];
 
                 auto new_tree = (trees_.find(class_name) == trees_.end());
@@ -116,29 +142,30 @@ void ROOTObjectWriterModule::receive(std::shared_ptr<BaseMessage> message, std::
                     trees_.emplace(
                         class_name,
                         std::make_unique<TTree>(class_name.c_str(), (std::string("Tree of ") + class_name).c_str()));
+                    // Automatic saving would store entries beyond the last checkpoint in the file
+                    if(checkpointing_) {
+                        trees_[class_name]->SetAutoSave(0);
+                    }
                 }
 
-                std::string branch_name = detector_name.empty() ? "global" : detector_name;
-                if(!message_name.empty()) {
-                    branch_name += "_";
-                    branch_name += message_name;
-                }
+                std::string branch_name = get_branch_name(detector_name, message_name);
 
                 trees_[class_name]->Bronch(
                     branch_name.c_str(), (std::string("std::vector<") + cls->GetName() + "*>").c_str(), addr);
 
                 // Prefill new tree or new branch with empty records for all events that were missed since the start
-                if(last_event_ > 0) {
+                if(events_written_ > 0) {
                     if(new_tree) {
-                        LOG(DEBUG) << "Pre-filling new tree of " << class_name << " with " << last_event_ << " empty events";
-                        for(unsigned int i = 0; i < last_event_; ++i) {
+                        LOG(DEBUG) << "Pre-filling new tree of " << class_name << " with " << events_written_
+                                   << " empty events";
+                        for(unsigned int i = 0; i < events_written_; ++i) {
                             trees_[class_name]->Fill();
                         }
                     } else {
                         LOG(DEBUG) << "Pre-filling new branch " << branch_name << " of " << class_name << " with "
-                                   << last_event_ << " empty events";
+                                   << events_written_ << " empty events";
                         auto* branch = trees_[class_name]->GetBranch(branch_name.c_str());
-                        for(unsigned int i = 0; i < last_event_; ++i) {
+                        for(unsigned int i = 0; i < events_written_; ++i) {
                             branch->Fill();
                         }
                     }
@@ -159,18 +186,18 @@ void ROOTObjectWriterModule::receive(std::shared_ptr<BaseMessage> message, std::
     }
 }
 
-void ROOTObjectWriterModule::run(unsigned int event) {
+void ROOTObjectWriterModule::run(unsigned int) {
     LOG(TRACE) << "Writing new objects to tree";
     output_file_->cd();
 
-    // Save last event number for trees created later
-    last_event_ = event;
-
     // Fill the tree with the current received messages
     for(auto& tree : trees_) {
         tree.second->Fill();
     }
 
+    // Count the written events for trees created later
+    ++events_written_;
+
     // Clear the current message list
     for(auto& index_data : write_list_) {
         index_data.second->clear();
@@ -189,6 +216,14 @@ void ROOTObjectWriterModule::finalize() {
         branch_count += tree.second->GetListOfBranches()->GetEntries();
     }
 
+    // Remove the directories of a previous run when resuming, they are rewritten with the current configuration
+    for(const auto* dir_name : {"config", "detectors", "models"}) {
+        if(output_file_->GetDirectory(dir_name) != nullptr) {
+            LOG(DEBUG) << "Replacing directory " << dir_name << " written by previous run";
+            output_file_->Delete((std::string(dir_name) + ";*").c_str());
+        }
+    }
+
     // Create main config directory
     TDirectory* config_dir = output_file_->mkdir("config");
     config_dir->cd();
@@ -264,6 +299,15 @@ void ROOTObjectWriterModule::finalize() {
         }
     }
 
+    // Store the number of events rejected before this module, the tree entries do not follow the event numbers then
+    output_file_->cd();
+    auto number_of_events = conf_manager->getGlobalConfiguration().get<unsigned int>("number_of_events");
+    if(number_of_events > events_written_) {
+        auto rejected_events = std::to_string(number_of_events - events_written_);
+        LOG(INFO) << "Storing " << rejected_events << " events rejected by modules without entries in the trees";
+        output_file_->WriteObject(&rejected_events, "rejected_events", "Overwrite");
+    }
+
     // Finish writing to output file
     output_file_->Write();
 
@@ -271,3 +315,59 @@ void ROOTObjectWriterModule::finalize() {
     LOG(STATUS) << "Wrote " << write_cnt_ << " objects to " << branch_count << " branches in file:" << std::endl
                 << output_file_name_;
 }
+
+void ROOTObjectWriterModule::saveState(std::ostream& state) {
+    // Save all trees with the entries written so far, such that the file can be continued from this point
+    for(auto& tree : trees_) {
+        tree.second->AutoSave("SaveSelf FlushBaskets");
+    }
+
+    state << events_written_ << " " << write_cnt_ << " " << write_list_.size();
+    for(auto& index_data : write_classes_) {
+        state << " " << std::quoted(index_data.second->GetName()) << " " << std::quoted(std::get<1>(index_data.first))
+              << " " << std::quoted(std::get<2>(index_data.first));
+    }
+}
+
+void ROOTObjectWriterModule::loadState(std::istream& state) {
+    size_t branch_count = 0;
+    state >> events_written_ >> write_cnt_ >> branch_count;
+
+    for(size_t i = 0; i < branch_count; ++i) {
+        std::string object_class_name, detector_name, message_name;
+        state >> std::quoted(object_class_name) >> std::quoted(detector_name) >> std::quoted(message_name);
+
+        auto* cls = TClass::GetClass(object_class_name.c_str());
+        if(cls == nullptr || cls->GetTypeInfo() == nullptr) {
+            throw ModuleError("Cannot find class " + object_class_name + " stored in checkpoint");
+        }
+        auto class_name = get_tree_name(cls);
+
+        // Attach to the tree as saved with the last checkpoint
+        if(trees_.find(class_name) == trees_.end()) {
+            TTree* tree = nullptr;
+            output_file_->GetObject(class_name.c_str(), tree);
+            if(tree == nullptr || tree->GetEntries() != static_cast<Long64_t>(events_written_)) {
+                throw ModuleError("Output file " + output_file_name_ + " does not contain the tree " + class_name +
+                                  " with " + std::to_string(events_written_) + " events stored in the checkpoint");
+            }
+            tree->SetAutoSave(0);
+            trees_.emplace(class_name, std::unique_ptr<TTree>(tree));
+        }
+
+        // Connect the branch to a new entry of the write list
+        auto index_tuple = std::make_tuple(std::type_index(*cls->GetTypeInfo()), detector_name, message_name);
+        write_list_[index_tuple] = new std::vector<Object*>();
+        write_classes_[index_tuple] = cls;
+        auto branch_name = get_branch_name(detector_name, message_name);
+        auto* vector_cls = TClass::GetClass((std::string("std::vector<") + cls->GetName() + "*>").c_str());
+        if(trees_[class_name]->SetBranchAddress(
+               branch_name.c_str(), &write_list_[index_tuple], nullptr, vector_cls, kOther_t, true) < 0) {
+            throw ModuleError("Cannot attach to branch " + branch_name + " of tree " + class_name + " in output file " +
+                              output_file_name_);
+        }
+    }
+
+    LOG(INFO) << "Continuing to write " << write_list_.size() << " branches in " << trees_.size()
+              << " trees after " << events_written_ << " events in file " << output_file_name_;
+}
@@ -10,6 +10,7 @@
 #include <map>
 #include <string>
 
+#include <TClass.h>
 #include <TFile.h>
 #include <TTree.h>
 
@@ -64,6 +65,16 @@ namespace allpix {
          */
         void finalize() override;
 
+        /**
+         * @brief Flush all trees to the file and store the number of written events and the list of branches in a checkpoint
+         */
+        void saveState(std::ostream& state) override;
+
+        /**
+         * @brief Reattach to the trees in the file and continue writing after the events stored in the checkpoint
+         */
+        void loadState(std::istream& state) override;
+
     private:
         GeometryManager* geo_mgr_;
 
@@ -75,8 +86,8 @@ namespace allpix {
         std::unique_ptr<TFile> output_file_;
         std::string output_file_name_{};
 
-        // Last event processed
-        unsigned int last_event_{0};
+        // Number of events written, which can differ from the event number if the run does not start at the first event
+        unsigned int events_written_{0};
 
         // List of trees that are stored in data file
         std::map<std::string, std::unique_ptr<TTree>> trees_;
@@ -85,6 +96,11 @@ namespace allpix {
         std::vector<std::shared_ptr<BaseMessage>> keep_messages_;
         // List of objects of a particular type, bound to a specific detector and having a particular name
         std::map<std::tuple<std::type_index, std::string, std::string>, std::vector<Object*>*> write_list_;
+        // Class of the objects in every entry of the write list, required to restore the branches from a checkpoint
+        std::map<std::tuple<std::type_index, std::string, std::string>, TClass*> write_classes_;
+
+        // Trees are only saved to the file on checkpoints if checkpointing is enabled
+        bool checkpointing_{};
 
         // Statistical information about number of objects
         unsigned long write_cnt_{};
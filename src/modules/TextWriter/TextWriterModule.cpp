@@ -9,7 +9,11 @@
 
 #include "TextWriterModule.hpp"
 
+#include <unistd.h>
+
+#include <algorithm>
 #include <fstream>
+#include <sstream>
 #include <string>
 #include <utility>
 
@@ -29,11 +33,23 @@ using namespace allpix;
 TextWriterModule::TextWriterModule(Configuration& config, Messenger* messenger, GeometryManager*) : Module(config) {
     // Bind to all messages
     messenger->registerListener(this, &TextWriterModule::receive);
+
+    config_.setDefault<std::string>("compression", "none");
+    config_.setDefault<bool>("asynchronous", false);
+    config_.setDefault<size_t>("max_queued_events", 64);
 }
 /**
  * @note Objects cannot be stored in smart pointers due to internal ROOT logic
  */
 TextWriterModule::~TextWriterModule() {
+    // Stop the writer thread and close the compressed stream if the run has been aborted
+    stop_writer();
+#ifdef ALLPIX_TEXTWRITER_ZLIB
+    if(compressed_file_ != nullptr) {
+        gzclose(compressed_file_);
+    }
+#endif
+
     // Delete all object pointers
     for(auto& index_data : write_list_) {
         delete index_data.second;
@@ -41,12 +57,68 @@ TextWriterModule::~TextWriterModule() {
 }
 
 void TextWriterModule::init() {
-    // Create output file
-    output_file_name_ =
-        createOutputFile(allpix::add_file_extension(config_.get<std::string>("file_name", "data"), "txt"), true);
-    output_file_ = std::make_unique<std::ofstream>(output_file_name_);
+    // Create output file, compressed files get an additional extension
+    auto compression = config_.get<std::string>("compression");
+    std::transform(compression.begin(), compression.end(), compression.begin(), ::tolower);
+    auto file_name = allpix::add_file_extension(config_.get<std::string>("file_name", "data"), "txt");
+    if(compression == "gzip") {
+#ifdef ALLPIX_TEXTWRITER_ZLIB
+        compress_ = true;
+        file_name += ".gz";
+#else
+        throw InvalidValueError(config_, "compression", "module has been built without support for gzip compression");
+#endif
+    } else if(compression != "none") {
+        throw InvalidValueError(config_, "compression", "compression should be either 'none' or 'gzip'");
+    }
+    output_file_name_ = createOutputFile(file_name, true);
+
+    // Keep the existing file if the run is resumed, it is truncated to the checkpoint when restoring it
+    auto resume = getConfigManager()->getGlobalConfiguration().get<bool>("resume", false) && path_is_file(output_file_name_);
+    if(compress_) {
+#ifdef ALLPIX_TEXTWRITER_ZLIB
+        if(resume) {
+            throw ModuleError("Compressed output file " + output_file_name_ + " cannot be continued when resuming a run");
+        }
+        compressed_file_ = gzopen(output_file_name_.c_str(), "wb");
+        if(compressed_file_ == nullptr) {
+            throw ModuleError("Cannot open compressed output file " + output_file_name_);
+        }
+#endif
+    } else if(resume) {
+        output_file_ = std::make_unique<std::ofstream>(output_file_name_, std::ios_base::app);
+    } else {
+        output_file_ = std::make_unique<std::ofstream>(output_file_name_);
+    }
+    if(!resume) {
+        write_block("# Allpix Squared ASCII data - https://cern.ch/allpix-squared\n\n");
+    }
 
-    *output_file_ << "# Allpix Squared ASCII data - https://cern.ch/allpix-squared" << std::endl << std::endl;
+    // Start the thread writing the events to file
+    if(config_.get<bool>("asynchronous")) {
+        max_queued_events_ = std::max<size_t>(config_.get<size_t>("max_queued_events"), 1);
+        writer_thread_ = std::thread([this]() {
+            std::unique_lock<std::mutex> lock(writer_mutex_);
+            while(true) {
+                writer_condition_.wait(lock, [this]() { return !write_queue_.empty() || stop_writer_; });
+                if(write_queue_.empty()) {
+                    break;
+                }
+
+                // Write the oldest block without holding the lock
+                auto block = std::move(write_queue_.front());
+                write_queue_.pop_front();
+                writing_ = true;
+                lock.unlock();
+                writer_condition_.notify_all();
+                write_block(block);
+                lock.lock();
+                writing_ = false;
+                writer_condition_.notify_all();
+            }
+        });
+        LOG(DEBUG) << "Writing events asynchronously with at most " << max_queued_events_ << " queued events";
+    }
 
     // Read include and exclude list
     if(config_.has("include") && config_.has("exclude")) {
@@ -108,26 +180,32 @@ void TextWriterModule::receive(std::shared_ptr<BaseMessage> message, std::string
     }
 }
 
+/**
+ * The objects are formatted during the event, as their references to other objects can only be resolved as long as the
+ * event is processed. Only the writing of the formatted text is left to the writer thread.
+ */
 void TextWriterModule::run(unsigned int event_num) {
     LOG(TRACE) << "Writing new objects to text file";
 
     // Print the current event:
-    *output_file_ << "=== " << event_num << " ===" << std::endl;
+    std::ostringstream block;
+    block << "=== " << event_num << " ===\n";
 
     for(auto& message : keep_messages_) {
         // Print the current detector:
         if(message->getDetector() != nullptr) {
-            *output_file_ << "--- " << message->getDetector()->getName() << " ---" << std::endl;
+            block << "--- " << message->getDetector()->getName() << " ---\n";
         } else {
-            *output_file_ << "--- <global> ---" << std::endl;
+            block << "--- <global> ---\n";
         }
         for(auto& object : message->getObjectArray()) {
             // Print the object's ASCII representation:
-            *output_file_ << object << std::endl;
+            block << object << '\n';
             write_cnt_++;
         }
         msg_cnt_++;
     }
+    write(block.str());
 
     // Clear the messages we have to keep because they contain the internal pointers
     keep_messages_.clear();
@@ -135,9 +213,101 @@ void TextWriterModule::run(unsigned int event_num) {
 
 void TextWriterModule::finalize() {
     // Finish writing to output file
-    *output_file_ << "# " << write_cnt_ << " objects from " << msg_cnt_ << " messages" << std::endl;
+    write("# " + std::to_string(write_cnt_) + " objects from " + std::to_string(msg_cnt_) + " messages\n");
+    stop_writer();
+#ifdef ALLPIX_TEXTWRITER_ZLIB
+    if(compressed_file_ != nullptr) {
+        gzclose(compressed_file_);
+        compressed_file_ = nullptr;
+    }
+#endif
+    if(output_file_ != nullptr) {
+        output_file_->flush();
+    }
 
     // Print statistics
     LOG(STATUS) << "Wrote " << write_cnt_ << " objects from " << msg_cnt_ << " messages to file:" << std::endl
                 << output_file_name_;
 }
+
+/**
+ * The position in a compressed file is not stored, as compressed files cannot be truncated to continue them
+ */
+void TextWriterModule::saveState(std::ostream& state) {
+    flush();
+    long long position = -1;
+    if(output_file_ != nullptr) {
+        position = static_cast<long long>(output_file_->tellp());
+    }
+    state << position << " " << write_cnt_ << " " << msg_cnt_;
+}
+
+void TextWriterModule::loadState(std::istream& state) {
+    long long position = 0;
+    state >> position >> write_cnt_ >> msg_cnt_;
+    if(position < 0 || output_file_ == nullptr) {
+        throw ModuleError("Output file " + output_file_name_ + " cannot be continued from the checkpoint");
+    }
+
+    // Remove everything written after the checkpoint and append from there
+    output_file_->close();
+    if(::truncate(output_file_name_.c_str(), static_cast<off_t>(position)) != 0) {
+        throw ModuleError("Cannot truncate output file " + output_file_name_ + " to the checkpoint");
+    }
+    output_file_->open(output_file_name_, std::ios_base::app);
+}
+
+void TextWriterModule::write(std::string block) {
+    if(!writer_thread_.joinable()) {
+        write_block(block);
+        return;
+    }
+
+    // Wait for the writer thread if too many events are queued already
+    std::unique_lock<std::mutex> lock(writer_mutex_);
+    writer_condition_.wait(lock, [this]() { return write_queue_.size() < max_queued_events_; });
+    write_queue_.push_back(std::move(block));
+    lock.unlock();
+    writer_condition_.notify_all();
+}
+
+void TextWriterModule::write_block(const std::string& block) {
+#ifdef ALLPIX_TEXTWRITER_ZLIB
+    if(compressed_file_ != nullptr) {
+        auto written = gzwrite(compressed_file_, block.data(), static_cast<unsigned int>(block.size()));
+        if(written != static_cast<int>(block.size())) {
+            LOG(ERROR) << "Failed to write to compressed output file " << output_file_name_;
+        }
+        return;
+    }
+#endif
+    output_file_->write(block.data(), static_cast<std::streamsize>(block.size()));
+}
+
+void TextWriterModule::flush() {
+    if(writer_thread_.joinable()) {
+        std::unique_lock<std::mutex> lock(writer_mutex_);
+        writer_condition_.wait(lock, [this]() { return write_queue_.empty() && !writing_; });
+    }
+#ifdef ALLPIX_TEXTWRITER_ZLIB
+    if(compressed_file_ != nullptr) {
+        gzflush(compressed_file_, Z_SYNC_FLUSH);
+    }
+#endif
+    if(output_file_ != nullptr) {
+        output_file_->flush();
+    }
+}
+
+void TextWriterModule::stop_writer() {
+    if(!writer_thread_.joinable()) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(writer_mutex_);
+        stop_writer_ = true;
+    }
+    writer_condition_.notify_all();
+    writer_thread_.join();
+}
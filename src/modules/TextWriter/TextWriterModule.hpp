@@ -7,9 +7,17 @@
  * Intergovernmental Organization or submit itself to any jurisdiction.
  */
 
+#include <condition_variable>
+#include <deque>
 #include <fstream>
 #include <map>
+#include <mutex>
 #include <string>
+#include <thread>
+
+#ifdef ALLPIX_TEXTWRITER_ZLIB
+#include <zlib.h>
+#endif
 
 #include "core/config/Configuration.hpp"
 #include "core/geometry/GeometryManager.hpp"
@@ -21,7 +29,9 @@ namespace allpix {
      * @ingroup Modules
      * @brief Module to write object data to simple ASCII text files
      *
-     * Listens to all objects dispatched in the framework and stores an ASCII representation of every object to file.
+     * Listens to all objects dispatched in the framework and stores an ASCII representation of every object to file. The
+     * objects of an event are formatted into a single block of text which is written at once, optionally compressed and
+     * from a separate thread such that the event loop does not wait for the file.
      */
     class TextWriterModule : public Module {
     public:
@@ -60,7 +70,36 @@ namespace allpix {
          */
         void finalize() override;
 
+        /**
+         * @brief Flush the file and store the current position in the file in a checkpoint
+         */
+        void saveState(std::ostream& state) override;
+
+        /**
+         * @brief Discard all output written after the checkpoint and continue writing from there
+         */
+        void loadState(std::istream& state) override;
+
     private:
+        /**
+         * @brief Write a block of text to the file, or queue it for the writer thread if writing asynchronously
+         * @param block Text to write
+         */
+        void write(std::string block);
+        /**
+         * @brief Write a block of text directly to the (compressed) file
+         * @param block Text to write
+         */
+        void write_block(const std::string& block);
+        /**
+         * @brief Wait until all queued blocks are written and flush the file
+         */
+        void flush();
+        /**
+         * @brief Stop the writer thread after writing all queued blocks
+         */
+        void stop_writer();
+
         // Object names to include or exclude from writing
         std::set<std::string> include_;
         std::set<std::string> exclude_;
@@ -68,6 +107,19 @@ namespace allpix {
         // Output data file to write
         std::string output_file_name_{};
         std::unique_ptr<std::ofstream> output_file_;
+#ifdef ALLPIX_TEXTWRITER_ZLIB
+        gzFile compressed_file_{};
+#endif
+        bool compress_{};
+
+        // Thread writing the queued blocks of text to the file
+        std::thread writer_thread_;
+        std::mutex writer_mutex_;
+        std::condition_variable writer_condition_;
+        std::deque<std::string> write_queue_;
+        size_t max_queued_events_{};
+        bool writing_{};
+        bool stop_writer_{};
 
         // List of messages to keep so they can be stored in the tree
         std::vector<std::shared_ptr<BaseMessage>> keep_messages_;
@@ -29,6 +29,7 @@ TransientPropagationModule::TransientPropagationModule(Configuration& config,
                                                        std::shared_ptr<Detector> detector)
     : Module(config, detector), detector_(std::move(detector)), messenger_(messenger) {
     using XYVectorInt = DisplacementVector2D<Cartesian2D<int>>;
+    using XYZVectorInt = DisplacementVector3D<Cartesian3D<int>>;
 
     // Enable parallelization of this module if multithreading is enabled:
     enable_parallelization();
@@ -50,6 +51,10 @@ TransientPropagationModule::TransientPropagationModule(Configuration& config,
     config_.setDefault<bool>("output_plots", false);
     config_.setDefault<XYVectorInt>("induction_matrix", XYVectorInt(3, 3));
     config_.setDefault<bool>("ignore_magnetic_field", false);
+    config_.setDefault<bool>("counter_based_random", false);
+    config_.setDefault<double>("induction_threshold", 0.);
+    config_.setDefault<bool>("precompute_weighting_field", false);
+    config_.setDefault<XYZVectorInt>("weighting_field_granularity", XYZVectorInt(10, 10, 100));
 
     // Copy some variables from configuration to avoid lookups:
     temperature_ = config_.get<double>("temperature");
@@ -61,8 +66,24 @@ TransientPropagationModule::TransientPropagationModule(Configuration& config,
         throw InvalidValueError(config_, "induction_matrix", "Odd number of pixels in x and y required.");
     }
 
+    induction_threshold_ = config_.get<double>("induction_threshold");
+    precompute_gradient_ = config_.get<bool>("precompute_weighting_field");
+    auto granularity = config_.get<XYZVectorInt>("weighting_field_granularity");
+    if(granularity.x() < 1 || granularity.y() < 1 || granularity.z() < 1) {
+        throw InvalidValueError(config_, "weighting_field_granularity", "Number of bins has to be positive.");
+    }
+    gradient_bins_ = {{static_cast<size_t>(granularity.x() * (matrix_.x() + 2)),
+                       static_cast<size_t>(granularity.y() * (matrix_.y() + 2)),
+                       static_cast<size_t>(granularity.z())}};
+
     output_plots_ = config_.get<bool>("output_plots");
 
+    // Draw diffusion from batches of normal numbers generated with the counter-based engine if requested
+    counter_based_random_ = config_.get<bool>("counter_based_random");
+    if(counter_based_random_) {
+        normal_sampler_.reset(getRandomEngine());
+    }
+
     // Parameterization variables from https://doi.org/10.1016/0038-1101(77)90054-5 (section 5.2)
     electron_Vm_ = Units::get(1.53e9 * std::pow(temperature_, -0.87), "cm/s");
     electron_Ec_ = Units::get(1.01 * std::pow(temperature_, 1.55), "V/cm");
@@ -109,6 +130,10 @@ void TransientPropagationModule::init() {
         }
     }
 
+    if(precompute_gradient_) {
+        precompute_weighting_potential_gradient();
+    }
+
     if(output_plots_) {
         potential_difference_ =
             new TH1D("potential_difference",
@@ -145,7 +170,85 @@ void TransientPropagationModule::init() {
     }
 }
 
-void TransientPropagationModule::run(unsigned int) {
+/**
+ * The weighting potential only depends on the position relative to the pixel it is calculated for. Its gradient is
+ * therefore sampled once relative to a single pixel, on a grid extending one pixel beyond the induction matrix in x and y
+ * and covering the full sensor thickness. The gradient in every bin is obtained from the difference of the weighting
+ * potential at the bin boundaries, such that it should not be chosen finer than the granularity of the potential itself.
+ */
+void TransientPropagationModule::precompute_weighting_potential_gradient() {
+    pixel_pitch_ = model_->getPixelSize();
+    gradient_origin_ = {{-(matrix_.x() / 2 + 1) * pixel_pitch_.x(),
+                         -(matrix_.y() / 2 + 1) * pixel_pitch_.y(),
+                         model_->getSensorCenter().z() - model_->getSensorSize().z() / 2.0}};
+    gradient_bin_size_ = {{pixel_pitch_.x() * (matrix_.x() + 2) / static_cast<double>(gradient_bins_[0]),
+                           pixel_pitch_.y() * (matrix_.y() + 2) / static_cast<double>(gradient_bins_[1]),
+                           model_->getSensorSize().z() / static_cast<double>(gradient_bins_[2])}};
+
+    LOG(INFO) << "Precomputing weighting potential gradient on a grid of " << gradient_bins_[0] << "x" << gradient_bins_[1]
+              << "x" << gradient_bins_[2] << " bins";
+
+    Pixel::Index reference(0, 0);
+    potential_gradient_.resize(gradient_bins_[0] * gradient_bins_[1] * gradient_bins_[2] * 3);
+    size_t index = 0;
+    for(size_t i = 0; i < gradient_bins_[0]; ++i) {
+        auto x = gradient_origin_[0] + (static_cast<double>(i) + 0.5) * gradient_bin_size_[0];
+        for(size_t j = 0; j < gradient_bins_[1]; ++j) {
+            auto y = gradient_origin_[1] + (static_cast<double>(j) + 0.5) * gradient_bin_size_[1];
+            for(size_t k = 0; k < gradient_bins_[2]; ++k) {
+                auto z = gradient_origin_[2] + (static_cast<double>(k) + 0.5) * gradient_bin_size_[2];
+
+                auto dx = gradient_bin_size_[0] / 2.0;
+                auto dy = gradient_bin_size_[1] / 2.0;
+                auto dz = gradient_bin_size_[2] / 2.0;
+                potential_gradient_[index++] = (detector_->getWeightingPotential(XYZPoint(x + dx, y, z), reference) -
+                                                detector_->getWeightingPotential(XYZPoint(x - dx, y, z), reference)) /
+                                               gradient_bin_size_[0];
+                potential_gradient_[index++] = (detector_->getWeightingPotential(XYZPoint(x, y + dy, z), reference) -
+                                                detector_->getWeightingPotential(XYZPoint(x, y - dy, z), reference)) /
+                                               gradient_bin_size_[1];
+                potential_gradient_[index++] = (detector_->getWeightingPotential(XYZPoint(x, y, z + dz), reference) -
+                                                detector_->getWeightingPotential(XYZPoint(x, y, z - dz), reference)) /
+                                               gradient_bin_size_[2];
+            }
+        }
+    }
+}
+
+/**
+ * The difference is calculated from the gradient in the middle of the step, which is exact for a weighting potential
+ * varying linearly along the step. Outside the grid in x and y the weighting potential is assumed to be constant, while
+ * along z the gradient of the closest bin is used, following the extrapolation of the weighting potential itself.
+ */
+double TransientPropagationModule::get_weighting_potential_difference(const ROOT::Math::XYZPoint& midpoint,
+                                                                      const ROOT::Math::XYZVector& displacement,
+                                                                      const Pixel::Index& pixel) const {
+    std::array<double, 3> position{{midpoint.x() - pixel_pitch_.x() * pixel.x(),
+                                    midpoint.y() - pixel_pitch_.y() * pixel.y(),
+                                    midpoint.z()}};
+
+    size_t index = 0;
+    for(size_t i = 0; i < 3; ++i) {
+        auto bin = static_cast<int>(std::floor((position[i] - gradient_origin_[i]) / gradient_bin_size_[i]));
+        if(i == 2) {
+            bin = std::max(0, std::min(bin, static_cast<int>(gradient_bins_[2]) - 1));
+        } else if(bin < 0 || bin >= static_cast<int>(gradient_bins_[i])) {
+            return 0;
+        }
+        index = index * gradient_bins_[i] + static_cast<size_t>(bin);
+    }
+
+    return potential_gradient_[3 * index] * displacement.x() + potential_gradient_[3 * index + 1] * displacement.y() +
+           potential_gradient_[3 * index + 2] * displacement.z();
+}
+
+void TransientPropagationModule::run(unsigned int event_num) {
+    // Seed the random generators for this event if requested
+    seed_event(random_generator_, event_num);
+    // Derive a separate seed for the diffusion sampler, such that it is not correlated with the generator
+    if(isSeededPerEvent()) {
+        normal_sampler_.seed(RandomEngine(getEventSeed(event_num), 1)());
+    }
 
     // Create vector of propagated charges to output
     std::vector<PropagatedCharge> propagated_charges;
@@ -240,32 +343,34 @@ std::pair<ROOT::Math::XYZPoint, double> TransientPropagationModule::propagate(co
         double diffusion_std_dev = std::sqrt(2. * diffusion_constant * timestep);
 
         // Compute the independent diffusion in three
-        std::normal_distribution<double> gauss_distribution(0, diffusion_std_dev);
         Eigen::Vector3d diffusion;
-        for(int i = 0; i < 3; ++i) {
-            diffusion[i] = gauss_distribution(random_generator_);
+        if(counter_based_random_) {
+            for(int i = 0; i < 3; ++i) {
+                diffusion[i] = normal_sampler_(0, diffusion_std_dev);
+            }
+        } else {
+            std::normal_distribution<double> gauss_distribution(0, diffusion_std_dev);
+            for(int i = 0; i < 3; ++i) {
+                diffusion[i] = gauss_distribution(random_generator_);
+            }
         }
         return diffusion;
     };
 
-    // Define lambda functions to compute the charge carrier velocity with or without magnetic field
-    std::function<Eigen::Vector3d(double, const Eigen::Vector3d&)> carrier_velocity_noB =
-        [&](double, const Eigen::Vector3d& cur_pos) -> Eigen::Vector3d {
-        auto raw_field = detector_->getElectricField(static_cast<ROOT::Math::XYZPoint>(cur_pos));
-        Eigen::Vector3d efield(raw_field.x(), raw_field.y(), raw_field.z());
-
-        return static_cast<int>(type) * carrier_mobility(efield.norm()) * efield;
-    };
+    // Look up the electric field through a cursor caching the field cell along the path of this carrier
+    auto field_cursor = detector_->getElectricFieldCursor();
 
-    std::function<Eigen::Vector3d(double, const Eigen::Vector3d&)> carrier_velocity_withB =
-        [&](double, const Eigen::Vector3d& cur_pos) -> Eigen::Vector3d {
-        auto raw_field = detector_->getElectricField(static_cast<ROOT::Math::XYZPoint>(cur_pos));
+    // Define a lambda function to compute the charge carrier velocity with or without magnetic field
+    auto carrier_velocity = [&](double, const Eigen::Vector3d& cur_pos) -> Eigen::Vector3d {
+        auto raw_field = field_cursor.get(static_cast<ROOT::Math::XYZPoint>(cur_pos));
         Eigen::Vector3d efield(raw_field.x(), raw_field.y(), raw_field.z());
 
-        Eigen::Vector3d velocity;
-        Eigen::Vector3d bfield(magnetic_field_.x(), magnetic_field_.y(), magnetic_field_.z());
-
         auto mob = carrier_mobility(efield.norm());
+        if(!has_magnetic_field_) {
+            return static_cast<int>(type) * mob * efield;
+        }
+
+        Eigen::Vector3d bfield(magnetic_field_.x(), magnetic_field_.y(), magnetic_field_.z());
         auto exb = efield.cross(bfield);
 
         Eigen::Vector3d term1;
@@ -278,9 +383,8 @@ std::pair<ROOT::Math::XYZPoint, double> TransientPropagationModule::propagate(co
         return static_cast<int>(type) * mob * (efield + term1 + term2) / rnorm;
     };
 
-    // Create the runge kutta solver with an RKF5 tableau
-    auto runge_kutta = make_runge_kutta(
-        tableau::RK5, (has_magnetic_field_ ? carrier_velocity_withB : carrier_velocity_noB), timestep_, position);
+    // Create the runge kutta solver with a compile-time RKF5 tableau
+    auto runge_kutta = make_runge_kutta<tableau::Fehlberg5>(carrier_velocity, timestep_, position);
 
     // Continue propagation until the deposit is outside the sensor
     Eigen::Vector3d last_position = position;
@@ -289,20 +393,16 @@ std::pair<ROOT::Math::XYZPoint, double> TransientPropagationModule::propagate(co
         // Save previous position and time
         last_position = position;
 
-        // Execute a Runge Kutta step
-        auto step = runge_kutta.step();
+        // Execute a Runge Kutta step followed by the diffusion step
+        auto step = runge_kutta.step([&](const Eigen::Vector3d& cur_pos, double timestep) {
+            // Get electric field at current position and fall back to empty field if it does not exist
+            auto efield = field_cursor.get(static_cast<ROOT::Math::XYZPoint>(cur_pos));
+            return carrier_diffusion(std::sqrt(efield.Mag2()), timestep);
+        });
 
         // Get the current result
         position = runge_kutta.getValue();
 
-        // Get electric field at current position and fall back to empty field if it does not exist
-        auto efield = detector_->getElectricField(static_cast<ROOT::Math::XYZPoint>(position));
-
-        // Apply diffusion step
-        auto diffusion = carrier_diffusion(std::sqrt(efield.Mag2()), timestep_);
-        position += diffusion;
-        runge_kutta.setValue(position);
-
         // Update step length histogram
         if(output_plots_) {
             step_length_histo_->Fill(static_cast<double>(Units::convert(step.value.norm(), "um")));
@@ -348,6 +448,12 @@ std::pair<ROOT::Math::XYZPoint, double> TransientPropagationModule::propagate(co
                    << Units::display(static_cast<ROOT::Math::XYZPoint>(position), {"um", "mm"}) << ", "
                    << Units::display(initial_time + runge_kutta.getTime(), "ns");
 
+        // Center and length of the step, used with the precomputed weighting potential gradient
+        Eigen::Vector3d step_center = (position + last_position) / 2.0;
+        Eigen::Vector3d step_length = position - last_position;
+        auto midpoint = static_cast<ROOT::Math::XYZPoint>(step_center);
+        auto displacement = static_cast<ROOT::Math::XYZVector>(step_length);
+
         // Loop over NxN pixels:
         for(int x = xpixel - matrix_.x() / 2; x <= xpixel + matrix_.x() / 2; x++) {
             for(int y = ypixel - matrix_.y() / 2; y <= ypixel + matrix_.y() / 2; y++) {
@@ -358,13 +464,24 @@ std::pair<ROOT::Math::XYZPoint, double> TransientPropagationModule::propagate(co
                 }
 
                 Pixel::Index pixel_index(static_cast<unsigned int>(x), static_cast<unsigned int>(y));
-                auto ramo = detector_->getWeightingPotential(static_cast<ROOT::Math::XYZPoint>(position), pixel_index);
-                auto last_ramo =
-                    detector_->getWeightingPotential(static_cast<ROOT::Math::XYZPoint>(last_position), pixel_index);
+                double potential_difference = 0;
+                if(precompute_gradient_) {
+                    potential_difference = get_weighting_potential_difference(midpoint, displacement, pixel_index);
+                } else {
+                    auto ramo = detector_->getWeightingPotential(static_cast<ROOT::Math::XYZPoint>(position), pixel_index);
+                    auto last_ramo =
+                        detector_->getWeightingPotential(static_cast<ROOT::Math::XYZPoint>(last_position), pixel_index);
+                    potential_difference = ramo - last_ramo;
+                }
+
+                // Skip pixels with negligible change of the weighting potential in this step
+                if(std::fabs(potential_difference) < induction_threshold_) {
+                    continue;
+                }
 
                 // Induced charge on electrode is q_int = q * (phi(x1) - phi(x0))
-                auto induced = charge * (ramo - last_ramo) * static_cast<std::underlying_type<CarrierType>::type>(type);
-                LOG(TRACE) << "Pixel " << pixel_index << " dPhi = " << (ramo - last_ramo) << ", induced " << type
+                auto induced = charge * potential_difference * static_cast<std::underlying_type<CarrierType>::type>(type);
+                LOG(TRACE) << "Pixel " << pixel_index << " dPhi = " << potential_difference << ", induced " << type
                            << " q = " << Units::display(induced, "e");
 
                 // Create pulse if it doesn't exist. Store induced charge in the returned pulse iterator
@@ -372,7 +489,7 @@ std::pair<ROOT::Math::XYZPoint, double> TransientPropagationModule::propagate(co
                 pixel_map_iterator.first->second.addCharge(induced, initial_time + runge_kutta.getTime());
 
                 if(output_plots_) {
-                    potential_difference_->Fill(std::fabs(ramo - last_ramo));
+                    potential_difference_->Fill(std::fabs(potential_difference));
                     induced_charge_histo_->Fill(initial_time + runge_kutta.getTime(), induced);
                     if(type == CarrierType::ELECTRON) {
                         induced_charge_e_histo_->Fill(initial_time + runge_kutta.getTime(), induced);
@@ -398,3 +515,11 @@ void TransientPropagationModule::finalize() {
         induced_charge_h_histo_->Write();
     }
 }
+
+void TransientPropagationModule::saveState(std::ostream& state) {
+    state << random_generator_ << " " << normal_sampler_;
+}
+
+void TransientPropagationModule::loadState(std::istream& state) {
+    state >> random_generator_ >> normal_sampler_;
+}
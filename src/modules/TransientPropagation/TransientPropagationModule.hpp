@@ -7,7 +7,9 @@
  * Intergovernmental Organization or submit itself to any jurisdiction.
  */
 
+#include <array>
 #include <string>
+#include <vector>
 
 #include <Math/DisplacementVector2D.h>
 #include <Math/Point3D.h>
@@ -17,6 +19,7 @@
 #include "core/geometry/DetectorModel.hpp"
 #include "core/messenger/Messenger.hpp"
 #include "core/module/Module.hpp"
+#include "core/utils/prng.h"
 
 #include "objects/DepositedCharge.hpp"
 #include "objects/Pulse.hpp"
@@ -57,6 +60,16 @@ namespace allpix {
          */
         void finalize() override;
 
+        /**
+         * @brief Store the state of the random number generators in a checkpoint
+         */
+        void saveState(std::ostream& state) override;
+
+        /**
+         * @brief Restore the state of the random number generators from a checkpoint
+         */
+        void loadState(std::istream& state) override;
+
     private:
         // General module members
         std::shared_ptr<const Detector> detector_;
@@ -79,13 +92,40 @@ namespace allpix {
                                                           const double initial_time,
                                                           std::map<Pixel::Index, Pulse>& pixel_map);
 
+        /**
+         * @brief Precompute the gradient of the weighting potential on a grid covering the induction matrix
+         */
+        void precompute_weighting_potential_gradient();
+
+        /**
+         * @brief Get the change of the weighting potential of a pixel from the precomputed gradient
+         * @param midpoint Center of the step of the charge carrier in local coordinates
+         * @param displacement Displacement of the charge carrier during the step
+         * @param pixel Index of the pixel to calculate the weighting potential difference for
+         * @return Difference of the weighting potential between the end and the start of the step
+         */
+        double get_weighting_potential_difference(const ROOT::Math::XYZPoint& midpoint,
+                                                  const ROOT::Math::XYZVector& displacement,
+                                                  const Pixel::Index& pixel) const;
+
         // Random generator for this module
         std::mt19937_64 random_generator_;
+        bool counter_based_random_{};
+        NormalSampler<> normal_sampler_;
 
         // Local copies of configuration parameters to avoid costly lookup:
         double temperature_{}, timestep_{}, integration_time_{};
         bool output_plots_{};
         ROOT::Math::DisplacementVector2D<ROOT::Math::Cartesian2D<int>> matrix_;
+        double induction_threshold_{};
+
+        // Gradient of the weighting potential relative to a pixel, stored as flat array with three components per bin
+        bool precompute_gradient_{};
+        std::vector<double> potential_gradient_;
+        std::array<size_t, 3> gradient_bins_{};
+        std::array<double, 3> gradient_origin_{};
+        std::array<double, 3> gradient_bin_size_{};
+        ROOT::Math::XYVector pixel_pitch_;
 
         // Precalculated values for electron and hole mobility
         double electron_Vm_;
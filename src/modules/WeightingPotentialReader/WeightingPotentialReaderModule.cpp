@@ -31,6 +31,8 @@ WeightingPotentialReaderModule::WeightingPotentialReaderModule(Configuration& co
                                                                Messenger*,
                                                                std::shared_ptr<Detector> detector)
     : Module(config, detector), detector_(std::move(detector)) {
+    // Enable parallelization of this module if multithreading is enabled
+    enable_parallelization();
 
     // NOTE Backwards-compatibility: interpret both "init" and "apf" as "mesh":
     auto model = config_.get<std::string>("model");
@@ -115,6 +117,13 @@ WeightingPotentialReaderModule::get_pad_potential_function(const ROOT::Math::XYV
     };
 }
 
+void WeightingPotentialReaderModule::finalize() {
+    // Write the output plots to the module file
+    for(auto* plot : output_plots_) {
+        plot->Write();
+    }
+}
+
 void WeightingPotentialReaderModule::create_output_plots() {
     LOG(TRACE) << "Creating output plots";
 
@@ -186,10 +195,8 @@ void WeightingPotentialReaderModule::create_output_plots() {
     histogram2Dx->SetOption("colz");
     histogram2Dy->SetOption("colz");
 
-    // Write the histogram to module file
-    histogram->Write();
-    histogram2Dx->Write();
-    histogram2Dy->Write();
+    // Store the histograms to write them to the module file at the end
+    output_plots_ = {histogram, histogram2Dx, histogram2Dy};
 }
 
 /**
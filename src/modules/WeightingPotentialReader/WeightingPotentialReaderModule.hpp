@@ -12,6 +12,8 @@
 #include <string>
 #include <vector>
 
+#include <TH1.h>
+
 #include "core/config/Configuration.hpp"
 #include "core/geometry/GeometryManager.hpp"
 #include "core/messenger/Messenger.hpp"
@@ -39,9 +41,17 @@ namespace allpix {
          */
         void init() override;
 
+        /**
+         * @brief Write the output plots to the module file
+         */
+        void finalize() override;
+
     private:
         std::shared_ptr<Detector> detector_;
 
+        // Output plots, written during finalization
+        std::vector<TH1*> output_plots_;
+
         /**
          * @brief Create and apply a weighting potential equivalent to a pixel/pad in a plane condenser
          * @param thickness_domain Domain of the thickness where the field is defined
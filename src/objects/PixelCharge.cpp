@@ -46,6 +46,19 @@ PixelCharge::PixelCharge(Pixel pixel, Pulse pulse, const std::vector<const Propa
     pulse_ = std::move(pulse);
 }
 
+PixelCharge::PixelCharge(Pixel pixel,
+                         long charge,
+                         Pulse pulse,
+                         double local_time,
+                         double global_time,
+                         const std::vector<const MCParticle*>& mc_particles)
+    : pixel_(std::move(pixel)), charge_(charge), pulse_(std::move(pulse)), local_time_(local_time),
+      global_time_(global_time) {
+    for(const auto& mc_particle : mc_particles) {
+        mc_particles_.push_back(const_cast<MCParticle*>(mc_particle)); // NOLINT
+    }
+}
+
 const Pixel& PixelCharge::getPixel() const {
     return pixel_;
 }
@@ -49,6 +49,22 @@ namespace allpix {
                     Pulse pulse,
                     const std::vector<const PropagatedCharge*>& propagated_charges = std::vector<const PropagatedCharge*>());
 
+        /**
+         * @brief Construct a set of charges at a pixel directly from its Monte-Carlo particles, used to restore stored data
+         * @param pixel Object holding the information of the pixel
+         * @param charge Amount of charge stored at this pixel
+         * @param pulse Pulse of induced or collected charges
+         * @param local_time Time with respect to the local sensor
+         * @param global_time Time from the start of the event
+         * @param mc_particles Monte-Carlo particles resulting in this pixel charge
+         */
+        PixelCharge(Pixel pixel,
+                    long charge,
+                    Pulse pulse,
+                    double local_time,
+                    double global_time,
+                    const std::vector<const MCParticle*>& mc_particles = std::vector<const MCParticle*>());
+
         /**
          * @brief Get the pixel containing the charges
          * @return Pixel indices in the grid
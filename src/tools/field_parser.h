@@ -12,8 +12,10 @@
 
 #include <algorithm>
 #include <fstream>
+#include <future>
 #include <iostream>
 #include <map>
+#include <mutex>
 
 #include "core/utils/file.h"
 #include "core/utils/log.h"
@@ -159,7 +161,7 @@ namespace allpix {
      *
      * This class can be used to deserialize and parse FieldData objects from files of different format. The FieldData
      * objects read from file are cached, and a cache hit will be returned when trying to re-read a file with the same
-     * canonical path.
+     * canonical path. The parser can be used from multiple threads, every file is only parsed once.
      */
     template <typename T = double> class FieldParser {
     public:
@@ -184,12 +186,42 @@ namespace allpix {
          */
         FieldData<T> getByFileName(const std::string& file_name, const std::string& units = std::string()) {
             // Search in cache (NOTE: the path reached here is always a canonical name)
+            std::unique_lock<std::mutex> lock(mutex_);
             auto iter = field_map_.find(file_name);
             if(iter != field_map_.end()) {
+                auto field_data = iter->second;
+                lock.unlock();
+                // Wait for the field data if the file is currently parsed by another thread
                 LOG(INFO) << "Using cached field data";
-                return iter->second;
+                return field_data.get();
             }
 
+            // Register the file in the cache before parsing it, other threads requesting it wait for the result
+            std::promise<FieldData<T>> promise;
+            field_map_[file_name] = promise.get_future().share();
+            lock.unlock();
+
+            try {
+                auto field_data = parse_file(file_name, units);
+                promise.set_value(field_data);
+                return field_data;
+            } catch(...) {
+                promise.set_exception(std::current_exception());
+                // Remove the failed file from the cache
+                lock.lock();
+                field_map_.erase(file_name);
+                throw;
+            }
+        }
+
+    private:
+        /**
+         * @brief Parse a file in the format deduced from its content
+         * @param file_name  File name (as canonical path) of the input file to be parsed
+         * @param units      Units to convert the field from, only used by some formats
+         * @return           Field data object read from file
+         */
+        FieldData<T> parse_file(const std::string& file_name, const std::string& units) {
             // Deduce the file format
             auto file_type = guess_file_type(file_name);
             LOG(DEBUG) << "Assuming file type \"" << (file_type == FileType::APF ? "APF" : "INIT") << "\"";
@@ -211,7 +243,6 @@ namespace allpix {
             }
         }
 
-    private:
         /**
          * @brief Function to guess the type of a field data file
          * @param path Path to the file to be tested
@@ -346,14 +377,12 @@ namespace allpix {
 
             FieldData<T> field_data(
                 header, std::array<size_t, 3>{{xsize, ysize, zsize}}, std::array<T, 3>{{xpixsz, ypixsz, thickness}}, field);
-
-            // Store the parsed field data for further reference:
-            field_map_[file_name] = field_data;
             return field_data;
         }
 
         size_t N_;
-        std::map<std::string, FieldData<T>> field_map_;
+        std::mutex mutex_;
+        std::map<std::string, std::shared_future<FieldData<T>>> field_map_;
     };
 
     /**
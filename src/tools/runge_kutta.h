@@ -10,7 +10,10 @@
 #ifndef ALLPIX_RUNGE_KUTTA_H
 #define ALLPIX_RUNGE_KUTTA_H
 
+#include <array>
 #include <functional>
+#include <type_traits>
+#include <utility>
 
 #include <Eigen/Core>
 #include <Eigen/Geometry>
@@ -199,6 +202,186 @@ namespace allpix {
     }
     // clang-format on
 
+    // clang-format off
+    // The static members are implicitly inline since C++17, only older standards require their definition
+    namespace tableau {
+        /**
+         * @brief Compile-time coefficients of Kutta's third order method
+         * @warning Without error function
+         */
+        template <typename T> struct Kutta3Coefficients {
+            static constexpr int stages = 3;
+            static constexpr T a[3][3] = {
+                {0, 0, 0},
+                {1.0/2, 0, 0},
+                {-1, 2, 0}};
+            static constexpr T b[3] = {1.0/6, 2.0/3, 1.0/6};
+            static constexpr T b_error[3] = {0, 0, 0};
+        };
+#if __cplusplus < 201703L
+        template <typename T> constexpr T Kutta3Coefficients<T>::a[3][3];
+        template <typename T> constexpr T Kutta3Coefficients<T>::b[3];
+        template <typename T> constexpr T Kutta3Coefficients<T>::b_error[3];
+#endif
+        using Kutta3 = Kutta3Coefficients<double>;
+
+        /**
+         * @brief Compile-time coefficients of the classic original Runge-Kutta method
+         * @warning Without error function
+         */
+        template <typename T> struct Classic4Coefficients {
+            static constexpr int stages = 4;
+            static constexpr T a[4][4] = {
+                {0, 0, 0, 0},
+                {1.0/2, 0, 0, 0},
+                {0, 1.0/2, 0, 0},
+                {0, 0, 1, 0}};
+            static constexpr T b[4] = {1.0/6, 1.0/3, 1.0/3, 1.0/6};
+            static constexpr T b_error[4] = {0, 0, 0, 0};
+        };
+#if __cplusplus < 201703L
+        template <typename T> constexpr T Classic4Coefficients<T>::a[4][4];
+        template <typename T> constexpr T Classic4Coefficients<T>::b[4];
+        template <typename T> constexpr T Classic4Coefficients<T>::b_error[4];
+#endif
+        using Classic4 = Classic4Coefficients<double>;
+
+        /**
+         * @brief Compile-time coefficients of the Runge-Kutta-Fehlberg method
+         */
+        template <typename T> struct Fehlberg5Coefficients {
+            static constexpr int stages = 6;
+            static constexpr T a[6][6] = {
+                {0, 0, 0, 0, 0, 0},
+                {1.0/4, 0, 0, 0, 0, 0},
+                {3.0/32, 9.0/32, 0, 0, 0, 0},
+                {1932.0/2197, -7200.0/2197, 7296.0/2197, 0, 0, 0},
+                {439.0/216, -8, 3680.0/513, -845.0/4104, 0, 0},
+                {-8.0/27, 2, -3544.0/2565, 1859.0/4104, -11.0/40, 0}};
+            static constexpr T b[6] = {16.0/135, 0, 6656.0/12825, 28561.0/56430, -9.0/50, 2.0/55};
+            static constexpr T b_error[6] = {25.0/216, 0, 1408.0/2565, 2197.0/4104, -1.0/5, 0};
+        };
+#if __cplusplus < 201703L
+        template <typename T> constexpr T Fehlberg5Coefficients<T>::a[6][6];
+        template <typename T> constexpr T Fehlberg5Coefficients<T>::b[6];
+        template <typename T> constexpr T Fehlberg5Coefficients<T>::b_error[6];
+#endif
+        using Fehlberg5 = Fehlberg5Coefficients<double>;
+    }
+    // clang-format on
+
+    /**
+     * @brief Runge-Kutta integration specialized at compile time for a given tableau and step function
+     *
+     * Other than \ref RungeKutta, the coefficients of the tableau are compile-time constants and the step function is a
+     * template parameter, such that the compiler can unroll the stages and inline the function. The error of a step is not
+     * accumulated over the integration.
+     */
+    template <typename Tableau, typename Function, typename T = double, int D = 3> class StaticRungeKutta {
+    public:
+        /**
+         * @brief Utility type to return both the value and the error at every step
+         */
+        class Step {
+        public:
+            Eigen::Matrix<T, D, 1> value;
+            Eigen::Matrix<T, D, 1> error;
+        };
+
+        /**
+         * @brief Construct a Runge-Kutta integrator
+         * @param function Step function to perform integration, called with the time and the current value
+         * @param step_size Time step of the integration
+         * @param initial_y Start values of the vector to perform integration on
+         * @param initial_t Initial time at the start of the integration
+         */
+        StaticRungeKutta(Function function, T step_size, Eigen::Matrix<T, D, 1> initial_y, T initial_t = 0)
+            : function_(std::move(function)), h_(std::move(step_size)), y_(std::move(initial_y)), t_(std::move(initial_t)) {}
+
+        /**
+         * @brief Changes the time step
+         * @param step_size New time step of the integration
+         */
+        void setTimeStep(T step_size) { h_ = std::move(step_size); }
+        /**
+         * @brief Return the time step
+         * @return Current time step of the integration
+         */
+        T getTimeStep() const { return h_; }
+
+        /**
+         * @brief Changes the current value during integration
+         * @note Can be used to add additional processes during the integration
+         */
+        void setValue(Eigen::Matrix<T, D, 1> y) { y_ = std::move(y); }
+
+        /**
+         * @brief Get the value to integrate
+         * @return Current value
+         */
+        const Eigen::Matrix<T, D, 1>& getValue() const { return y_; }
+        /**
+         * @brief Get the time during integration
+         * @return Current time
+         */
+        T getTime() const { return t_; }
+
+        /**
+         * @brief Execute a single time step of the integration
+         * @return Combination of the change of the value and the error in this single step
+         */
+        Step step() {
+            Step step;
+            step.value.setZero();
+            step.error.setZero();
+
+            // Stage times and errors are evaluated as in RungeKutta::step() to obtain identical results
+            std::array<Eigen::Matrix<T, D, 1>, Tableau::stages> k;
+            for(int i = 0; i < Tableau::stages; ++i) {
+                Eigen::Matrix<T, D, 1> yt = y_;
+                T tt = t_;
+                for(int j = 0; j < i; ++j) {
+                    yt += h_ * Tableau::a[i][j] * k[j];
+                    tt += Tableau::a[i][j];
+                }
+                k[i] = function_(tt, yt);
+
+                step.value += h_ * Tableau::b[i] * k[i];
+                step.error += h_ * Tableau::b_error[i] * k[i];
+            }
+            step.error = step.value - step.error;
+
+            // Update values with new step
+            y_ += step.value;
+            t_ += h_;
+            return step;
+        }
+
+        /**
+         * @brief Execute a single time step of the integration followed by a stochastic displacement
+         * @param displacement Function called with the value after the step and the time step, returning a displacement
+         * @return Combination of the change of the value and the error in this single step, excluding the displacement
+         *
+         * Fuses the integration step with an additional process such as the diffusion of charge carriers, avoiding to copy
+         * the value out of the integrator and back.
+         */
+        template <typename Displacement> Step step(Displacement&& displacement) {
+            auto result = step();
+            y_ += displacement(static_cast<const Eigen::Matrix<T, D, 1>&>(y_), h_);
+            return result;
+        }
+
+    private:
+        Function function_;
+        // Step size
+        T h_;
+
+        // Vector to integrate
+        Eigen::Matrix<T, D, 1> y_;
+        // Current time
+        T t_;
+    };
+
     /**
      * @brief Utility function to create RungeKutta class using template deduction
      * @param tableau One of the possible Runge-Kutta tableaus (see \ref allpix::tableau)
@@ -209,6 +392,21 @@ namespace allpix {
     RungeKutta<T, S, D> make_runge_kutta(const Eigen::Matrix<T, S + 2, S>& tableau, Args&&... args) {
         return RungeKutta<T, S, D>(tableau, std::forward<Args>(args)...);
     }
+
+    /**
+     * @brief Utility function to create StaticRungeKutta class using template deduction for the step function
+     * @param function Step function to perform integration
+     * @param step_size Time step of the integration
+     * @param initial_y Start values of the vector to perform integration on
+     * @param initial_t Initial time at the start of the integration
+     * @return Instantiation of \ref StaticRungeKutta class for the given tableau
+     */
+    template <typename Tableau, typename T, int D, typename Function>
+    StaticRungeKutta<Tableau, std::decay_t<Function>, T, D>
+    make_runge_kutta(Function&& function, T step_size, Eigen::Matrix<T, D, 1> initial_y, T initial_t = 0) {
+        return StaticRungeKutta<Tableau, std::decay_t<Function>, T, D>(
+            std::forward<Function>(function), step_size, std::move(initial_y), initial_t);
+    }
 } // namespace allpix
 
 #endif /* ALLPIX_RUNGE_KUTTA_H */
@@ -1,4 +1,5 @@
 #include <algorithm>
+#include <atomic>
 #include <cfloat>
 #include <chrono>
 #include <climits>
@@ -6,6 +7,7 @@
 #include <cstdlib>
 #include <fstream>
 #include <iostream>
+#include <memory>
 #include <sstream>
 #include <string>
 #include <utility>
@@ -25,6 +27,7 @@
 #include "tools/units.h"
 
 #include "MeshElement.hpp"
+#include "MeshLocator.hpp"
 #include "MeshParser.hpp"
 #include "ThreadPool.hpp"
 #include "combinations/combinations.h"
@@ -179,6 +182,13 @@ int main(int argc, char** argv) {
         const auto max_radius = config.get<double>("max_radius", 50);
         const auto volume_cut = config.get<double>("volume_cut", 10e-9);
 
+        // Interpolation algorithm
+        auto interpolation = config.get<std::string>("interpolation", "octree");
+        std::transform(interpolation.begin(), interpolation.end(), interpolation.begin(), ::tolower);
+        if(interpolation != "octree" && interpolation != "elements") {
+            throw allpix::InvalidValueError(config, "interpolation", "only 'octree' and 'elements' are supported");
+        }
+
         XYZVectorInt divisions;
         const auto dimension = config.get<size_t>("dimension", 3);
         if(dimension == 2) {
@@ -327,18 +337,88 @@ int main(int argc, char** argv) {
         unibn::Octree<Point> octree;
         octree.initialize(points);
 
+        // Build the element connectivity if elements should be located by walking through the mesh
+        std::unique_ptr<MeshLocator> locator;
+        if(interpolation == "elements") {
+            if(parser->getElements().empty()) {
+                LOG(WARNING) << "No simplex elements found in the mesh, falling back to octree interpolation";
+            } else {
+                locator = std::make_unique<MeshLocator>(dimension, points, parser->getElements());
+                LOG(INFO) << "Locating grid points in " << locator->size() << " mesh elements";
+            }
+        }
+        std::atomic<size_t> walk_located{0};
+        std::atomic<size_t> search_located{0};
+
+        // Interpolate the observable in a mesh element if it contains the point and is valid
+        auto interpolate_element = [&](size_t element, Point& q, Point& e) {
+            std::array<Point, 4> grid_elements, field_elements;
+            const auto& vertices = locator->getElement(element);
+            for(size_t i = 0; i < dimension + 1; ++i) {
+                grid_elements[i] = points[vertices[i]];
+                field_elements[i] = field[vertices[i]];
+            }
+
+            MeshElement mesh_element(dimension, grid_elements, field_elements);
+            if(!mesh_element.validElement(volume_cut, q)) {
+                return false;
+            }
+            LOG(DEBUG) << mesh_element.print(q);
+            e = mesh_element.getObservable(q);
+            return true;
+        };
+
+        // Locate the mesh element by walking from the given element, or from the elements around the closest mesh point
+        auto walk_element = [&](Point& q, Point& e, size_t& element) {
+            if(element != MeshLocator::npos) {
+                element = locator->locate(q, element);
+                if(element != MeshLocator::npos && interpolate_element(element, q, e)) {
+                    return true;
+                }
+            }
+
+            auto closest = octree.findNeighbor<unibn::L2Distance<Point>>(q);
+            if(closest < 0) {
+                return false;
+            }
+            for(auto start : locator->getVertexElements(static_cast<size_t>(closest))) {
+                element = locator->locate(q, start);
+                if(element != MeshLocator::npos && interpolate_element(element, q, e)) {
+                    return true;
+                }
+            }
+
+            element = MeshLocator::npos;
+            return false;
+        };
+
         auto mesh_section = [&](double x, double y) {
             allpix::Log::setReportingLevel(log_level);
 
             // New mesh slice
             std::vector<Point> new_mesh;
 
+            // Mesh element of the previous point, used as start for the next walk
+            size_t element = MeshLocator::npos;
+
             double z = minz + zstep / 2.0;
             for(int k = 0; k < divisions.z(); ++k) {
                 // New mesh vertex and field
                 Point q(dimension == 2 ? -1 : x, y, z), e;
                 bool valid = false;
 
+                if(locator != nullptr) {
+                    valid = walk_element(q, e, element);
+                    if(valid) {
+                        walk_located++;
+                        new_mesh.push_back(e);
+                        z += zstep;
+                        continue;
+                    }
+                    LOG(DEBUG) << "No mesh element found containing " << q << ", falling back to neighbor search";
+                    search_located++;
+                }
+
                 size_t prev_neighbours = 0;
                 double radius = initial_radius;
 
@@ -438,6 +518,11 @@ int main(int argc, char** argv) {
         }
         pool.destroy();
 
+        if(locator != nullptr) {
+            LOG(INFO) << "Located " << walk_located << " grid points by walking through the mesh elements, "
+                      << search_located << " by neighbor search";
+        }
+
         end = std::chrono::system_clock::now();
         elapsed_seconds = std::chrono::duration_cast<std::chrono::seconds>(end - start).count();
         LOG(INFO) << "New mesh created in " << elapsed_seconds << " seconds.";
@@ -0,0 +1,114 @@
+#include "MeshLocator.hpp"
+
+#include <algorithm>
+#include <tuple>
+#include <utility>
+
+#include "core/utils/log.h"
+
+using namespace mesh_converter;
+
+namespace {
+    // Maximum number of elements visited in a single walk
+    constexpr size_t max_walk_steps = 1000;
+} // namespace
+
+constexpr size_t MeshLocator::npos;
+
+MeshLocator::MeshLocator(size_t dimension, const std::vector<Point>& points, std::vector<std::array<size_t, 4>> elements)
+    : dimension_(dimension), points_(points), elements_(std::move(elements)), vertex_elements_(points.size()) {
+    neighbors_.resize(elements_.size());
+    for(auto& neighbor : neighbors_) {
+        neighbor.fill(npos);
+    }
+
+    // List all faces (edges in 2D) with the element they belong to and the index of the vertex opposite to them
+    std::vector<std::tuple<std::array<size_t, 3>, size_t, size_t>> faces;
+    faces.reserve(elements_.size() * (dimension_ + 1));
+    for(size_t element = 0; element < elements_.size(); ++element) {
+        for(size_t i = 0; i < dimension_ + 1; ++i) {
+            vertex_elements_[elements_[element][i]].push_back(element);
+
+            std::array<size_t, 3> face{{npos, npos, npos}};
+            for(size_t j = 0, k = 0; j < dimension_ + 1; ++j) {
+                if(j != i) {
+                    face[k++] = elements_[element][j];
+                }
+            }
+            std::sort(face.begin(), face.end());
+            faces.emplace_back(face, element, i);
+        }
+    }
+
+    // Elements sharing a face are neighbors
+    std::sort(faces.begin(), faces.end());
+    size_t shared_faces = 0;
+    for(size_t i = 0; i + 1 < faces.size(); ++i) {
+        if(std::get<0>(faces[i]) == std::get<0>(faces[i + 1])) {
+            neighbors_[std::get<1>(faces[i])][std::get<2>(faces[i])] = std::get<1>(faces[i + 1]);
+            neighbors_[std::get<1>(faces[i + 1])][std::get<2>(faces[i + 1])] = std::get<1>(faces[i]);
+            ++shared_faces;
+            ++i;
+        }
+    }
+
+    LOG(DEBUG) << "Mesh with " << elements_.size() << " elements and " << shared_faces << " shared faces";
+}
+
+double MeshLocator::get_sub_volume(size_t element, size_t index, const Point& qp) const {
+    std::array<const Point*, 4> vertices{};
+    for(size_t i = 0; i < dimension_ + 1; ++i) {
+        vertices[i] = (i == index ? &qp : &points_[elements_[element][i]]);
+    }
+
+    if(dimension_ == 2) {
+        return (vertices[1]->y - vertices[0]->y) * (vertices[2]->z - vertices[0]->z) -
+               (vertices[2]->y - vertices[0]->y) * (vertices[1]->z - vertices[0]->z);
+    }
+
+    double ax = vertices[1]->x - vertices[0]->x, ay = vertices[1]->y - vertices[0]->y, az = vertices[1]->z - vertices[0]->z;
+    double bx = vertices[2]->x - vertices[0]->x, by = vertices[2]->y - vertices[0]->y, bz = vertices[2]->z - vertices[0]->z;
+    double cx = vertices[3]->x - vertices[0]->x, cy = vertices[3]->y - vertices[0]->y, cz = vertices[3]->z - vertices[0]->z;
+    return ax * (by * cz - bz * cy) - ay * (bx * cz - bz * cx) + az * (bx * cy - by * cx);
+}
+
+/**
+ * In every step the face is crossed for which the point lies furthest on the outer side, i.e. the sub-volume with the point
+ * replacing the opposite vertex is most negative with respect to the orientation of the element. The face leading back to
+ * the previous element is only crossed if it is the only candidate to avoid oscillating between two elements.
+ */
+size_t MeshLocator::locate(const Point& qp, size_t start) const {
+    size_t element = start;
+    size_t previous = npos;
+    for(size_t step = 0; step < max_walk_steps && element != npos; ++step) {
+        double volume = get_sub_volume(element, dimension_ + 1, qp);
+        if(volume == 0) {
+            // Degenerate element, the side of the point cannot be determined
+            return npos;
+        }
+
+        size_t exit_face = npos;
+        double exit_volume = 0;
+        for(size_t i = 0; i < dimension_ + 1; ++i) {
+            double sub_volume = (volume > 0 ? 1 : -1) * get_sub_volume(element, i, qp);
+            if(sub_volume >= 0) {
+                continue;
+            }
+            if(exit_face == npos || neighbors_[element][exit_face] == previous ||
+               (sub_volume < exit_volume && neighbors_[element][i] != previous)) {
+                exit_face = i;
+                exit_volume = sub_volume;
+            }
+        }
+
+        if(exit_face == npos) {
+            LOG(TRACE) << "Located point " << qp << " in element " << element << " after " << step << " steps";
+            return element;
+        }
+
+        previous = element;
+        element = neighbors_[element][exit_face];
+    }
+
+    return npos;
+}
@@ -0,0 +1,81 @@
+#ifndef ALLPIX_MESHLOCATOR_H
+#define ALLPIX_MESHLOCATOR_H
+
+#include <array>
+#include <limits>
+#include <vector>
+
+#include "MeshElement.hpp"
+
+namespace mesh_converter {
+
+    /**
+     * @brief Point location in a mesh of simplex elements (triangles or tetrahedra)
+     *
+     * The neighbors of all elements are found once from their shared faces (or edges in 2D). Elements containing a point are
+     * then located by walking from a start element towards the point, always crossing the face with the point furthest on
+     * its outer side. Starting from the element of a nearby point, such as the previous point of the regular grid, only a
+     * few steps are required.
+     */
+    class MeshLocator {
+    public:
+        /**
+         * @brief Value returned if no element is found
+         */
+        static constexpr size_t npos = std::numeric_limits<size_t>::max();
+
+        /**
+         * @brief Construct the locator and find the neighbors of all elements
+         * @param dimension Dimension of the mesh, either 2 or 3
+         * @param points Mesh points referred to by the elements
+         * @param elements List of elements with the indices of their vertices in the mesh points
+         */
+        MeshLocator(size_t dimension, const std::vector<Point>& points, std::vector<std::array<size_t, 4>> elements);
+
+        /**
+         * @brief Get the number of elements in the mesh
+         * @return Number of elements
+         */
+        size_t size() const { return elements_.size(); }
+
+        /**
+         * @brief Get the vertex indices of an element
+         * @param element Index of the element
+         * @return Indices of the vertices in the mesh points
+         */
+        const std::array<size_t, 4>& getElement(size_t element) const { return elements_[element]; }
+
+        /**
+         * @brief Get all elements sharing the given vertex
+         * @param vertex Index of the vertex in the mesh points
+         * @return List of element indices
+         */
+        const std::vector<size_t>& getVertexElements(size_t vertex) const { return vertex_elements_[vertex]; }
+
+        /**
+         * @brief Find the element containing a point by walking through the mesh
+         * @param qp Point to locate
+         * @param start Element to start the walk from
+         * @return Index of the element containing the point, or \ref npos if the walk left the mesh
+         */
+        size_t locate(const Point& qp, size_t start) const;
+
+    private:
+        /**
+         * @brief Calculate the volume of an element with one of its vertices replaced by the given point
+         * @param element Index of the element
+         * @param index Vertex to replace, or the vertex count to calculate the volume of the element itself
+         * @param qp Point to replace the vertex with
+         * @return Signed volume (or area in 2D) multiplied by the dimension factorial
+         */
+        double get_sub_volume(size_t element, size_t index, const Point& qp) const;
+
+        size_t dimension_;
+        const std::vector<Point>& points_;
+        std::vector<std::array<size_t, 4>> elements_;
+        std::vector<std::array<size_t, 4>> neighbors_;
+        std::vector<std::vector<size_t>> vertex_elements_;
+    };
+} // namespace mesh_converter
+
+#endif // ALLPIX_MESHLOCATOR_H
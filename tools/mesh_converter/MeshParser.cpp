@@ -1,4 +1,5 @@
 #include <iomanip>
+#include <thread>
 
 #include "MeshParser.hpp"
 
@@ -9,7 +10,8 @@ std::shared_ptr<MeshParser> MeshParser::factory(const allpix::Configuration& con
     std::transform(parser.begin(), parser.end(), parser.begin(), ::tolower);
 
     if(parser == "df-ise" || parser == "dfise") {
-        return std::make_shared<DFISEParser>();
+        return std::make_shared<DFISEParser>(
+            config.get<unsigned int>("workers", std::max(std::thread::hardware_concurrency(), 1u)));
     } else {
         throw allpix::InvalidValueError(config, "parser", "Unknown parser type");
     }
@@ -17,6 +19,8 @@ std::shared_ptr<MeshParser> MeshParser::factory(const allpix::Configuration& con
 
 std::vector<Point> MeshParser::getMesh(const std::string& file, const std::vector<std::string>& regions) {
     std::vector<Point> points;
+    elements_.clear();
+    region_elements_.clear();
 
     auto region_grid = read_meshes(file);
     LOG(INFO) << "Grid sizes for all regions:";
@@ -27,6 +31,14 @@ std::vector<Point> MeshParser::getMesh(const std::string& file, const std::vecto
     // Append all grid regions to the mesh:
     for(const auto& region : regions) {
         if(region_grid.find(region) != region_grid.end()) {
+            // Shift the vertex indices of the region elements to the position of the region in the full mesh
+            auto offset = points.size();
+            for(auto element : region_elements_[region]) {
+                for(auto& vertex : element) {
+                    vertex += offset;
+                }
+                elements_.push_back(element);
+            }
             points.insert(points.end(), region_grid[region].begin(), region_grid[region].end());
         } else {
             throw std::runtime_error("Region \"" + region + "\" not found in mesh file");
@@ -36,7 +48,7 @@ std::vector<Point> MeshParser::getMesh(const std::string& file, const std::vecto
     if(points.empty()) {
         throw std::runtime_error("Empty grid");
     }
-    LOG(DEBUG) << "Grid with " << points.size() << " points";
+    LOG(DEBUG) << "Grid with " << points.size() << " points and " << elements_.size() << " simplex elements";
 
     return points;
 }
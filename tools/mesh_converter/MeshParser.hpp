@@ -4,6 +4,7 @@
 #include "MeshElement.hpp"
 #include "core/config/Configuration.hpp"
 
+#include <array>
 #include <map>
 #include <memory>
 #include <string>
@@ -13,6 +14,7 @@ namespace mesh_converter {
 
     using MeshMap = std::map<std::string, std::vector<Point>>;
     using FieldMap = std::map<std::string, std::map<std::string, std::vector<Point>>>;
+    using ElementMap = std::map<std::string, std::vector<std::array<size_t, 4>>>;
 
     /**
      * @brief Parser class to read different data formats
@@ -33,7 +35,24 @@ namespace mesh_converter {
         std::vector<Point>
         getField(const std::string& file, const std::string& observable, const std::vector<std::string>& regions);
 
+        /**
+         * @brief Get the simplex elements (triangles or tetrahedra) of the mesh read last by \ref getMesh
+         * @return List of elements with the indices of their vertices in the point vector returned by \ref getMesh, the last
+         * index is unused for triangles. Empty if the parser does not provide the element connectivity.
+         */
+        const std::vector<std::array<size_t, 4>>& getElements() const { return elements_; }
+
+    protected:
+        /**
+         * @brief Simplex elements for all regions, to be filled by parsers which can provide the element connectivity
+         *
+         * The vertex indices refer to the positions in the point vector returned for the same region by \ref read_meshes.
+         */
+        ElementMap region_elements_;
+
     private:
+        std::vector<std::array<size_t, 4>> elements_;
+
         /**
          * @brief Method to read grids of mesh points from the given file
          * @param  file_name Canonical path of the input file
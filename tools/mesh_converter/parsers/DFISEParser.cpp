@@ -1,32 +1,315 @@
 #include "DFISEParser.hpp"
 
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
 #include <cassert>
+#include <cctype>
+#include <cmath>
 #include <cstdlib>
+#include <cstring>
 #include <exception>
-#include <fstream>
-#include <iostream>
-#include <regex>
 #include <set>
 #include <string>
-#include "TFile.h"
-#include "TTree.h"
+#include <thread>
 
 #include "core/utils/log.h"
 #include "core/utils/text.h"
 
 using namespace mesh_converter;
 
-MeshMap DFISEParser::read_meshes(const std::string& file_name) {
-    std::ifstream file(file_name);
-    if(!file) {
-        throw std::runtime_error("file cannot be accessed");
+namespace {
+    /**
+     * @brief Read-only memory mapping of a complete file
+     */
+    class MappedFile {
+    public:
+        explicit MappedFile(const std::string& file_name) {
+            int fd = ::open(file_name.c_str(), O_RDONLY);
+            if(fd < 0) {
+                throw std::runtime_error("file cannot be accessed");
+            }
+
+            struct stat file_stat {};
+            if(::fstat(fd, &file_stat) != 0) {
+                ::close(fd);
+                throw std::runtime_error("file cannot be accessed");
+            }
+            size_ = static_cast<size_t>(file_stat.st_size);
+
+            if(size_ > 0) {
+                void* mapping = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+                if(mapping == MAP_FAILED) {
+                    ::close(fd);
+                    throw std::runtime_error("file cannot be mapped into memory");
+                }
+                data_ = static_cast<const char*>(mapping);
+                ::madvise(mapping, size_, MADV_SEQUENTIAL);
+            }
+            ::close(fd);
+        }
+        ~MappedFile() {
+            if(data_ != nullptr) {
+                ::munmap(const_cast<char*>(data_), size_); // NOLINT
+            }
+        }
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        const char* begin() const { return data_; }
+        const char* end() const { return data_ + size_; }
+        size_t size() const { return size_; }
+
+    private:
+        const char* data_{nullptr};
+        size_t size_{0};
+    };
+
+    /**
+     * @brief View of a range of characters in the mapped file
+     */
+    struct Token {
+        const char* begin{nullptr};
+        const char* end{nullptr};
+
+        bool empty() const { return begin == end; }
+        size_t size() const { return static_cast<size_t>(end - begin); }
+        std::string str() const { return std::string(begin, end); }
+        bool operator==(const char* other) const {
+            auto len = std::strlen(other);
+            return size() == len && std::equal(begin, end, other);
+        }
+        bool operator!=(const char* other) const { return !(*this == other); }
+        const char* find(char c) const { return std::find(begin, end, c); }
+        bool contains(char c) const { return find(c) != end; }
+    };
+
+    bool is_space(char c) {
+        return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f' || c == '\v';
     }
 
-    // Get the total number of lines to parse and reset file to the start:
-    auto num_lines = std::count(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>(), '\n');
-    file.clear();
-    file.seekg(0, std::ios::beg);
-    LOG(DEBUG) << "Grid file contains " << num_lines << " lines to parse";
+    Token trim(Token token) {
+        while(token.begin != token.end && is_space(*token.begin)) {
+            ++token.begin;
+        }
+        while(token.end != token.begin && is_space(*(token.end - 1))) {
+            --token.end;
+        }
+        return token;
+    }
+
+    bool is_alpha(const Token& token) {
+        return !token.empty() &&
+               std::all_of(token.begin, token.end, [](char c) { return std::isalpha(static_cast<unsigned char>(c)); });
+    }
+
+    /**
+     * @brief Fetch the next trimmed line and advance the position to the start of the following line
+     */
+    Token next_line(const char*& pos, const char* end) {
+        Token line{pos, std::find(pos, end, '\n')};
+        pos = (line.end == end ? end : line.end + 1);
+        return trim(line);
+    }
+
+    /**
+     * @brief Split a section header of the form "Name {" or "Name (data) {"
+     * @return True if the line is a valid header, false otherwise
+     */
+    bool parse_header(Token line, Token& name, Token& data) {
+        if(line.empty() || *(line.end - 1) != '{') {
+            return false;
+        }
+        line.end--;
+        line = trim(line);
+
+        auto open = line.find('(');
+        if(open == line.end) {
+            name = line;
+            data = Token{};
+            return is_alpha(name);
+        }
+
+        if(*(line.end - 1) != ')') {
+            return false;
+        }
+        name = trim(Token{line.begin, open});
+        data = trim(Token{open + 1, line.end - 1});
+        return is_alpha(name) && !data.empty() &&
+               std::none_of(data.begin, data.end, [](char c) { return is_space(c); });
+    }
+
+    /**
+     * @brief Split a line of the form "key = value"
+     * @return True if the line is a valid key-value pair, false otherwise
+     */
+    bool parse_key_value(const Token& line, Token& key, Token& value) {
+        auto equal = line.find('=');
+        if(equal == line.end) {
+            return false;
+        }
+        key = trim(Token{line.begin, equal});
+        value = trim(Token{equal + 1, line.end});
+        return is_alpha(key) && !value.empty();
+    }
+
+    /**
+     * @brief Read the next integer in the range and advance the position
+     * @return True if an integer was read, false if the range does not contain any further integer
+     */
+    bool next_integer(const char*& pos, const char* end, long& value) {
+        while(pos != end && is_space(*pos)) {
+            ++pos;
+        }
+        if(pos == end) {
+            return false;
+        }
+
+        bool negative = false;
+        if(*pos == '-' || *pos == '+') {
+            negative = (*pos == '-');
+            ++pos;
+        }
+        if(pos == end || std::isdigit(static_cast<unsigned char>(*pos)) == 0) {
+            throw std::runtime_error("invalid integer in data section");
+        }
+
+        value = 0;
+        while(pos != end && std::isdigit(static_cast<unsigned char>(*pos)) != 0) {
+            value = 10 * value + (*pos - '0');
+            ++pos;
+        }
+        if(negative) {
+            value = -value;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Parse all floating point numbers in the range
+     * @note The range has to be terminated by a character which is not part of a number
+     */
+    void parse_numbers(const char* pos, const char* end, std::vector<double>& numbers) {
+        while(true) {
+            while(pos != end && is_space(*pos)) {
+                ++pos;
+            }
+            if(pos == end) {
+                break;
+            }
+
+            char* next = nullptr;
+            double value = std::strtod(pos, &next);
+            if(next == pos || next > end) {
+                throw std::runtime_error("invalid number in data section");
+            }
+            numbers.push_back(value);
+            pos = next;
+        }
+    }
+
+    /**
+     * @brief Parse a data block of floating point numbers by splitting it into chunks which are parsed in parallel
+     * @param begin Start of the data block
+     * @param end End of the data block, pointing to the closing bracket of the section
+     * @param workers Maximum number of threads to use
+     * @return All numbers of the block in order of appearance
+     */
+    std::vector<double> parse_number_block(const char* begin, const char* end, unsigned int workers) {
+        // Do not split blocks which are too small to profit from parallel parsing
+        constexpr size_t min_chunk_size = 1 << 20;
+        auto size = static_cast<size_t>(end - begin);
+        auto chunks = static_cast<size_t>(std::max(1u, workers));
+        chunks = std::max<size_t>(1, std::min(chunks, size / min_chunk_size));
+
+        // Split the block at whitespace such that no number is cut
+        std::vector<const char*> boundaries{begin};
+        for(size_t i = 1; i < chunks; ++i) {
+            const char* pos = std::max(begin + size * i / chunks, boundaries.back());
+            while(pos != end && !is_space(*pos)) {
+                ++pos;
+            }
+            boundaries.push_back(pos);
+        }
+        boundaries.push_back(end);
+
+        std::vector<std::vector<double>> results(chunks);
+        if(chunks == 1) {
+            parse_numbers(begin, end, results.front());
+            return std::move(results.front());
+        }
+
+        std::vector<std::exception_ptr> exceptions(chunks);
+        std::vector<std::thread> threads;
+        for(size_t i = 0; i < chunks; ++i) {
+            threads.emplace_back([&, i]() {
+                try {
+                    results[i].reserve(static_cast<size_t>(boundaries[i + 1] - boundaries[i]) / 8);
+                    parse_numbers(boundaries[i], boundaries[i + 1], results[i]);
+                } catch(...) {
+                    exceptions[i] = std::current_exception();
+                }
+            });
+        }
+        for(auto& thread : threads) {
+            thread.join();
+        }
+        for(auto& exception : exceptions) {
+            if(exception) {
+                std::rethrow_exception(exception);
+            }
+        }
+
+        // Concatenate the results of all chunks
+        size_t total = 0;
+        for(auto& result : results) {
+            total += result.size();
+        }
+        std::vector<double> numbers;
+        numbers.reserve(total);
+        for(auto& result : results) {
+            numbers.insert(numbers.end(), result.begin(), result.end());
+        }
+        return numbers;
+    }
+
+    /**
+     * @brief Find the end of the data block starting at the given position
+     * @return Pointer to the closing bracket of the block
+     */
+    const char* find_block_end(const char* pos, const char* end) {
+        auto* close = static_cast<const char*>(std::memchr(pos, '}', static_cast<size_t>(end - pos)));
+        if(close == nullptr) {
+            throw std::runtime_error("data section is not closed");
+        }
+        // Move back to the start of the line containing the closing bracket
+        while(close != pos && *(close - 1) != '\n') {
+            --close;
+        }
+        return close;
+    }
+
+    /**
+     * @brief Log the parsing progress based on the position in the file
+     */
+    void log_progress(const std::string& identifier, const std::string& what, const MappedFile& file, const char* pos) {
+        if(file.size() > 0) {
+            LOG_PROGRESS(INFO, identifier) << "Parsing " << what << ": "
+                                           << (100 * static_cast<size_t>(pos - file.begin()) / file.size()) << "%";
+        }
+    }
+} // namespace
+
+DFISEParser::DFISEParser(unsigned int workers) : workers_(workers) {}
+
+MeshMap DFISEParser::read_meshes(const std::string& file_name) {
+    MappedFile file(file_name);
+    LOG(DEBUG) << "Grid file contains " << file.size() << " bytes to parse";
 
     DFSection main_section = DFSection::HEADER;
     DFSection sub_section = DFSection::NONE;
@@ -37,75 +320,85 @@ MeshMap DFISEParser::read_meshes(const std::string& file_name) {
     std::vector<std::vector<long unsigned int>> elements;
 
     std::map<std::string, std::vector<long unsigned int>> regions_vertices;
-
-    Point point(-1.0, -1.0, -1.0);
+    std::map<std::string, std::vector<long unsigned int>> regions_elements;
 
     std::string region;
     long unsigned int dimension = 1;
     long unsigned int data_count = 0;
     bool in_data_block = false;
     long long num_lines_parsed = 0;
-    while(!file.eof()) {
-        std::string line;
-        std::getline(file, line);
+    const char* pos = file.begin();
+    while(pos != file.end()) {
+        auto line = next_line(pos, file.end());
 
         // Log the parsing progress:
-        if(num_lines > 0 && num_lines_parsed % 1000 == 0) {
-            LOG_PROGRESS(INFO, "gridlines") << "Parsing grid file: " << (100 * num_lines_parsed / num_lines) << "%";
+        if(num_lines_parsed % 1000 == 0) {
+            log_progress("gridlines", "grid file", file, pos);
         }
         num_lines_parsed++;
 
-        line = allpix::trim(line);
         if(line.empty()) {
             continue;
         }
 
         // Check if line with begin of section
-        if(line.find('{') != std::string::npos) {
-            // Search for new simple headers
-            auto base_regex = std::regex("([a-zA-Z]+) \\{");
-            std::smatch base_match;
-            if(std::regex_match(line, base_match, base_regex) && base_match.ready()) {
-                auto header_string = base_match[1].str();
-
-                if(header_string == "Info") {
-                    main_section = DFSection::INFO;
-                } else if(header_string == "Data") {
-                    in_data_block = true;
-                } else {
-                    if(main_section != DFSection::NONE) {
-                        sub_section = DFSection::IGNORED;
+        if(line.contains('{')) {
+            Token header, header_data;
+            if(parse_header(line, header, header_data)) {
+                if(header_data.empty()) {
+                    // Simple headers
+                    if(header == "Info") {
+                        main_section = DFSection::INFO;
+                    } else if(header == "Data") {
+                        in_data_block = true;
                     } else {
-                        main_section = DFSection::IGNORED;
+                        if(main_section != DFSection::NONE) {
+                            sub_section = DFSection::IGNORED;
+                        } else {
+                            main_section = DFSection::IGNORED;
+                        }
                     }
-                }
-            }
-
-            // Search for headers with data
-            base_regex = std::regex("([a-zA-Z]+) \\((\\S+)\\) \\{");
-            if(std::regex_match(line, base_match, base_regex) && base_match.ready()) {
-                auto header_string = base_match[1].str();
-                auto header_data = base_match[2].str();
-
-                if(header_string == "Region") {
+                } else if(header == "Region") {
+                    // Headers with data
                     main_section = DFSection::REGION;
-                    region = header_data.substr(1, header_data.size() - 2);
-                } else if(header_string == "Vertices") {
+                    region = header_data.str();
+                    region = region.substr(1, region.size() - 2);
+                } else if(header == "Vertices") {
                     main_section = DFSection::VERTICES;
-                    data_count = std::stoul(header_data);
-                } else if(header_string == "Edges") {
+                    data_count = std::stoul(header_data.str());
+
+                    // Parse the full block of vertex coordinates at once
+                    auto block_end = find_block_end(pos, file.end());
+                    auto coordinates = parse_number_block(pos, block_end, workers_);
+                    pos = block_end;
+
+                    vertices.reserve(data_count);
+                    if(dimension == 3) {
+                        for(size_t i = 0; i + 2 < coordinates.size(); i += 3) {
+                            vertices.emplace_back(coordinates[i], coordinates[i + 1], coordinates[i + 2]);
+                        }
+                    }
+                    if(dimension == 2) {
+                        for(size_t i = 0; i + 1 < coordinates.size(); i += 2) {
+                            vertices.emplace_back(-1.0, coordinates[i], coordinates[i + 1]);
+                        }
+                    }
+                } else if(header == "Edges") {
                     main_section = DFSection::EDGES;
-                    data_count = std::stoul(header_data);
-                } else if(header_string == "Faces") {
+                    data_count = std::stoul(header_data.str());
+                    edges.reserve(data_count);
+                } else if(header == "Faces") {
                     main_section = DFSection::FACES;
-                    data_count = std::stoul(header_data);
-                } else if(header_string == "Elements") {
+                    data_count = std::stoul(header_data.str());
+                    faces.reserve(data_count);
+                } else if(header == "Elements") {
                     if(main_section == DFSection::REGION) {
                         sub_section = DFSection::ELEMENTS;
                     } else {
                         main_section = DFSection::ELEMENTS;
                     }
-                    data_count = std::stoul(header_data);
+                    data_count = std::stoul(header_data.str());
+                    elements.reserve(data_count);
                 } else {
                     if(main_section != DFSection::NONE) {
                         sub_section = DFSection::IGNORED;
@@ -119,7 +412,7 @@ MeshMap DFISEParser::read_meshes(const std::string& file_name) {
         }
 
         // Look for close of section
-        if(line.find('}') != std::string::npos) {
+        if(line.contains('}')) {
             switch(main_section) {
             case DFSection::VERTICES:
                 if(vertices.size() != data_count) {
@@ -160,28 +453,24 @@ MeshMap DFISEParser::read_meshes(const std::string& file_name) {
         }
 
         // Look for key data pairs
-        if(line.find('=') != std::string::npos) {
-            auto base_regex = std::regex("([a-zA-Z]+)\\s+=\\s+([\\S ]+)");
-            std::smatch base_match;
-            if(std::regex_match(line, base_match, base_regex) && base_match.ready()) {
-                auto key = base_match[1].str();
-                auto value = allpix::trim(base_match[2].str());
-
+        if(line.contains('=')) {
+            Token key, value;
+            if(parse_key_value(line, key, value)) {
                 // Filter correct electric field type
-                if(main_section == DFSection::INFO) {
-                    if(key == "dimension" && (std::stoul(value) != 3 && std::stoul(value) != 2)) {
+                if(main_section == DFSection::INFO && key == "dimension") {
+                    auto dim = std::stoul(value.str());
+                    if(dim == 3 || dim == 2) {
+                        dimension = dim;
+                    } else {
                         main_section = DFSection::IGNORED;
                     }
-                    if(key == "dimension" && (std::stoul(value) == 3 || std::stoul(value) == 2)) {
-                        dimension = std::stoul(value);
-                    }
                 }
             }
             continue;
         }
 
         // Handle data
-        std::stringstream sstr(line);
+        const char* data = line.begin;
         switch(main_section) {
         case DFSection::HEADER:
             if(line != "DF-ISE text") {
@@ -189,43 +478,26 @@ MeshMap DFISEParser::read_meshes(const std::string& file_name) {
             }
         case DFSection::INFO:
             break;
-        case DFSection::VERTICES: {
-            // Read vertex points
-            if(dimension == 3) {
-                point.x = -1.0;
-                point.y = -1.0;
-                point.z = -1.0;
-                while(sstr >> point.x >> point.y >> point.z) {
-                    vertices.push_back(point);
-                }
-            }
-            if(dimension == 2) {
-                point.x = -1.0;
-                point.y = -1.0;
-                point.z = -1.0;
-                while(sstr >> point.y >> point.z) {
-                    vertices.push_back(point);
-                }
-            }
-        } break;
         case DFSection::EDGES: {
             // Read edges
-            std::pair<long unsigned int, long unsigned int> edge;
-            while(sstr >> edge.first >> edge.second) {
-                if(edge.first >= vertices.size() || edge.second >= vertices.size()) {
+            long first = 0, second = 0;
+            while(next_integer(data, line.end, first) && next_integer(data, line.end, second)) {
+                if(first < 0 || second < 0 || static_cast<size_t>(first) >= vertices.size() ||
+                   static_cast<size_t>(second) >= vertices.size()) {
                     throw std::runtime_error("vertex index is higher than number of vertices");
                 }
-                edges.push_back(edge);
+                edges.emplace_back(first, second);
             }
         } break;
         case DFSection::FACES: {
             // Get vertex indices for every face
-            size_t n = 0;
-            sstr >> n;
+            long n = 0;
+            next_integer(data, line.end, n);
             std::vector<long unsigned int> face;
-            for(size_t i = 0; i < n; ++i) {
+            face.reserve(2 * static_cast<size_t>(std::max(n, 0L)));
+            for(long i = 0; i < n; ++i) {
                 long edge_idx = 0;
-                sstr >> edge_idx;
+                next_integer(data, line.end, edge_idx);
 
                 bool swap = false;
                 if(edge_idx < 0) {
@@ -260,11 +532,11 @@ MeshMap DFISEParser::read_meshes(const std::string& file_name) {
             face.erase(iter, face.end());
             face.pop_back();
 
-            faces.push_back(face);
+            faces.push_back(std::move(face));
         } break;
         case DFSection::ELEMENTS: {
-            int k = 0;
-            sstr >> k;
+            long k = 0;
+            next_integer(data, line.end, k);
             std::vector<long unsigned int> element;
 
             size_t size = 0;
@@ -299,7 +571,7 @@ MeshMap DFISEParser::read_meshes(const std::string& file_name) {
 
             for(size_t i = 0; i < size; ++i) {
                 long element_idx = 0;
-                sstr >> element_idx;
+                next_integer(data, line.end, element_idx);
 
                 bool reverse = false;
                 if(element_idx < 0) {
@@ -322,29 +594,34 @@ MeshMap DFISEParser::read_meshes(const std::string& file_name) {
                     if(element_idx >= static_cast<long>(faces.size())) {
                         throw std::runtime_error("face index is higher than number of faces");
                     }
-                    auto face = faces[static_cast<size_t>(element_idx)];
+                    const auto& face = faces[static_cast<size_t>(element_idx)];
                     if(reverse) {
-                        std::reverse(face.begin() + 1, face.end());
+                        element.push_back(face.front());
+                        element.insert(element.end(), face.rbegin(), face.rend() - 1);
+                    } else {
+                        element.insert(element.end(), face.begin(), face.end());
                     }
-                    element.insert(element.end(), face.begin(), face.end());
                 }
             }
 
-            elements.push_back(element);
+            elements.push_back(std::move(element));
             break;
         }
         case DFSection::REGION: {
             if(sub_section != DFSection::ELEMENTS) {
                 continue;
             }
-            long unsigned int elem_idx = 0;
-            while(sstr >> elem_idx) {
-                if(elem_idx >= elements.size()) {
+            auto& region_vertices = regions_vertices[region];
+            auto& region_elements = regions_elements[region];
+            long elem_idx = 0;
+            while(next_integer(data, line.end, elem_idx)) {
+                if(elem_idx < 0 || static_cast<size_t>(elem_idx) >= elements.size()) {
                     throw std::runtime_error("element index is higher than number of elements");
                 }
 
-                regions_vertices[region].insert(
-                    regions_vertices[region].end(), elements[elem_idx].begin(), elements[elem_idx].end());
+                const auto& element = elements[static_cast<size_t>(elem_idx)];
+                region_vertices.insert(region_vertices.end(), element.begin(), element.end());
+                region_elements.push_back(static_cast<size_t>(elem_idx));
             }
 
         } break;
@@ -356,7 +633,7 @@ MeshMap DFISEParser::read_meshes(const std::string& file_name) {
 
     std::map<std::string, std::vector<Point>> ret_map;
     for(auto& name_region_vertices : regions_vertices) {
-        auto region_vertices = name_region_vertices.second;
+        auto& region_vertices = name_region_vertices.second;
 
         std::sort(region_vertices.begin(), region_vertices.end());
         auto iter = std::unique(region_vertices.begin(), region_vertices.end());
@@ -368,28 +645,37 @@ MeshMap DFISEParser::read_meshes(const std::string& file_name) {
             ret_vector.push_back(vertices[vertex_idx]);
         }
 
-        ret_map[name_region_vertices.first] = ret_vector;
+        // Store all simplices of the region with the vertex indices in the region grid
+        auto& simplices = region_elements_[name_region_vertices.first];
+        for(auto& elem_idx : regions_elements[name_region_vertices.first]) {
+            auto element = elements[elem_idx];
+            std::sort(element.begin(), element.end());
+            element.erase(std::unique(element.begin(), element.end()), element.end());
+            if(element.size() != dimension + 1) {
+                continue;
+            }
+
+            std::array<size_t, 4> simplex{};
+            for(size_t i = 0; i < element.size(); ++i) {
+                simplex[i] = static_cast<size_t>(
+                    std::lower_bound(region_vertices.begin(), region_vertices.end(), element[i]) - region_vertices.begin());
+            }
+            simplices.push_back(simplex);
+        }
+
+        ret_map[name_region_vertices.first] = std::move(ret_vector);
     }
 
     return ret_map;
 }
 
 FieldMap DFISEParser::read_fields(const std::string& file_name) {
-    std::ifstream file(file_name);
-    if(!file) {
-        throw std::runtime_error("file cannot be accessed");
-    }
-
-    // Get the total number of lines to parse and reset file to the start:
-    auto num_lines = std::count(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>(), '\n');
-    file.clear();
-    file.seekg(0, std::ios::beg);
-    LOG(DEBUG) << "Field data file contains " << num_lines << " lines to parse";
+    MappedFile file(file_name);
+    LOG(DEBUG) << "Field data file contains " << file.size() << " bytes to parse";
 
     DFSection main_section = DFSection::HEADER;
     DFSection sub_section = DFSection::NONE;
 
-    // std::map<std::string, std::vector<Point>> region_electric_field_map;
     std::map<std::string, std::map<std::string, std::vector<Point>>> region_electric_field_map;
     std::vector<double> region_electric_field_num;
 
@@ -399,14 +685,13 @@ FieldMap DFISEParser::read_fields(const std::string& file_name) {
     long unsigned int data_count = 0;
     bool in_data_block = false;
     long long num_lines_parsed = 0;
-    while(!file.eof()) {
-        std::string line;
-        std::getline(file, line);
-        line = allpix::trim(line);
+    const char* pos = file.begin();
+    while(pos != file.end()) {
+        auto line = next_line(pos, file.end());
 
         // Log the parsing progress:
-        if(num_lines > 0 && num_lines_parsed % 1000 == 0) {
-            LOG_PROGRESS(INFO, "fieldlines") << "Parsing field data file: " << (100 * num_lines_parsed / num_lines) << "%";
+        if(num_lines_parsed % 1000 == 0) {
+            log_progress("fieldlines", "field data file", file, pos);
         }
         num_lines_parsed++;
 
@@ -415,35 +700,28 @@ FieldMap DFISEParser::read_fields(const std::string& file_name) {
         }
 
         // Check if line with begin of section
-        if(line.find('{') != std::string::npos) {
-            // Search for new simple headers
-            auto base_regex = std::regex("([a-zA-Z]+) \\{");
-            std::smatch base_match;
-            if(std::regex_match(line, base_match, base_regex) && base_match.ready()) {
-                auto header_string = base_match[1].str();
-                LOG(TRACE) << "Opening section " << header_string;
-
-                if(header_string == "Info") {
-                    main_section = DFSection::INFO;
-                } else if(header_string == "Data") {
-                    in_data_block = true;
-                } else {
-                    if(main_section != DFSection::NONE) {
-                        sub_section = DFSection::IGNORED;
+        if(line.contains('{')) {
+            Token header, header_data;
+            if(parse_header(line, header, header_data)) {
+                if(header_data.empty()) {
+                    // Simple headers
+                    LOG(TRACE) << "Opening section " << header.str();
+
+                    if(header == "Info") {
+                        main_section = DFSection::INFO;
+                    } else if(header == "Data") {
+                        in_data_block = true;
                     } else {
-                        main_section = DFSection::IGNORED;
+                        if(main_section != DFSection::NONE) {
+                            sub_section = DFSection::IGNORED;
+                        } else {
+                            main_section = DFSection::IGNORED;
+                        }
                     }
-                }
-            }
-
-            // Search for headers with data
-            base_regex = std::regex("([a-zA-Z]+) \\((\\S+)\\) \\{");
-            if(std::regex_match(line, base_match, base_regex) && base_match.ready()) {
-                auto header_string = base_match[1].str();
-                auto header_data = base_match[2].str();
-
-                if(header_string == "Dataset") {
-                    std::string data_type = header_data.substr(1, header_data.size() - 2);
+                } else if(header == "Dataset") {
+                    // Headers with data
+                    std::string data_type = header_data.str();
+                    data_type = data_type.substr(1, data_type.size() - 2);
                     LOG(DEBUG) << "Opening dataset of type " << data_type;
 
                     if(data_type == "ElectricField") {
@@ -459,10 +737,19 @@ FieldMap DFISEParser::read_fields(const std::string& file_name) {
                     } else {
                         main_section = DFSection::IGNORED;
                     }
-                } else if(header_string == "Values") {
-                    LOG(DEBUG) << "Opening value section with " << header_data << " entries";
+                } else if(header == "Values") {
+                    LOG(DEBUG) << "Opening value section with " << header_data.str() << " entries";
                     sub_section = DFSection::VALUES;
-                    data_count = std::stoul(header_data);
+                    data_count = std::stoul(header_data.str());
+
+                    // Parse the full block of values at once if it belongs to a dataset of interest, skip it otherwise
+                    auto block_end = find_block_end(pos, file.end());
+                    if(main_section == DFSection::ELECTRIC_FIELD || main_section == DFSection::ELECTROSTATIC_POTENTIAL ||
+                       main_section == DFSection::DOPING_CONCENTRATION || main_section == DFSection::DONOR_CONCENTRATION ||
+                       main_section == DFSection::ACCEPTOR_CONCENTRATION) {
+                        region_electric_field_num = parse_number_block(pos, block_end, workers_);
+                    }
+                    pos = block_end;
                 } else {
                     if(main_section != DFSection::NONE) {
                         sub_section = DFSection::IGNORED;
@@ -476,21 +763,18 @@ FieldMap DFISEParser::read_fields(const std::string& file_name) {
         }
 
         // Look for key data pairs
-        if(line.find('=') != std::string::npos) {
-            auto base_regex = std::regex("([a-zA-Z]+)\\s+=\\s+([\\S ]+)");
-            std::smatch base_match;
-            if(std::regex_match(line, base_match, base_regex) && base_match.ready()) {
-                auto key = base_match[1].str();
-                auto value = allpix::trim(base_match[2].str());
-
-                // Regular expression for matching validity region:
-                base_regex = std::regex("\\[\\s+\"([-\\w\\.]+)\"\\s+\\]");
+        if(line.contains('=')) {
+            Token key, value;
+            if(parse_key_value(line, key, value)) {
                 if(key == "validity") {
                     // Ignore any electric field valid for multiple regions
-                    if(std::regex_match(value, base_match, base_regex) && base_match.ready()) {
-                        region = base_match[1].str();
+                    auto open = value.find('"');
+                    auto close = (open == value.end ? value.end : std::find(open + 1, value.end, '"'));
+                    auto rest = (close == value.end ? Token{} : trim(Token{close + 1, value.end}));
+                    if(*value.begin == '[' && close != value.end && close != open + 1 && rest == "]") {
+                        region = std::string(open + 1, close);
                     } else {
-                        LOG(INFO) << "Could not determine validity region for string \"" << value << "\", ignoring.";
+                        LOG(INFO) << "Could not determine validity region for string \"" << value.str() << "\", ignoring.";
                         main_section = DFSection::IGNORED;
                     }
                 }
@@ -506,66 +790,38 @@ FieldMap DFISEParser::read_fields(const std::string& file_name) {
                     if(key == "type" && value != "vector") {
                         main_section = DFSection::IGNORED;
                     }
-                    if(key == "dimension" && (std::stoul(value) == 3 || std::stoul(value) == 2)) {
-                        dimension = std::stoul(value);
-                    }
-                    if(key == "dimension" && (std::stoul(value) != 3 && std::stoul(value) != 2)) {
-                        main_section = DFSection::IGNORED;
+                    if(key == "dimension") {
+                        auto dim = std::stoul(value.str());
+                        if(dim == 3 || dim == 2) {
+                            dimension = dim;
+                        } else {
+                            main_section = DFSection::IGNORED;
+                        }
                     }
                 }
 
-                // Filter correct electric field type
+                // Filter correct scalar observables
+                std::string scalar_observable;
                 if(main_section == DFSection::ELECTROSTATIC_POTENTIAL) {
-                    observable = "ElectrostaticPotential";
-                    if(key == "type" && value != "scalar") {
-                        main_section = DFSection::IGNORED;
-                    }
-                    if(key == "dimension" && std::stoul(value) == 1) {
-                        dimension = std::stoul(value);
-                    }
-                    if(key == "dimension" && std::stoul(value) != 1) {
-                        main_section = DFSection::IGNORED;
-                    }
-                }
-                // Filter correct electric field type
-                if(main_section == DFSection::DOPING_CONCENTRATION) {
-                    observable = "DopingConcentration";
-                    if(key == "type" && value != "scalar") {
-                        main_section = DFSection::IGNORED;
-                    }
-                    if(key == "dimension" && std::stoul(value) == 1) {
-                        dimension = std::stoul(value);
-                    }
-                    if(key == "dimension" && std::stoul(value) != 1) {
-                        main_section = DFSection::IGNORED;
-                    }
-                }
-
-                // Filter correct electric field type
-                if(main_section == DFSection::DONOR_CONCENTRATION) {
-                    observable = "DonorConcentration";
+                    scalar_observable = "ElectrostaticPotential";
+                } else if(main_section == DFSection::DOPING_CONCENTRATION) {
+                    scalar_observable = "DopingConcentration";
+                } else if(main_section == DFSection::DONOR_CONCENTRATION) {
+                    scalar_observable = "DonorConcentration";
+                } else if(main_section == DFSection::ACCEPTOR_CONCENTRATION) {
+                    scalar_observable = "AcceptorConcentration";
+                }
+                if(!scalar_observable.empty()) {
+                    observable = scalar_observable;
                     if(key == "type" && value != "scalar") {
                         main_section = DFSection::IGNORED;
                     }
-                    if(key == "dimension" && std::stoul(value) == 1) {
-                        dimension = std::stoul(value);
-                    }
-                    if(key == "dimension" && std::stoul(value) != 1) {
-                        main_section = DFSection::IGNORED;
-                    }
-                }
-
-                // Filter correct electric field type
-                if(main_section == DFSection::ACCEPTOR_CONCENTRATION) {
-                    observable = "AcceptorConcentration";
-                    if(key == "type" && value != "scalar") {
-                        main_section = DFSection::IGNORED;
-                    }
-                    if(key == "dimension" && std::stoul(value) == 1) {
-                        dimension = std::stoul(value);
-                    }
-                    if(key == "dimension" && std::stoul(value) != 1) {
-                        main_section = DFSection::IGNORED;
+                    if(key == "dimension") {
+                        if(std::stoul(value.str()) == 1) {
+                            dimension = 1;
+                        } else {
+                            main_section = DFSection::IGNORED;
+                        }
                     }
                 }
             }
@@ -573,16 +829,20 @@ FieldMap DFISEParser::read_fields(const std::string& file_name) {
         }
 
         // Look for close of section
-        if(line.find('}') != std::string::npos) {
-
-            if(main_section == DFSection::ELECTROSTATIC_POTENTIAL && sub_section == DFSection::VALUES) {
+        if(line.contains('}')) {
+            if(sub_section == DFSection::VALUES &&
+               (main_section == DFSection::ELECTROSTATIC_POTENTIAL || main_section == DFSection::DOPING_CONCENTRATION ||
+                main_section == DFSection::DONOR_CONCENTRATION || main_section == DFSection::ACCEPTOR_CONCENTRATION)) {
                 if(data_count != region_electric_field_num.size()) {
-                    throw std::runtime_error("incorrect number of electrostatic potential points");
+                    throw std::runtime_error(main_section == DFSection::ELECTROSTATIC_POTENTIAL
+                                                 ? "incorrect number of electrostatic potential points"
+                                                 : "incorrect number of points");
                 }
 
-                for(size_t i = 0; i < region_electric_field_num.size(); i += 1) {
-                    auto x = region_electric_field_num[i];
-                    region_electric_field_map[region][observable].emplace_back(x, 0, 0);
+                auto& values = region_electric_field_map[region][observable];
+                values.reserve(values.size() + region_electric_field_num.size());
+                for(auto x : region_electric_field_num) {
+                    values.emplace_back(x, 0, 0);
                 }
 
                 region_electric_field_num.clear();
@@ -593,65 +853,28 @@ FieldMap DFISEParser::read_fields(const std::string& file_name) {
                     throw std::runtime_error("incorrect number of electric field points");
                 }
 
+                auto& values = region_electric_field_map[region][observable];
+                values.reserve(values.size() + region_electric_field_num.size() / dimension);
                 if(dimension == 3) {
-                    for(size_t i = 0; i < region_electric_field_num.size(); i += 3) {
+                    for(size_t i = 0; i + 2 < region_electric_field_num.size(); i += 3) {
                         auto x = region_electric_field_num[i];
                         auto y = region_electric_field_num[i + 1];
                         auto z = region_electric_field_num[i + 2];
-                        region_electric_field_map[region][observable].emplace_back(x, y, z);
+                        values.emplace_back(x, y, z);
                     }
                 }
 
                 if(dimension == 2) {
-                    for(size_t i = 0; i < region_electric_field_num.size(); i += 2) {
+                    for(size_t i = 0; i + 1 < region_electric_field_num.size(); i += 2) {
                         auto x = region_electric_field_num[i];
                         auto y = region_electric_field_num[i + 1];
-                        region_electric_field_map[region][observable].emplace_back(0, x, y);
+                        values.emplace_back(0, x, y);
                     }
                 }
 
                 region_electric_field_num.clear();
             }
 
-            if(main_section == DFSection::DOPING_CONCENTRATION && sub_section == DFSection::VALUES) {
-                if(data_count != region_electric_field_num.size()) {
-                    throw std::runtime_error("incorrect number of points");
-                }
-
-                for(size_t i = 0; i < region_electric_field_num.size(); i += 1) {
-                    auto x = region_electric_field_num[i];
-                    region_electric_field_map[region][observable].emplace_back(x, 0, 0);
-                }
-
-                region_electric_field_num.clear();
-            }
-
-            if(main_section == DFSection::DONOR_CONCENTRATION && sub_section == DFSection::VALUES) {
-                if(data_count != region_electric_field_num.size()) {
-                    throw std::runtime_error("incorrect number of points");
-                }
-
-                for(size_t i = 0; i < region_electric_field_num.size(); i += 1) {
-                    auto x = region_electric_field_num[i];
-                    region_electric_field_map[region][observable].emplace_back(x, 0, 0);
-                }
-
-                region_electric_field_num.clear();
-            }
-
-            if(main_section == DFSection::ACCEPTOR_CONCENTRATION && sub_section == DFSection::VALUES) {
-                if(data_count != region_electric_field_num.size()) {
-                    throw std::runtime_error("incorrect number of points");
-                }
-
-                for(size_t i = 0; i < region_electric_field_num.size(); i += 1) {
-                    auto x = region_electric_field_num[i];
-                    region_electric_field_map[region][observable].emplace_back(x, 0, 0);
-                }
-
-                region_electric_field_num.clear();
-            }
-
             // Close section
             if(sub_section != DFSection::NONE) {
                 sub_section = DFSection::NONE;
@@ -665,18 +888,6 @@ FieldMap DFISEParser::read_fields(const std::string& file_name) {
 
             continue;
         }
-
-        // Handle data
-        if((main_section == DFSection::ELECTRIC_FIELD || main_section == DFSection::ELECTROSTATIC_POTENTIAL ||
-            main_section == DFSection::DOPING_CONCENTRATION || main_section == DFSection::DONOR_CONCENTRATION ||
-            main_section == DFSection::ACCEPTOR_CONCENTRATION) &&
-           sub_section == DFSection::VALUES) {
-            std::stringstream sstr(line);
-            double num = NAN;
-            while(sstr >> num) {
-                region_electric_field_num.push_back(num);
-            }
-        }
     }
     LOG_PROGRESS(INFO, "fieldlines") << "Parsing field data file: done.";
 
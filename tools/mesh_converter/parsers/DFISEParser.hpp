@@ -9,6 +9,12 @@
 
 namespace mesh_converter {
 
+    /**
+     * @brief Parser for TCAD DF-ISE files
+     *
+     * The file is memory-mapped and tokenized by hand. Large blocks of numeric data are split into chunks which are parsed
+     * in parallel.
+     */
     class DFISEParser : public MeshParser {
         // Sections to read in DF-ISE file
         enum class DFSection {
@@ -32,11 +38,20 @@ namespace mesh_converter {
         };
 
     public:
+        /**
+         * @brief Construct the parser
+         * @param workers Maximum number of threads used to parse data blocks
+         */
+        explicit DFISEParser(unsigned int workers = 1);
+
         // Read the grid
         MeshMap read_meshes(const std::string& file_name) override;
 
         // Read the electric field
         FieldMap read_fields(const std::string& file_name) override;
+
+    private:
+        unsigned int workers_;
     };
 } // namespace mesh_converter
 
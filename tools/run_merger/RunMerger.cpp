@@ -0,0 +1,359 @@
+/**
+ * @file
+ * @brief Tool to merge the data files of a run simulated in shards of consecutive events
+ * @copyright Copyright (c) 2017-2020 CERN and the Allpix Squared authors.
+ * This software is distributed under the terms of the MIT License, copied verbatim in the file "LICENSE.md".
+ * In applying this license, CERN does not waive the privileges and immunities granted to it by virtue of its status as an
+ * Intergovernmental Organization or submit itself to any jurisdiction.
+ */
+
+#include <algorithm>
+#include <csignal>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <TBufferFile.h>
+#include <TChain.h>
+#include <TClass.h>
+#include <TDirectory.h>
+#include <TFile.h>
+#include <TKey.h>
+#include <TTree.h>
+
+#include "core/utils/log.h"
+#include "core/utils/text.h"
+
+void interrupt_handler(int);
+
+/**
+ * @brief Handle termination request (CTRL+C)
+ */
+void interrupt_handler(int) {
+    LOG(STATUS) << "Interrupted! Aborting merging...";
+    allpix::Log::finish();
+    std::exit(0);
+}
+
+namespace {
+    /**
+     * @brief Data file of a single shard of the run
+     */
+    struct Shard {
+        std::string file_name;
+        std::unique_ptr<TFile> file;
+        unsigned int first_event{1};
+        unsigned int number_of_events{};
+        unsigned int rejected_events{};
+        std::set<std::string> trees;
+    };
+
+    /**
+     * @brief Read a value of the global configuration stored in the data file
+     * @param file Data file written by the ROOTObjectWriter module
+     * @param key Key of the global configuration
+     * @param def Value returned if the key is not stored in the file
+     * @return Value of the key
+     */
+    std::string get_global_value(TFile* file, const std::string& key, const std::string& def) {
+        std::string* value = nullptr;
+        file->GetObject(("config/Allpix/" + key).c_str(), value);
+        if(value == nullptr) {
+            return def;
+        }
+        auto result = *value;
+        delete value;
+        return result;
+    }
+
+    /**
+     * @brief Serialize all objects stored in a directory and its subdirectories
+     * @param directory Directory to serialize
+     * @param path Path of the directory used as prefix for the object names
+     * @param objects Map of object paths to their serialized content to fill
+     */
+    void serialize_directory(TDirectory* directory, const std::string& path, std::map<std::string, std::string>& objects) {
+        if(directory == nullptr) {
+            return;
+        }
+
+        std::set<std::string> names;
+        for(auto* object : *directory->GetListOfKeys()) {
+            auto* key = static_cast<TKey*>(object);
+            // Keys are ordered by decreasing cycle, only consider the latest one
+            if(!names.insert(key->GetName()).second) {
+                continue;
+            }
+
+            auto name = path + "/" + key->GetName();
+            if(std::strcmp(key->GetClassName(), "TDirectoryFile") == 0) {
+                serialize_directory(directory->GetDirectory(key->GetName()), name, objects);
+                continue;
+            }
+
+            auto* cls = TClass::GetClass(key->GetClassName());
+            void* content = key->ReadObjectAny(cls);
+            TBufferFile buffer(TBuffer::kWrite);
+            buffer.WriteObjectAny(content, cls);
+            objects[name] = std::string(buffer.Buffer(), static_cast<size_t>(buffer.Length()));
+            cls->Destructor(content);
+        }
+    }
+
+    /**
+     * @brief Copy all objects stored in a directory and its subdirectories
+     * @param source Directory to copy from
+     * @param target Directory to copy to
+     */
+    void copy_directory(TDirectory* source, TDirectory* target) {
+        std::set<std::string> names;
+        for(auto* object : *source->GetListOfKeys()) {
+            auto* key = static_cast<TKey*>(object);
+            if(!names.insert(key->GetName()).second) {
+                continue;
+            }
+
+            if(std::strcmp(key->GetClassName(), "TDirectoryFile") == 0) {
+                copy_directory(source->GetDirectory(key->GetName()), target->mkdir(key->GetName()));
+                continue;
+            }
+
+            auto* cls = TClass::GetClass(key->GetClassName());
+            void* content = key->ReadObjectAny(cls);
+            target->WriteObjectAny(content, cls, key->GetName());
+            cls->Destructor(content);
+        }
+    }
+} // namespace
+
+int main(int argc, char** argv) {
+    // If no arguments are provided, print the help:
+    bool print_help = false;
+    int return_code = 0;
+    if(argc == 1) {
+        print_help = true;
+        return_code = 1;
+    }
+
+    try {
+        // Add stream and set default logging level
+        allpix::Log::addStream(std::cout);
+
+        // Install abort handler (CTRL+\) and interrupt handler (CTRL+C)
+        std::signal(SIGQUIT, interrupt_handler);
+        std::signal(SIGINT, interrupt_handler);
+
+        std::string output_file_name;
+        std::vector<std::string> input_file_names;
+        allpix::LogLevel log_level = allpix::LogLevel::INFO;
+
+        for(int i = 1; i < argc; i++) {
+            if(strcmp(argv[i], "-h") == 0) {
+                print_help = true;
+            } else if(strcmp(argv[i], "-o") == 0 && (i + 1 < argc)) {
+                output_file_name = std::string(argv[++i]);
+            } else if(strcmp(argv[i], "-v") == 0 && (i + 1 < argc)) {
+                try {
+                    log_level = allpix::Log::getLevelFromString(std::string(argv[++i]));
+                } catch(std::invalid_argument& e) {
+                    LOG(ERROR) << "Invalid verbosity level \"" << std::string(argv[i]) << "\", ignoring overwrite";
+                    return_code = 1;
+                }
+            } else if(argv[i][0] != '-') {
+                input_file_names.emplace_back(argv[i]);
+            } else {
+                LOG(ERROR) << "Unrecognized command line argument or missing value \"" << argv[i] << "\"";
+                print_help = true;
+                return_code = 1;
+            }
+        }
+
+        if(!print_help && (output_file_name.empty() || input_file_names.empty())) {
+            LOG(ERROR) << "Output file and at least one input file are required";
+            print_help = true;
+            return_code = 1;
+        }
+
+        // Set log level:
+        allpix::Log::setReportingLevel(log_level);
+
+        // Print help if requested or no arguments given
+        if(print_help) {
+            std::cerr << "Usage: merge_runs -o <output_file> <input_file> [<input_file> ...] [<options>]" << std::endl;
+            std::cout << "Required parameters:" << std::endl;
+            std::cout << "\t -o <file>      name of the merged output file" << std::endl;
+            std::cout << "\t <input_file>   data files written by the ROOTObjectWriter for the shards of the run"
+                      << std::endl;
+            std::cout << "Optional parameters:" << std::endl;
+            std::cout << "\t -v <level>     verbosity level (default reporiting level is INFO)" << std::endl;
+            std::cout << "\t -h             print this help text" << std::endl;
+
+            allpix::Log::finish();
+            return return_code;
+        }
+
+        LOG(STATUS) << "Welcome to the Run Merger Tool of Allpix^2 " << ALLPIX_PROJECT_VERSION;
+
+        // Open all shards and determine their range of events
+        std::vector<Shard> shards;
+        for(auto& file_name : input_file_names) {
+            Shard shard;
+            shard.file_name = file_name;
+            shard.file = std::make_unique<TFile>(file_name.c_str(), "READ");
+            if(shard.file->IsZombie()) {
+                throw std::runtime_error("could not open input file " + file_name);
+            }
+            shard.first_event = allpix::from_string<unsigned int>(get_global_value(shard.file.get(), "first_event", "1"));
+
+            // All trees of a shard hold one entry per event which has not been rejected
+            bool first_tree = true;
+            for(auto* object : *shard.file->GetListOfKeys()) {
+                auto* key = static_cast<TKey*>(object);
+                if(std::strcmp(key->GetClassName(), "TTree") != 0 || !shard.trees.insert(key->GetName()).second) {
+                    continue;
+                }
+                auto* tree = static_cast<TTree*>(key->ReadObj());
+                auto entries = static_cast<unsigned int>(tree->GetEntries());
+                if(first_tree) {
+                    shard.number_of_events = entries;
+                    first_tree = false;
+                } else if(entries != shard.number_of_events) {
+                    throw std::runtime_error("trees in input file " + file_name + " contain different numbers of events");
+                }
+            }
+
+            // Events rejected by modules have no entries in the trees but still belong to the range of the shard
+            std::string* rejected_events = nullptr;
+            shard.file->GetObject("rejected_events", rejected_events);
+            if(rejected_events != nullptr) {
+                shard.rejected_events = allpix::from_string<unsigned int>(*rejected_events);
+                shard.number_of_events += shard.rejected_events;
+                delete rejected_events;
+            }
+
+            LOG(INFO) << "Found events " << shard.first_event << " to "
+                      << (shard.first_event + shard.number_of_events - 1) << " with " << shard.rejected_events
+                      << " rejected events in " << file_name;
+            shards.push_back(std::move(shard));
+        }
+
+        // Order the shards by their first event and check that they form a contiguous range of events
+        std::sort(shards.begin(), shards.end(), [](const Shard& lhs, const Shard& rhs) {
+            return lhs.first_event < rhs.first_event;
+        });
+        for(size_t i = 1; i < shards.size(); ++i) {
+            auto expected = shards[i - 1].first_event + shards[i - 1].number_of_events;
+            if(shards[i].first_event != expected) {
+                throw std::runtime_error("input file " + shards[i].file_name + " starts at event " +
+                                         std::to_string(shards[i].first_event) + " but event " + std::to_string(expected) +
+                                         " is expected");
+            }
+            if(shards[i].trees != shards.front().trees) {
+                throw std::runtime_error("input file " + shards[i].file_name +
+                                         " does not contain the same object trees as " + shards.front().file_name);
+            }
+        }
+
+        // Check that all shards are produced with the same setup and configuration
+        std::map<std::string, std::string> reference;
+        for(auto& directory : {"config", "detectors", "models"}) {
+            serialize_directory(shards.front().file->GetDirectory(directory), directory, reference);
+        }
+        for(size_t i = 1; i < shards.size(); ++i) {
+            std::map<std::string, std::string> objects;
+            for(auto& directory : {"config", "detectors", "models"}) {
+                serialize_directory(shards[i].file->GetDirectory(directory), directory, objects);
+            }
+
+            std::set<std::string> paths;
+            for(auto& object : reference) {
+                paths.insert(object.first);
+            }
+            for(auto& object : objects) {
+                paths.insert(object.first);
+            }
+            for(auto& path : paths) {
+                auto ref = reference.find(path);
+                auto obj = objects.find(path);
+                if(ref != reference.end() && obj != objects.end() && ref->second == obj->second) {
+                    continue;
+                }
+
+                // The event range differs between shards by design, other configuration differences are reported
+                if(path == "config/Allpix/first_event" || path == "config/Allpix/last_event" ||
+                   path == "config/Allpix/number_of_events") {
+                    continue;
+                }
+                if(path.compare(0, 7, "config/") == 0) {
+                    LOG(WARNING) << "Configuration value " << path.substr(7) << " differs between "
+                                 << shards.front().file_name << " and " << shards[i].file_name;
+                } else {
+                    throw std::runtime_error("detector setup " + path + " differs between " + shards.front().file_name +
+                                             " and " + shards[i].file_name);
+                }
+            }
+        }
+
+        auto first_event = shards.front().first_event;
+        auto last_event = shards.back().first_event + shards.back().number_of_events - 1;
+        LOG(STATUS) << "Merging events " << first_event << " to " << last_event << " from " << shards.size()
+                    << " input files";
+
+        // Copy the configuration and setup of the first shard, with the event range of the merged run
+        auto output_file = std::make_unique<TFile>(output_file_name.c_str(), "RECREATE");
+        if(output_file->IsZombie()) {
+            throw std::runtime_error("could not create output file " + output_file_name);
+        }
+        for(auto& directory : {"config", "detectors", "models"}) {
+            auto* source = shards.front().file->GetDirectory(directory);
+            if(source != nullptr) {
+                copy_directory(source, output_file->mkdir(directory));
+            }
+        }
+        auto* global_dir = output_file->GetDirectory("config/Allpix");
+        if(global_dir != nullptr) {
+            auto first_event_str = std::to_string(first_event);
+            auto last_event_str = std::to_string(last_event);
+            auto number_of_events_str = std::to_string(last_event - first_event + 1);
+            global_dir->WriteObject(&first_event_str, "first_event", "Overwrite");
+            global_dir->WriteObject(&last_event_str, "last_event", "Overwrite");
+            global_dir->WriteObject(&number_of_events_str, "number_of_events", "Overwrite");
+        }
+        unsigned int rejected_events = 0;
+        for(auto& shard : shards) {
+            rejected_events += shard.rejected_events;
+        }
+        if(rejected_events > 0) {
+            auto rejected_events_str = std::to_string(rejected_events);
+            output_file->WriteObject(&rejected_events_str, "rejected_events");
+        }
+
+        // Concatenate the trees by copying their compressed baskets, references between objects are remapped by ROOT
+        for(auto& tree_name : shards.front().trees) {
+            LOG(INFO) << "Merging tree " << tree_name;
+            TChain chain(tree_name.c_str());
+            for(auto& shard : shards) {
+                chain.Add(shard.file_name.c_str());
+            }
+            output_file->cd();
+            if(chain.Merge(output_file.get(), 0, "fast keep") < 0) {
+                throw std::runtime_error("could not merge tree " + tree_name);
+            }
+        }
+
+        // Trees are already written by the merging, only the file has to be closed
+        output_file->Close();
+        LOG(STATUS) << "Merged " << (last_event - first_event + 1) << " events into " << output_file_name;
+    } catch(std::exception& e) {
+        LOG(FATAL) << "Failed to merge runs: " << e.what();
+        allpix::Log::finish();
+        return 1;
+    }
+
+    allpix::Log::finish();
+    return 0;
+}